@@ -10,13 +10,14 @@ Stratofier Stratux AHRS Display
 #include <QFont>
 #include <QLinearGradient>
 #include <QLineF>
-#include <QSettings>
 #include <QtConcurrent>
 #include <QTransform>
 #include <QVariant>
 #include <QScreen>
 #include <QBitmap>
 #include <QPainterPath>
+#include <QFontDatabase>
+#include <QResizeEvent>
 
 #include <math.h>
 
@@ -27,11 +28,14 @@ Stratofier Stratux AHRS Display
 #include "StreamReader.h"
 #include "Builder.h"
 #include "StratofierDefs.h"
+#include "Profiler.h"
+#include "AssetCache.h"
 #include "TimerDialog.h"
 #include "AirportDialog.h"
 #include "DetailsDialog.h"
 #include "Overlays.h"
 #include "AHRSDraw.h"
+#include "SettingsStore.h"
 
 
 extern QFont itsy;
@@ -41,10 +45,9 @@ extern QFont small;
 extern QFont med;
 extern QFont large;
 
-extern QList<Airport>  g_airportCache;
 extern QList<Airspace> g_airspaceCache;
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 StratuxSituation      g_situation;
 QList<StratuxTraffic> g_trafficList;
@@ -56,6 +59,7 @@ bool g_bNoAirportsUpdate = false;
 QString g_qsStratofierVersion( "1.9.1.1" );
 
 QFuture<void> g_apt;
+QFuture<void> g_asp;
 
 
 /*
@@ -71,7 +75,14 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
     : QWidget( parent ),
       m_bFuelFlowStarted( false ),
       m_pCanvas( nullptr ),
+      m_bDark( false ),
       m_bInitialized( false ),
+      m_bLayersValid( false ),
+      m_dLayerW( 0.0 ),
+      m_dLayerH( 0.0 ),
+      m_bLayerPortrait( true ),
+      m_pStageNs( nullptr ),
+      m_dTrafficSprite( 0.0 ),
       m_iHeadBugAngle( -1 ),
       m_iWindBugAngle( -1 ),
       m_iWindBugSpeed( 0 ),
@@ -90,8 +101,21 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
       m_iSwiping( 0 ),
       m_tanks( { 0.0, 0.0, 0.0, 0.0, 9.0, 10.0, 8.0, 5.0, 30, true, true, QDateTime::currentDateTime() } ),
       m_dBaroPress( 29.92 ),
-      m_lastTrafficUpdate( QDateTime::currentDateTime() )
+      m_lastTrafficUpdate( QDateTime::currentDateTime() ),
+      m_airspaceAlert( this ),
+      m_governor( this ),
+      m_bShowProfile( false ),
+      m_bAssetsPending( false )
 {
+    int iLayer;
+
+    for( iLayer = 0; iLayer < AHRSDraw::MapLayerCount; iLayer++ )
+    {
+        m_mapJobs[iLayer].bActive = false;
+        m_mapJobs[iLayer].bNorthUp = false;
+        m_mapJobs[iLayer].bValid = false;
+    }
+
     m_directAP.qsID = "NULL";
     m_directAP.qsName = "NULL";
     m_fromAP.qsID = "NULL";
@@ -105,21 +129,29 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
 
     // Preload the fancier icons that are impractical to paint programmatically
     m_planeIcon.load( ":/graphics/resources/Plane.png" );
-    m_headIcon.load( ":/icons/resources/HeadingIcon.png" );
-    m_windIcon.load( ":/icons/resources/WindIcon.png" );
     m_DirectTo.load( ":/graphics/resources/DirectTo.png" );
     m_FromTo.load( ":/graphics/resources/FromTo.png" );
     m_AltBug.load( ":/icons/resources/AltBug.png" );
     m_directIcon.load( ":/icons/resources/DirectIcon.png" );
 
-    m_trafficRed.load( ":/graphics/resources/TrafficRed.png" );
-    m_trafficYellow.load( ":/graphics/resources/TrafficYellow.png" );
-    m_trafficOrange.load( ":/graphics/resources/TrafficOrange.png" );
-    m_trafficGreen.load( ":/graphics/resources/TrafficGreen.png" );
-    m_trafficCyan.load( ":/graphics/resources/TrafficCyan.png" );
+    // Traffic is drawn on a worker thread so these are images rather than pixmaps; they're only used to build the sprite atlas
+    m_trafficRed = QImage( ":/graphics/resources/TrafficRed.png" ).convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    m_trafficYellow = QImage( ":/graphics/resources/TrafficYellow.png" ).convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    m_trafficOrange = QImage( ":/graphics/resources/TrafficOrange.png" ).convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    m_trafficGreen = QImage( ":/graphics/resources/TrafficGreen.png" ).convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    m_trafficCyan = QImage( ":/graphics/resources/TrafficCyan.png" ).convertToFormat( QImage::Format_ARGB32_Premultiplied );
 
     loadSettings();
 
+    // Carry on burning fuel from wherever a flight that never stopped left off
+    m_bFuelFlowStarted = m_fuelFlow.resume( &m_tanks );
+
+    connect( &m_airspaceAlert, SIGNAL( alertsChanged() ), this, SLOT( airspaceAlertsChanged() ) );
+    connect( &m_governor, SIGNAL( frameDue() ), this, SLOT( flushDirty() ) );
+    connect( &m_governor, SIGNAL( statsChanged() ), this, SLOT( governorStatsChanged() ) );
+    connect( &m_assetWatcher, SIGNAL( finished() ), this, SLOT( assetsReady() ) );
+    connect( g_pSettings, SIGNAL( settingsChanged( const QString& ) ), this, SLOT( settingsChanged() ) );
+
     // Quick and dirty way to ensure we're shown full screen before any calculations happen
     QTimer::singleShot( 2000, this, SLOT( init() ) );
 }
@@ -128,12 +160,13 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
 // Delete everything that needs deleting
 AHRSCanvas::~AHRSCanvas()
 {
-    if( g_pSet != Q_NULLPTR )
-    {
-        g_pSet->sync();
-        delete g_pSet;
-        g_pSet = Q_NULLPTR;
-    }
+    int iLayer;
+
+    for( iLayer = 0; iLayer < AHRSDraw::MapLayerCount; iLayer++ )
+        m_mapFutures[iLayer].waitForFinished();
+
+    if( g_pSettings != Q_NULLPTR )
+        g_pSettings->flush();
     if( m_pCanvas != Q_NULLPTR )
     {
         delete m_pCanvas;
@@ -152,61 +185,41 @@ void AHRSCanvas::init()
     m_pCanvas = new Canvas( width(), height(), m_bPortrait );
 
     CanvasConstants c = m_pCanvas->constants();
-    int             iBugSize = static_cast<int>( c.dWa * (m_bPortrait ? 0.1333 : 0.08) ) / 2.0;
-
-    m_headIcon = m_headIcon.scaled( iBugSize, iBugSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-    m_windIcon = m_windIcon.scaled( iBugSize, iBugSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-
-    if( m_bPortrait )
-        m_VertSpeedTape.load( ":/graphics/resources/vspeedP.png" );
-    else
-        m_VertSpeedTape.load( ":/graphics/resources/vspeedL.png" );
-
-    m_HeadIndicator.load( ":/graphics/resources/headBG.png" );
-    m_HeadIndicatorOverlay.load( ":/graphics/resources/head.png" );
-    m_RollIndicator.load( ":/graphics/resources/roll.png" );
-    m_AltTape.load( ":/graphics/resources/alttape.png" );
-    m_Lfuel.load( ":/graphics/resources/fuel.png" );
-    m_SpeedTape.load( ":/graphics/resources/speedtape.png" );
-    m_AltTape = m_AltTape.scaledToWidth( c.dW10, Qt::SmoothTransformation );
-    m_SpeedTape = m_SpeedTape.scaledToWidth( c.dW10 - c.dW40, Qt::SmoothTransformation );
-    QTransform flipper;
-    flipper.scale( -1, 1 );
-    m_Rfuel = m_Lfuel.transformed( flipper );
 
     m_iDispTimer = startTimer( 5000 );     // Update the in-memory airspace objects every 15 seconds
 
-    QtConcurrent::run( TrafficMath::cacheAirports );
-    QtConcurrent::run( TrafficMath::cacheAirspaces );
+    TrafficMath::cacheAirports();
+    TrafficMath::cacheAirspaces();
 
-    m_bInitialized = true;
+    // Nothing is drawn until the artwork is ready
+    startAssets( c );
 }
 
 
 void AHRSCanvas::loadSettings()
 {
-    m_dZoomNM = g_pSet->value( "ZoomNM", 10.0 ).toDouble();
-    m_settings.bShowAllTraffic = g_pSet->value( "ShowAllTraffic", true ).toBool();
-    m_settings.eShowAirports = static_cast<Canvas::ShowAirports>( g_pSet->value( "ShowAirports", 2 ).toInt() );
-    m_settings.bShowPrivate = g_pSet->value( "ShowPrivate", false ).toBool();
-    m_settings.bShowRunways = g_pSet->value( "ShowRunways", true ).toBool();
-    m_settings.bShowAirspaces = g_pSet->value( "ShowAirspaces", true ).toBool();
-    m_settings.bShowAltitudes = g_pSet->value( "ShowAltitudes", true ).toBool();
-    m_settings.bAutoRec = g_pSet->value( "AutoRec", false ).toBool();
-    m_iMagDev = g_pSet->value( "MagDev", 0 ).toInt();
-    g_eUnitsAirspeed = m_settings.eUnits = static_cast<Canvas::Units>( g_pSet->value( "UnitsAirspeed", true ).toInt() );
-
-    g_pSet->beginGroup( "FuelTanks" );
-    m_tanks.dLeftCapacity = g_pSet->value( "LeftCapacity", 24.0 ).toDouble();
-    m_tanks.dRightCapacity = g_pSet->value( "RightCapacity", 24.0 ).toDouble();
-    m_tanks.dLeftRemaining = g_pSet->value( "LeftRemaining", 24.0 ).toDouble();
-    m_tanks.dRightRemaining = g_pSet->value( "RightRemaining", 24.0 ).toDouble();
-    m_tanks.dFuelRateCruise = g_pSet->value( "CruiseRate", 8.3 ).toDouble();
-    m_tanks.dFuelRateClimb = g_pSet->value( "ClimbRate", 9.0 ).toDouble();
-    m_tanks.dFuelRateDescent = g_pSet->value( "DescentRate", 7.0 ).toDouble();
-    m_tanks.dFuelRateTaxi = g_pSet->value( "TaxiRate", 4.0 ).toDouble();
-    m_tanks.iSwitchIntervalMins = g_pSet->value( "SwitchInterval", 15 ).toInt();
-    g_pSet->endGroup();
+    m_settings = g_pSettings->settings();
+    m_dZoomNM = g_pSettings->zoomNM();
+    m_iMagDev = m_settings.iMagDev;
+    g_eUnitsAirspeed = m_settings.eUnits;
+
+    m_tanks.dLeftCapacity = g_pSettings->value( "FuelTanks/LeftCapacity", 24.0 ).toDouble();
+    m_tanks.dRightCapacity = g_pSettings->value( "FuelTanks/RightCapacity", 24.0 ).toDouble();
+    m_tanks.dLeftRemaining = g_pSettings->value( "FuelTanks/LeftRemaining", 24.0 ).toDouble();
+    m_tanks.dRightRemaining = g_pSettings->value( "FuelTanks/RightRemaining", 24.0 ).toDouble();
+    m_tanks.dFuelRateCruise = g_pSettings->value( "FuelTanks/CruiseRate", 8.3 ).toDouble();
+    m_tanks.dFuelRateClimb = g_pSettings->value( "FuelTanks/ClimbRate", 9.0 ).toDouble();
+    m_tanks.dFuelRateDescent = g_pSettings->value( "FuelTanks/DescentRate", 7.0 ).toDouble();
+    m_tanks.dFuelRateTaxi = g_pSettings->value( "FuelTanks/TaxiRate", 4.0 ).toDouble();
+    m_tanks.iSwitchIntervalMins = g_pSettings->value( "FuelTanks/SwitchInterval", 15 ).toInt();
+}
+
+
+// Changes from the dialogs and overlay menu show up on the next frame without anything having to be reread
+void AHRSCanvas::settingsChanged()
+{
+    m_settings = g_pSettings->settings();
+    update();
 }
 
 
@@ -219,7 +232,6 @@ void AHRSCanvas::timerEvent( QTimerEvent *pEvent )
 
     QDateTime qdtNow = QDateTime::currentDateTime();
 
-    m_settings.eShowAirports = static_cast<Canvas::ShowAirports>( g_pSet->value( "ShowAirports", 2 ).toInt() );
     update();
 
     cullTrafficMap();
@@ -232,52 +244,17 @@ void AHRSCanvas::timerEvent( QTimerEvent *pEvent )
 
     // If we have a valid GPS position, run the list of airports within range by threading it so it doesn't interfere with the display update
     if( (g_situation.dGPSlat != 0.0) && (g_situation.dGPSlong != 0.0) )
-    {
-        // This threaded function will crash the app if we're accessing the airports cache in the middle of an update
-        if( !g_bNoAirportsUpdate )
-            g_apt = QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
-        QtConcurrent::run( TrafficMath::updateNearbyAirspaces, &m_airspaces, m_dZoomNM );
-    }
+        startNearby();
 
+    // The fuel itself is burned as each situation update comes in
     if( m_bFuelFlowStarted )
     {
-        double dInterval = 0.00416666666667;   // 15 seconds / 3600 seconds (1 hour); 15 seconds is the interval of the one and only timer
-
-        // If the aircraft is moving slowly and there is virtually no vertical movement then we are taxiing
-        if( (g_situation.dGPSGroundSpeed > 5.0) && (g_situation.dGPSGroundSpeed < 20.0) && (fabs( g_situation.dBaroVertSpeed ) < 5.0) )
-        {
-            if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
-                m_tanks.dLeftRemaining -= (m_tanks.dFuelRateTaxi * dInterval);
-            else
-                m_tanks.dRightRemaining -= (m_tanks.dFuelRateTaxi * dInterval);
-        }
-        // If we're moving faster than 35 knots and we're at least anemically climbing, then use the climb rate
-        else if( (g_situation.dGPSGroundSpeed > 35.0) && (g_situation.dBaroVertSpeed > 50.0) )
-        {
-            if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
-                m_tanks.dLeftRemaining -= (m_tanks.dFuelRateClimb * dInterval);
-            else
-                m_tanks.dRightRemaining -= (m_tanks.dFuelRateClimb * dInterval);
-        }
-        // If we're at least at an anemic airspeed and reasonbly acceptable altitude control, then use the cruise rate
-        else if( (g_situation.dGPSGroundSpeed > 70.0) && (g_situation.dBaroVertSpeed < 100.0) )
-        {
-            if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
-                m_tanks.dLeftRemaining -= (m_tanks.dFuelRateCruise * dInterval);
-            else
-                m_tanks.dRightRemaining -= (m_tanks.dFuelRateCruise * dInterval);
-        }
-        // If we're in at least a slow descent, use the descent rate
-        else if( (g_situation.dGPSGroundSpeed > 70.0) && (g_situation.dBaroVertSpeed < -250.0) )
+        // The notice covers the whole screen
+        if( (m_tanks.lastSwitch.secsTo( qdtNow ) > (m_tanks.iSwitchIntervalMins * 60)) && m_tanks.bDualTanks && (!m_bDisplayTanksSwitchNotice) )
         {
-            if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
-                m_tanks.dLeftRemaining -= (m_tanks.dFuelRateDescent * dInterval);
-            else
-                m_tanks.dRightRemaining -= (m_tanks.dFuelRateDescent * dInterval);
-        }
-
-        if( (m_tanks.lastSwitch.secsTo( qdtNow ) > (m_tanks.iSwitchIntervalMins * 60)) && m_tanks.bDualTanks )
             m_bDisplayTanksSwitchNotice = true;
+            update();
+        }
     }
 
     m_bUpdated = false;
@@ -290,26 +267,44 @@ void AHRSCanvas::paintEvent( QPaintEvent *pEvent )
     if( (!m_bInitialized) || (pEvent == 0) )
         return;
 
-    // Paint per orientation
+    ProfileScope  frameScope( Profiler::FrameStage );
+    QElapsedTimer frameTimer;
+
+    frameTimer.start();
+    paintFrame( this, pEvent->region() );
+    if( m_governor.statsShown() )
+        paintGovernorStats();
+    if( m_bShowProfile )
+        paintProfile();
+    m_governor.frameDone( frameTimer.nsecsElapsed() );
+}
+
+
+// Paint per orientation; only the instruments that overlap what's dirty get drawn. The device is the widget itself
+// except for the offscreen benchmark and reference image checks.
+void AHRSCanvas::paintFrame( QPaintDevice *pDevice, const QRegion &dirty )
+{
     if( m_bPortrait )
-        paintPortrait();
+        paintPortrait( pDevice, dirty );
     else
-        paintLandscape();
+        paintLandscape( pDevice, dirty );
 
     if( m_bDark )
     {
-        QPainter darkPainter( this );
+        QPainter darkPainter( pDevice );
 
-        darkPainter.fillRect( rect(), QColor( 0, 0, 0, 200 ) );
+        darkPainter.fillRect( 0, 0, pDevice->width(), pDevice->height(), QColor( 0, 0, 0, 200 ) );
     }
 }
 
 
-
-
 // Situation (mostly AHRS data) update
 void AHRSCanvas::situation( StratuxSituation s )
 {
+    StratuxSituation prev = g_situation;
+    double           dLeftRemaining = m_tanks.dLeftRemaining;
+    double           dRightRemaining = m_tanks.dRightRemaining;
+
     g_situation = s;
     g_situation.dAHRSGyroHeading += static_cast<double>( m_iMagDev );
     g_situation.dAHRSMagHeading += static_cast<double>( m_iMagDev );
@@ -323,7 +318,30 @@ void AHRSCanvas::situation( StratuxSituation s )
         g_situation.dAHRSMagHeading -= 360.0;
 
     m_bUpdated = true;
-    update();
+    m_governor.situation( prev, g_situation );
+    m_fuelFlow.situation( g_situation );
+    m_recorder.situation( g_situation, m_settings.bAutoRec );
+
+    // The GPS details overlay covers everything and shows the satellite counts
+    if( m_bShowGPSDetails )
+    {
+        update();
+        return;
+    }
+
+    if( (g_situation.dAHRSroll != prev.dAHRSroll) || (g_situation.dAHRSpitch != prev.dAHRSpitch) || (g_situation.dAHRSSlipSkid != prev.dAHRSSlipSkid) )
+        markDirty( AttitudeRegion );
+    if( g_situation.dGPSGroundSpeed != prev.dGPSGroundSpeed )
+        markDirty( SpeedRegion );
+    if( g_situation.dBaroPressAlt != prev.dBaroPressAlt )
+        markDirty( AltitudeRegion );
+    if( g_situation.dGPSVertSpeed != prev.dGPSVertSpeed )
+        markDirty( VertSpeedRegion );
+    if( (g_situation.dAHRSGyroHeading != prev.dAHRSGyroHeading) || (g_situation.dGPSlat != prev.dGPSlat) || (g_situation.dGPSlong != prev.dGPSlong) )
+        markDirty( MapRegion );
+    // The tank gauges go down as the fuel flow burns it
+    if( (g_situation.dAHRSGLoad != prev.dAHRSGLoad) || (m_tanks.dLeftRemaining != dLeftRemaining) || (m_tanks.dRightRemaining != dRightRemaining) )
+        markDirty( InfoRegion );
 }
 
 
@@ -332,20 +350,30 @@ void AHRSCanvas::traffic( StratuxTraffic t )
 {
     int     i;
     QString qsTail;
+    bool    bNew = true;
 
-    // Remove the old aircraft entry
+    // Remove the old aircraft entry; how far it moved since then counts towards the frame rate
     for( i = 0; i < g_trafficList.count(); i++ )
     {
         if( g_trafficList.at( i ).qsTail == t.qsTail )
         {
+            m_governor.traffic( g_trafficList.at( i ), t, m_dZoomNM );
             g_trafficList.removeAt( i );
+            bNew = false;
             break;
         }
     }
 
     g_trafficList.append( t );
     m_bUpdated = true;
-    update();
+    // Traffic only shows on the map unless the GPS details are listing it
+    if( m_bShowGPSDetails )
+        update();
+    else
+    {
+        // Anything new, or on the map and within the orange band (1000 ft), is never held back by the governor
+        markDirty( MapRegion, bNew || ((fabs( t.dAlt - g_situation.dBaroPressAlt ) <= 1000.0) && (t.dDist <= m_dZoomNM)) );
+    }
     m_lastTrafficUpdate = QDateTime::currentDateTime();
 }
 
@@ -438,6 +466,7 @@ void AHRSCanvas::mouseReleaseEvent( QMouseEvent *pEvent )
         m_bDisplayTanksSwitchNotice = false;
         m_tanks.bOnLeftTank = (!m_tanks.bOnLeftTank);
         m_tanks.lastSwitch = qdtNow;
+        m_fuelFlow.tanksSwitched();
         update();
         return;
     }
@@ -531,19 +560,8 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
             if( airportDlg.exec() != QDialog::Rejected )
             {
                 Airport ap;
-                QString qsName = airportDlg.selectedAirport();
-                bool    bFound = false;
-
-                foreach( ap, g_airportCache )
-                {
-                    if( ap.qsName == qsName )
-                    {
-                        bFound = true;
-                        break;
-                    }
-                }
 
-                if( bFound )
+                if( TrafficMath::findAirportByName( airportDlg.selectedAirport(), &ap ) )
                 {
                     DetailsDialog detailsDlg( this, &c, &ap );
 
@@ -637,16 +655,9 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
         if( dlg.exec() != QDialog::Rejected )
         {
             Airport ap;
-            QString qsName = dlg.selectedAirport();
 
-            foreach( ap, g_airportCache )
-            {
-                if( ap.qsName == qsName )
-                {
-                    m_directAP = ap;
-                    break;
-                }
-            }
+            if( TrafficMath::findAirportByName( dlg.selectedAirport(), &ap ) )
+                m_directAP = ap;
             // Invalidate from-to in favor of direct-to
             m_fromAP.qsID = "NULL";
             m_fromAP.qsName = "NULL";
@@ -674,33 +685,20 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
         if( dlgFrom.exec() != QDialog::Rejected )
         {
             Airport ap;
-            QString qsName = dlgFrom.selectedAirport();
 
-            foreach( ap, g_airportCache )
-            {
-                if( ap.qsName == qsName )
-                {
-                    m_fromAP = ap;
-                    break;
-                }
-            }
+            if( TrafficMath::findAirportByName( dlgFrom.selectedAirport(), &ap ) )
+                m_fromAP = ap;
 
             AirportDialog dlgTo( this, &c, "TO AIRPORT" );
 
             dlgTo.setGeometry( 0, 0, c.dW, c.dH );
             if( dlgTo.exec() != QDialog::Rejected )
             {
-                qsName = dlgTo.selectedAirport();
-
-                foreach( ap, g_airportCache )
+                if( TrafficMath::findAirportByName( dlgTo.selectedAirport(), &ap ) )
                 {
-                    if( ap.qsName == qsName )
-                    {
-                        m_directAP.qsID = "NULL";
-                        m_directAP.qsName = "NULL";
-                        m_toAP = ap;
-                        break;
-                    }
+                    m_directAP.qsID = "NULL";
+                    m_directAP.qsName = "NULL";
+                    m_toAP = ap;
                 }
             }
             // Invalidate direct-to in favor of from-to
@@ -758,14 +756,26 @@ void AHRSCanvas::mouseMoveEvent( QMouseEvent *pEvent )
 }
 
 
+// This threaded function will crash the app if we're accessing the airports cache in the middle of an update, and the
+// last run has to be finished so the cache swap in CachePublisher can tell when they're clear of it. A zoom that lands
+// while one is still going is picked up by the next situation update.
+void AHRSCanvas::startNearby()
+{
+    if( (!g_bNoAirportsUpdate) && g_apt.isFinished() && g_asp.isFinished() )
+    {
+        g_apt = QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
+        g_asp = QtConcurrent::run( TrafficMath::updateNearbyAirspaces, &m_airspaces, m_dZoomNM, m_dZoomNM * 2.0 / m_pCanvas->constants().dHeadDiam );
+    }
+}
+
+
 void AHRSCanvas::zoomIn()
 {
     m_dZoomNM -= 5.0;
     if( m_dZoomNM < 5.0 )
         m_dZoomNM = 5.0;
-    g_pSet->setValue( "ZoomNM", m_dZoomNM );
-    g_pSet->sync();
-    QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
+    g_pSettings->setValue( "ZoomNM", m_dZoomNM );
+    startNearby();
 }
 
 
@@ -774,17 +784,15 @@ void AHRSCanvas::zoomOut()
     m_dZoomNM += 5.0;
     if( m_dZoomNM > 100.0 )
         m_dZoomNM = 100.0;
-    g_pSet->setValue( "ZoomNM", m_dZoomNM );
-    g_pSet->sync();
-    QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
+    g_pSettings->setValue( "ZoomNM", m_dZoomNM );
+    startNearby();
 }
 
 
 void AHRSCanvas::showAllTraffic( bool bAll )
 {
     m_settings.bShowAllTraffic = bAll;
-    g_pSet->setValue( "ShowAllTraffic", bAll );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAllTraffic", bAll );
     update();
 }
 
@@ -792,8 +800,7 @@ void AHRSCanvas::showAllTraffic( bool bAll )
 void AHRSCanvas::showAirports( Canvas::ShowAirports eShow )
 {
     m_settings.eShowAirports = eShow;
-    g_pSet->setValue( "ShowAirports", static_cast<int>( eShow ) );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAirports", static_cast<int>( eShow ) );
     update();
 }
 
@@ -801,8 +808,7 @@ void AHRSCanvas::showAirports( Canvas::ShowAirports eShow )
 void AHRSCanvas::showPrivate( bool bShow )
 {
     m_settings.bShowPrivate = bShow;
-    g_pSet->setValue( "ShowPrivate", bShow );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowPrivate", bShow );
     update();
 }
 
@@ -810,8 +816,7 @@ void AHRSCanvas::showPrivate( bool bShow )
 void AHRSCanvas::showRunways( bool bShow )
 {
     m_settings.bShowRunways = bShow;
-    g_pSet->setValue( "ShowRunways", bShow );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowRunways", bShow );
     update();
 }
 
@@ -819,8 +824,7 @@ void AHRSCanvas::showRunways( bool bShow )
 void AHRSCanvas::showAirspaces( bool bShow )
 {
     m_settings.bShowAirspaces = bShow;
-    g_pSet->setValue( "ShowAirspaces", bShow );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAirspaces", bShow );
     update();
 }
 
@@ -828,31 +832,36 @@ void AHRSCanvas::showAirspaces( bool bShow )
 void AHRSCanvas::showAltitudes( bool bShow )
 {
     m_settings.bShowAltitudes = bShow;
-    g_pSet->setValue( "ShowAltitudes", bShow );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAltitudes", bShow );
     update();
 }
 
 
-void AHRSCanvas::paintPortrait()
+void AHRSCanvas::paintPortrait( QPaintDevice *pDevice, const QRegion &dirty )
 {
-    QPainter        ahrs( this );
+    QPainter        ahrs( pDevice );
     CanvasConstants c = m_pCanvas->constants();
     QPixmap         num( 320, 84 );
-    QPolygon        shape;
     QPen            linePen( Qt::black );
     double          dPitchH = c.dH4 + (g_situation.dAHRSpitch / 22.5 * c.dH4);     // The visible portion is only 1/4 of the 90 deg range
     double          dSlipSkid = c.dW2 - ((g_situation.dAHRSSlipSkid / 8.0) * c.dW2);
     double          dPxPerVSpeed = c.dH2 / 40.0;
     double          dPxPerFt = static_cast<double>( m_AltTape.height() ) / 20000.0 * 0.99;
     double          dPxPerKnot = static_cast<double>( m_SpeedTape.height() ) / 300.0 * 0.99;
+    bool            bAttitude;
+    const CanvasLayout &layout = m_pCanvas->layout();
     AHRSDraw        draw( &ahrs, &c, m_pCanvas, &m_directAP,
                           &m_fromAP, &m_toAP, &m_airports, &m_airspaces, m_dZoomNM, &m_settings, m_iMagDev,
-                          &m_trafficRed,
-                          &m_trafficYellow,
-                          &m_trafficGreen,
-                          &m_trafficCyan,
-                          &m_trafficOrange );
+                          &m_trafficAtlas );
+
+    draw.setAirspaceAlert( &m_airspaceAlert );
+    if( !layersValid( c ) )
+        buildLayers( c );
+
+    // The moving map is drawn on the worker pool while the attitude and tapes are painted here
+    if( dirty.intersects( m_regions[MapRegion] ) )
+        startMapLayers( c );
+
     if( dSlipSkid < (c.dW4 + 25.0) )
         dSlipSkid = c.dW4 + 25.0;
     else if( dSlipSkid > (c.dW2 + c.dW4 - 25.0) )
@@ -860,361 +869,371 @@ void AHRSCanvas::paintPortrait()
 
     linePen.setWidth( c.iThinPen );
 
-    // Don't draw past the bottom of the fuel indicators
-    ahrs.setClipRect( 0, 0, c.dW, c.dH2 + c.dH5 );
-
     ahrs.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
 
-    // Translate to dead center and rotate by stratux/BADASP roll then translate back
-    ahrs.translate( c.dW2, c.dH4 );
-    ahrs.rotate( -g_situation.dAHRSroll );
-    ahrs.translate( -c.dW2, -c.dH4 );
+    // A map-only repaint still has to put back the attitude showing around the dial, but nothing more of it
+    bAttitude = dirty.intersects( m_regions[AttitudeRegion] );
+    if( bAttitude || dirty.intersects( m_attitudeUnderMap ) )
+    {
+        stageStart();
 
-    // Top half sky blue gradient offset by stratux pitch
-    QLinearGradient skyGradient( 0.0, -c.dH2, 0.0, dPitchH );
-    skyGradient.setColorAt( 0, Qt::blue );
-    skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
-    ahrs.fillRect( -400.0, -c.dH4, c.dW + 800.0, dPitchH + c.dH4, skyGradient );
+        if( !bAttitude )
+            ahrs.setClipRegion( m_attitudeUnderMap );
 
-    // Draw brown gradient horizon half offset by stratux pitch
-    // Extreme overdraw accounts for extreme roll angles that might expose the corners
-    QLinearGradient groundGradient( 0.0, dPitchH, 0, c.dH2 );
-    groundGradient.setColorAt( 0, QColor( 170, 85, 0  ) );
-    groundGradient.setColorAt( 1, Qt::black );
+        // Don't draw past the bottom of the fuel indicators
+        ahrs.setClipRect( layout.attitudeClip, bAttitude ? Qt::ReplaceClip : Qt::IntersectClip );
 
-    ahrs.fillRect( -400.0, dPitchH, c.dW + 800.0, c.dH4 + c.dH5, groundGradient );
-    ahrs.setPen( linePen );
-    ahrs.drawLine( -400, dPitchH, c.dW + 800.0, dPitchH );
+        // Translate to dead center and rotate by stratux/BADASP roll then translate back
+        ahrs.translate( c.dW2, c.dH4 );
+        ahrs.rotate( -g_situation.dAHRSroll );
+        ahrs.translate( -c.dW2, -c.dH4 );
 
-    for( int i = 0; i < 20; i += 10 )
-    {
-        linePen.setColor( Qt::cyan );
-        ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH - ((i + 10.0) / 45.0 * c.dH4), c.dW2 + c.dW5, dPitchH - (( i + 10.0) / 45.0 * c.dH4) );
-        linePen.setColor( QColor( 67, 33, 9 ) );
+        // Top half sky blue gradient offset by stratux pitch
+        QLinearGradient skyGradient( 0.0, -c.dH2, 0.0, dPitchH );
+        skyGradient.setColorAt( 0, Qt::blue );
+        skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
+        ahrs.fillRect( -400.0, -c.dH4, c.dW + 800.0, dPitchH + c.dH4, skyGradient );
+
+        // Draw brown gradient horizon half offset by stratux pitch
+        // Extreme overdraw accounts for extreme roll angles that might expose the corners
+        QLinearGradient groundGradient( 0.0, dPitchH, 0, c.dH2 );
+        groundGradient.setColorAt( 0, QColor( 170, 85, 0  ) );
+        groundGradient.setColorAt( 1, Qt::black );
+
+        ahrs.fillRect( -400.0, dPitchH, c.dW + 800.0, c.dH4 + c.dH5, groundGradient );
         ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH + ((i + 10.0) / 45.0 * c.dH4), c.dW2 + c.dW5, dPitchH + (( i + 10.0) / 45.0 * c.dH4) );
+        ahrs.drawLine( -400, dPitchH, c.dW + 800.0, dPitchH );
+
+        // The ladder is drawn around a zero pitch line so it only needs moving to the current pitch
+        ahrs.translate( 0.0, dPitchH );
+        drawLayer( &ahrs, PitchLadderLayer );
+
+        // Reset rotation and clipping
+        ahrs.resetTransform();
+        if( bAttitude )
+            ahrs.setClipping( false );
+        else
+            ahrs.setClipRegion( m_attitudeUnderMap );
+
+        // Slip/Skid indicator
+        draw.drawSlipSkid( dSlipSkid );
+
+        // Draw the top roll indicator
+        ahrs.translate( c.dW2, c.dH20 + ((c.dW - c.dW5) / 2.0) );
+        ahrs.rotate( -g_situation.dAHRSroll );
+        ahrs.translate( -c.dW2, -(c.dH20 + ((c.dW - c.dW5) / 2.0)) );
+        drawLayer( &ahrs, RollScaleLayer );
+        ahrs.resetTransform();
+
+        // Roll pointer and the yellow pitch indicators
+        drawLayer( &ahrs, AttitudeMarksLayer );
+        ahrs.setClipping( false );
+
+        stageDone( AttitudeRegion );
     }
 
-    // Reset rotation and clipping
-    ahrs.resetTransform();
-    ahrs.setClipping( false );
+    if( dirty.intersects( m_regions[AltitudeRegion] ) )
+    {
+        stageStart();
 
-    // Slip/Skid indicator
-    draw.drawSlipSkid( dSlipSkid );
-
-    // Draw the top roll indicator
-    ahrs.translate( c.dW2, c.dH20 + ((c.dW - c.dW5) / 2.0) );
-    ahrs.rotate( -g_situation.dAHRSroll );
-    ahrs.translate( -c.dW2, -(c.dH20 + ((c.dW - c.dW5) / 2.0)) );
-    ahrs.drawPixmap( c.dW10, c.dH20, c.dW - c.dW5, c.dW - c.dW5, m_RollIndicator );
-    ahrs.resetTransform();
-
-    QPolygonF arrow;
-
-    arrow.append( QPointF( c.dW2, c.dH40 + (c.dH * 0.0625) ) );
-    arrow.append( QPointF( c.dW2 + (c.dWa * 0.03125), c.dH40 + (c.dH * 0.08125) ) );
-    arrow.append( QPointF( c.dW2 - (c.dWa * 0.03125), c.dH40 + (c.dH * 0.08125) ) );
-    ahrs.setBrush( Qt::white );
-    ahrs.setPen( Qt::black );
-    ahrs.drawPolygon( arrow );
-
-    // Draw the yellow pitch indicators
-    ahrs.setBrush( Qt::yellow );
-    shape.append( QPoint( c.dW5 + c.dW20, c.dH4 - c.dH160 ) );
-    shape.append( QPoint( c.dW2 - c.dW10, c.dH4 - c.dH160 ) );
-    shape.append( QPoint( c.dW2 - c.dW10 + 20, c.dH4 ) );
-    shape.append( QPoint( c.dW2 - c.dW10, c.dH4 + c.dH160 ) );
-    shape.append( QPoint( c.dW5 + c.dW20, c.dH4 + c.dH160 ) );
-    ahrs.drawPolygon( shape );
-    shape.clear();
-    shape.append( QPoint( c.dW - c.dW5 - c.dW20, c.dH4 - c.dH160 ) );
-    shape.append( QPoint( c.dW2 + c.dW10, c.dH4 - c.dH160 ) );
-    shape.append( QPoint( c.dW2 + c.dW10 - 20, c.dH4 ) );
-    shape.append( QPoint( c.dW2 + c.dW10, c.dH4 + c.dH160 ) );
-    shape.append( QPoint( c.dW - c.dW5 - c.dW20, c.dH4 + c.dH160 ) );
-    ahrs.drawPolygon( shape );
-    shape.clear();
-    shape.append( QPoint( c.dW2, c.dH4 ) );
-    shape.append( QPoint( c.dW2 - c.dW20, c.dH4 + 20 ) );
-    shape.append( QPoint( c.dW2 + c.dW20, c.dH4 + 20 ) );
-    ahrs.drawPolygon( shape );
-
-    // Draw the Altitude tape
-    QPainterPath maskPath, elipsePath;
-
-    maskPath.addRect( 0.0, 0.0, c.dW, c.dH );
-    elipsePath.addEllipse( QPointF( (m_bPortrait ? 0.0 : c.dW) + c.dW2, c.dH - 10.0 - c.dHeadDiam2 ),
-                           c.dHeadDiam2, c.dHeadDiam2 );
-    maskPath = maskPath.subtracted( elipsePath );
-    ahrs.setClipPath( maskPath );
-
-    ahrs.fillRect( c.dW - c.dW5, 0, c.dW5, c.dH2 + c.dH4, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( c.dW - c.dW5 + 5, c.dH4 + 10.0 - m_AltTape.height() + (g_situation.dBaroPressAlt * dPxPerFt), m_AltTape );
-
-    // Draw the Speed tape
-    ahrs.fillRect( 0, 0, c.dW10 + 5.0, c.dH2, QColor( 0, 0, 0, 100 ) );
-    ahrs.setClipRect( 2.0, 2.0, c.dW5 - 4.0, c.dH2 + c.dH4 );
-    ahrs.drawPixmap( 5, c.dH4 + 5.0 - m_SpeedTape.height() + (g_situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
-    ahrs.setClipping( false );
+        // Draw the Altitude tape
+        ahrs.setClipPath( layout.headMask );
+
+        drawLayer( &ahrs, AltTapeBackLayer );
+        ahrs.drawPixmap( c.dW - c.dW5 + 5, c.dH4 + 10.0 - m_AltTape.height() + (g_situation.dBaroPressAlt * dPxPerFt), m_AltTape );
 
-    // Draw the current speed
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
-    draw.drawCurrSpeed( &num );
+        stageDone( AltitudeRegion );
+    }
+
+    if( dirty.intersects( m_regions[SpeedRegion] ) )
+    {
+        stageStart();
+
+        // Draw the Speed tape
+        drawLayer( &ahrs, SpeedTapeBackLayer );
+        ahrs.setClipRect( layout.speedTapeClip );
+        ahrs.drawPixmap( 5, c.dH4 + 5.0 - m_SpeedTape.height() + (g_situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
+        ahrs.setClipping( false );
+
+        // Draw the current speed
+        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
+        draw.drawCurrSpeed( &num );
+
+        ahrs.setFont( wee );
+        ahrs.setPen( Qt::black );
+        QString qsUnits( speedUnits() );
+        ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0) + 1, c.dH4 + 1, qsUnits );
+        ahrs.setPen( Qt::white );
+        ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0), c.dH4, qsUnits );
 
-    ahrs.setFont( wee );
-    ahrs.setPen( Qt::black );
-    QString qsUnits( speedUnits() );
-    ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0) + 1, c.dH4 + 1, qsUnits );
-    ahrs.setPen( Qt::white );
-    ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0), c.dH4, qsUnits );
+        stageDone( SpeedRegion );
+    }
 
     ahrs.setClipping( false );
 
-    // Left Tank indicators background
-    ahrs.drawPixmap( 0.0, c.dH2 + c.dH40, c.dW20, c.dH2 - c.dH5, m_Lfuel );
-    // Tank indicators level
-    QPen levelPen( Qt::black, c.dH40 + 4 );
-    levelPen.setCapStyle( Qt::RoundCap );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( 0.0,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-    levelPen.setWidth( c.dH40 );
-    levelPen.setColor( QColor( 255, 150, 255 ) );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( 0.0,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-
-    if( m_tanks.bDualTanks )
+    if( dirty.intersects( m_regions[InfoRegion] ) )
     {
-        // Right Tank indicators background
-        ahrs.drawPixmap( c.dW - c.dW20 - 1, c.dH2 + c.dH40, c.dW20, c.dH2 - c.dH5, m_Rfuel );
-        // Right Tank indicators level
-        levelPen.setColor( Qt::black );
-        levelPen.setWidth( c.dH40 + 4 );
+        stageStart();
+
+        // Left Tank indicators background
+        ahrs.drawPixmap( 0.0, c.dH2 + c.dH40, c.dW20, c.dH2 - c.dH5, m_Lfuel );
+        // Tank indicators level
+        QPen levelPen( Qt::black, c.dH40 + 4 );
+        levelPen.setCapStyle( Qt::RoundCap );
         ahrs.setPen( levelPen );
-        ahrs.drawLine( c.dW,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                       c.dW - c.dW40 - 1,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
+        ahrs.drawLine( 0.0,
+                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
+                       c.dW40,
+                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
         levelPen.setWidth( c.dH40 );
         levelPen.setColor( QColor( 255, 150, 255 ) );
         ahrs.setPen( levelPen );
-        ahrs.drawLine( c.dW,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                       c.dW - c.dW40 - 1,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
+        ahrs.drawLine( 0.0,
+                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
+                       c.dW40,
+                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
+
+        if( m_tanks.bDualTanks )
+        {
+            // Right Tank indicators background
+            ahrs.drawPixmap( c.dW - c.dW20 - 1, c.dH2 + c.dH40, c.dW20, c.dH2 - c.dH5, m_Rfuel );
+            // Right Tank indicators level
+            levelPen.setColor( Qt::black );
+            levelPen.setWidth( c.dH40 + 4 );
+            ahrs.setPen( levelPen );
+            ahrs.drawLine( c.dW,
+                           c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
+                           c.dW - c.dW40 - 1,
+                           c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
+            levelPen.setWidth( c.dH40 );
+            levelPen.setColor( QColor( 255, 150, 255 ) );
+            ahrs.setPen( levelPen );
+            ahrs.drawLine( c.dW,
+                           c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
+                           c.dW - c.dW40 - 1,
+                           c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
+        }
+
+        // Tank indicator active indicators
+        ahrs.setFont( large );
+        if( m_bFuelFlowStarted )
+        {
+            QPen fuelPen( Qt::yellow, c.dH80 );
+
+            ahrs.setPen( fuelPen );
+
+            if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
+                ahrs.drawLine( 0, c.dH2 + c.dH40 - 15, c.dW10 - 2, c.dH2 + c.dH40 - 15 );
+            else
+                ahrs.drawLine( c.dW - c.dW10 + 2, c.dH2 + c.dH40 - 15, c.dW, c.dH2 + c.dH40 - 15 );
+        }
+
+        stageDone( InfoRegion );
     }
 
-    // Tank indicator active indicators
-    ahrs.setFont( large );
-    if( m_bFuelFlowStarted )
+    if( dirty.intersects( m_regions[MapRegion] ) )
     {
-        QPen fuelPen( Qt::yellow, c.dH80 );
+        stageStart();
+
+        // Arrow for heading position above heading dial
+        ahrs.setBrush( Qt::white );
+        ahrs.setPen( Qt::black );
+        ahrs.drawPolygon( layout.headArrow );
+
+        // Draw the heading value over the indicator
+        ahrs.setPen( QPen( Qt::white, c.iThinPen ) );
+        ahrs.setBrush( Qt::black );
+        ahrs.drawRect( c.dW2 - (c.dWNum * 3.0 / 2.0) - (c.dW * 0.0125), layout.headArrow.boundingRect().y() - c.dHNum - c.dH40 - (c.dH * 0.0075), (c.dWNum * 3.0) + (c.dW * 0.025), c.dHNum + (c.dH * 0.015) );
+        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSGyroHeading ), 3 );
+        ahrs.drawPixmap( c.dW2 - (c.dWNum * 3.0 / 2.0), layout.headArrow.boundingRect().y() - c.dHNum - c.dH40, num );
+
+        // Draw the heading pixmap and rotate it to the current heading
+        ahrs.translate( layout.headCenter );
+        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.translate( -layout.headCenter );
+        drawLayer( &ahrs, HeadingDialLayer );
+        ahrs.resetTransform();
 
-        ahrs.setPen( fuelPen );
+        draw.drawDirectOrFromTo();
 
-        if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
-            ahrs.drawLine( 0, c.dH2 + c.dH40 - 15, c.dW10 - 2, c.dH2 + c.dH40 - 15 );
-        else
-            ahrs.drawLine( c.dW - c.dW10 + 2, c.dH2 + c.dH40 - 15, c.dW, c.dH2 + c.dH40 - 15 );
-    }
-
-    // Arrow for heading position above heading dial
-    arrow.clear();
-    arrow.append( QPointF( c.dW2, c.dH - c.dHeadDiam - 10.0 - c.dH80 ) );
-    arrow.append( QPointF( c.dW2 + c.dW40, c.dH - c.dHeadDiam - 10.0 - c.dH40 ) );
-    arrow.append( QPointF( c.dW2 - c.dW40, c.dH - c.dHeadDiam - 10.0 - c.dH40 ) );
-    ahrs.setBrush( Qt::white );
-    ahrs.setPen( Qt::black );
-    ahrs.drawPolygon( arrow );
-
-    // Draw the heading value over the indicator
-    ahrs.setPen( QPen( Qt::white, c.iThinPen ) );
-    ahrs.setBrush( Qt::black );
-    ahrs.drawRect( c.dW2 - (c.dWNum * 3.0 / 2.0) - (c.dW * 0.0125), arrow.boundingRect().y() - c.dHNum - c.dH40 - (c.dH * 0.0075), (c.dWNum * 3.0) + (c.dW * 0.025), c.dHNum + (c.dH * 0.015) );
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSGyroHeading ), 3 );
-    ahrs.drawPixmap( c.dW2 - (c.dWNum * 3.0 / 2.0), arrow.boundingRect().y() - c.dHNum - c.dH40, num );
-
-    // Draw the heading pixmap and rotate it to the current heading
-    ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    ahrs.rotate( -g_situation.dAHRSGyroHeading );
-    ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
-    ahrs.drawPixmap( c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam,  m_HeadIndicator );
-    ahrs.resetTransform();
-
-    draw.drawDirectOrFromTo();
-
-    // Update the airspace positions
-    draw.updateAirspaces();
-
-    // Update the airport positions
-    if( m_settings.eShowAirports != Canvas::ShowNoAirports )
-        draw.updateAirports();
-
-    // Update the traffic positions
-    draw.updateTraffic();
-
-    // Draw the central airplane
-    ahrs.drawPixmap( c.dW2 - c.dW20, c.dH - 10.0 - c.dHeadDiam2 - c.dW20, c.dW10, c.dW10, m_planeIcon );
-
-    // Draw the altitude bug
-    if( m_iAltBug >= 0 )
-    {
-        double dAltTip = c.dH4 - 10.0 - ((static_cast<double>( m_iAltBug ) - g_situation.dBaroPressAlt) * dPxPerFt);
-
-        ahrs.drawPixmap( c.dW - c.dW5 - c.dW20, dAltTip - c.dH40, c.dW20, c.dH20, m_AltBug );
-    }
-
-    // Draw the vertical speed static pixmap
-    ahrs.fillRect( c.dW - c.dW20 - c.dW40, 0.0, c.dW40, c.dH2, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( c.dW - c.dW20, 0, c.dW20, c.dH2, m_VertSpeedTape );
-
-    // Draw the vertical speed indicator
-    ahrs.translate( 0.0, c.dH4 - (dPxPerVSpeed * g_situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
-    arrow.clear();
-    arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 30.0 ), 0.0 ) );
-    arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( -7.0 ) ) );
-    arrow.append( QPoint( c.dW, m_pCanvas->scaledV( -15.0 ) ) );
-    arrow.append( QPoint( c.dW, m_pCanvas->scaledV( 15.0 ) ) );
-    arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( 7.0 ) ) );
-    ahrs.setPen( Qt::black );
-    ahrs.setBrush( Qt::white );
-    ahrs.drawPolygon( arrow );
-
-    QString qsFullVspeed = QString::number( g_situation.dGPSVertSpeed / 100.0, 'f', 1 );
-    QString qsFracVspeed = qsFullVspeed.right( 1 );
-    QString qsIntVspeed = qsFullVspeed.left( qsFullVspeed.length() - 2 );
-    QFontMetrics weeMetrics( wee );
-
-    // Draw vertical speed indicator as In thousands and hundreds of FPM in tiny text on the vertical speed arrow
-    ahrs.setFont( wee );
-    QRect intRect( weeMetrics.boundingRect( qsIntVspeed ) );
-    ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( 4.0 ), qsIntVspeed );
-    ahrs.setFont( itsy );
-    ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ) + intRect.width() + 2, m_pCanvas->scaledV( 4.0 ), qsFracVspeed );
-    ahrs.resetTransform();
-
-    // Draw the current altitude
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
-    draw.drawCurrAlt( &num );
-
-    // Draw the G-Force indicator scale
-    ahrs.setFont( tiny );
-    ahrs.setPen( Qt::black );
-    ahrs.drawText( c.dW - c.dW5, c.dH - 15, "0" );
-    ahrs.drawText( c.dW - c.dW5 + c.dW10 - (c.iTinyFontWidth / 2), c.dH - 15, "1" );
-    ahrs.drawText( c.dW - c.iTinyFontWidth - 10, c.dH - 15, "2" );
-    ahrs.setPen( Qt::white );
-    ahrs.drawText( c.dW - c.dW5 + 1, c.dH - 16, "0" );
-    ahrs.drawText( c.dW - c.dW5 + c.dW10 - (c.iTinyFontWidth / 2), c.dH - 16, "1" );
-    ahrs.drawText( c.dW - c.iTinyFontWidth - 11, c.dH - 16, "2" );
-
-    // Arrow for G-Force indicator
-    arrow.clear();
-    arrow.append( QPoint( 1, c.dH - c.iTinyFontHeight - m_pCanvas->scaledV( 10.0 ) ) );
-    arrow.append( QPoint( m_pCanvas->scaledH( -14.0 ), c.dH - c.iTinyFontHeight - m_pCanvas->scaledV( 25.0 ) ) );
-    arrow.append( QPoint( m_pCanvas->scaledH( 16.0 ), c.dH - c.iTinyFontHeight - m_pCanvas->scaledV( 25.0 ) ) );
-    ahrs.setPen( Qt::black );
-    ahrs.setBrush( Qt::white );
-    ahrs.translate( c.dW - c.dW5 + (c.iTinyFontWidth / 2) + (fabs( 1.0 - g_situation.dAHRSGLoad ) * c.dW5 * 20.0), -c.dH160 );
-    ahrs.drawPolygon( arrow );
-    ahrs.resetTransform();
-
-    ahrs.drawPixmap( c.dW40, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_DirectTo );
-    ahrs.drawPixmap( c.dW40 + c.dH20, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_FromTo );
-
-    // Draw the transparent overlay over the existing heading so the ticks and heading numbers are always visible
-    ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    ahrs.rotate( -g_situation.dAHRSGyroHeading );
-    ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
-    ahrs.drawPixmap( c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam,  m_HeadIndicatorOverlay );
-    ahrs.resetTransform();
-
-    // Draw the heading bug
-    if( m_iHeadBugAngle >= 0 )
-    {
-        ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
-        ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
-        ahrs.drawPixmap( c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam - (m_headIcon.height() / 2), m_headIcon );
-
-        // If long press triggered crosswind component display and the wind bug is set
-        if( m_bShowCrosswind && (m_iWindBugAngle >= 0) )
+        // Airspaces, airports and traffic
+        finishMapLayers( &ahrs );
+        draw.drawZoom();
+
+        // Draw the central airplane
+        ahrs.drawPixmap( QRectF( layout.headCenter - QPointF( c.dW20, c.dW20 ), QSizeF( c.dW10, c.dW10 ) ), m_planeIcon, m_planeIcon.rect() );
+
+        stageDone( MapRegion );
+    }
+
+    if( dirty.intersects( m_regions[AltitudeRegion] ) )
+    {
+        stageStart();
+
+        // Draw the altitude bug
+        if( m_iAltBug >= 0 )
         {
-            linePen.setWidth( c.iThinPen );
-            linePen.setColor( QColor( 0xFF, 0x90, 0x01 ) );
-            ahrs.setPen( linePen );
-            ahrs.drawLine( c.dW2, c.dH - 10.0 - c.dHeadDiam, c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
+            double dAltTip = c.dH4 - 10.0 - ((static_cast<double>( m_iAltBug ) - g_situation.dBaroPressAlt) * dPxPerFt);
+
+            ahrs.setClipRegion( m_regions[AltitudeRegion] );
+            ahrs.drawPixmap( c.dW - c.dW5 - c.dW20, dAltTip - c.dH40, c.dW20, c.dH20, m_AltBug );
+            ahrs.setClipping( false );
         }
 
+        stageDone( AltitudeRegion );
+    }
+
+    if( dirty.intersects( m_regions[VertSpeedRegion] ) )
+    {
+        stageStart();
+
+        // Draw the vertical speed static pixmap
+        drawLayer( &ahrs, VertSpeedScaleLayer );
+
+        // Draw the vertical speed indicator
+        ahrs.translate( 0.0, c.dH4 - (dPxPerVSpeed * g_situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
+        ahrs.setPen( Qt::black );
+        ahrs.setBrush( Qt::white );
+        ahrs.drawPolygon( layout.vertSpeedArrow );
+
+        QString qsFullVspeed = QString::number( g_situation.dGPSVertSpeed / 100.0, 'f', 1 );
+        QString qsFracVspeed = qsFullVspeed.right( 1 );
+        QString qsIntVspeed = qsFullVspeed.left( qsFullVspeed.length() - 2 );
+        QFontMetrics weeMetrics( wee );
+
+        // Draw vertical speed indicator as In thousands and hundreds of FPM in tiny text on the vertical speed arrow
+        ahrs.setFont( wee );
+        QRect intRect( weeMetrics.boundingRect( qsIntVspeed ) );
+        ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( 4.0 ), qsIntVspeed );
+        ahrs.setFont( itsy );
+        ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ) + intRect.width() + 2, m_pCanvas->scaledV( 4.0 ), qsFracVspeed );
         ahrs.resetTransform();
+
+        stageDone( VertSpeedRegion );
+    }
+
+    if( dirty.intersects( m_regions[AltitudeRegion] ) )
+    {
+        stageStart();
+
+        // Draw the current altitude
+        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
+        draw.drawCurrAlt( &num );
+
+        stageDone( AltitudeRegion );
     }
 
-    // Draw the wind bug
-    if( m_iWindBugAngle >= 0 )
+    if( dirty.intersects( m_regions[InfoRegion] ) )
     {
-        ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSGyroHeading );
-        ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
-        ahrs.drawPixmap( c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam - (m_headIcon.height() / 2), m_windIcon );
+        stageStart();
 
-        QString      qsWind = QString::number( m_iWindBugSpeed );
-        QFontMetrics windMetrics( tiny );
-        QRect        windRect = windMetrics.boundingRect( qsWind );
+        // Draw the G-Force indicator scale
+        drawLayer( &ahrs, GForceScaleLayer );
 
-        ahrs.setFont( tiny );
+        // Arrow for G-Force indicator
         ahrs.setPen( Qt::black );
-        ahrs.drawText( c.dW2 - (windRect.width() / 2), c.dH - c.dHeadDiam - c.dH160, qsWind );
-        ahrs.setPen( Qt::white );
-        ahrs.drawText( c.dW2 - (windRect.width() / 2) - 1, c.dH - c.dHeadDiam - c.dH160 - 1, qsWind );
+        ahrs.setBrush( Qt::white );
+        ahrs.translate( c.dW - c.dW5 + (c.iTinyFontWidth / 2) + (fabs( 1.0 - g_situation.dAHRSGLoad ) * c.dW5 * 20.0), -c.dH160 );
+        ahrs.drawPolygon( layout.gForceArrow );
+        ahrs.resetTransform();
+
+        ahrs.drawPixmap( c.dW40, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_DirectTo );
+        ahrs.drawPixmap( c.dW40 + c.dH20, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_FromTo );
+
+        stageDone( InfoRegion );
+    }
+
+    if( dirty.intersects( m_regions[MapRegion] ) )
+    {
+        stageStart();
 
-        // If long press triggered crosswind component display and the heading bug is set
-        if( m_bShowCrosswind && (m_iHeadBugAngle >= 0) )
+        // Draw the transparent overlay over the existing heading so the ticks and heading numbers are always visible
+        ahrs.translate( layout.headCenter );
+        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.translate( -layout.headCenter );
+        drawLayer( &ahrs, HeadingOverlayLayer );
+        ahrs.resetTransform();
+
+        // Draw the heading bug
+        if( m_iHeadBugAngle >= 0 )
         {
-            linePen.setWidth( c.iThinPen );
-            linePen.setColor( Qt::cyan );
-            ahrs.setPen( linePen );
-            ahrs.drawLine( c.dW2, c.dH - 10 - c.dHeadDiam, c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-
-            // Draw the crosswind component calculated from heading vs wind
-            double dAng = fabs( static_cast<double>( m_iWindBugAngle ) - static_cast<double>( m_iHeadBugAngle ) );
-            while( dAng > 180.0 )
-                dAng -= 360.0;
-            dAng = fabs( dAng );
-            double dCrossComp = fabs( static_cast<double>( m_iWindBugSpeed ) * sin( dAng * ToRad ) );
-            double dCrossPos = c.dH - (c.dW / 1.3) - 10.0;
-            QString qsCrossAng = QString( "%1%2" ).arg( static_cast<int>( dAng ) ).arg( QChar( 176 ) );
+            ahrs.translate( layout.headCenter );
+            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.translate( -layout.headCenter );
+            ahrs.drawPixmap( c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam - (m_headIcon.height() / 2), m_headIcon );
+
+            // If long press triggered crosswind component display and the wind bug is set
+            if( m_bShowCrosswind && (m_iWindBugAngle >= 0) )
+            {
+                linePen.setWidth( c.iThinPen );
+                linePen.setColor( QColor( 0xFF, 0x90, 0x01 ) );
+                ahrs.setPen( linePen );
+                ahrs.drawLine( c.dW2, c.dH - 10.0 - c.dHeadDiam, c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
+            }
 
             ahrs.resetTransform();
-            ahrs.translate( c.dW2, c.dH - c.dW2 - 10.0 );
-            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
-            ahrs.translate( -c.dW2, -(c.dH - c.dW2 - 10.0) );
-            ahrs.setFont( large );
-            ahrs.setPen( Qt::black );
-            ahrs.drawText( c.dW2 + 5.0, dCrossPos, QString::number( static_cast<int>( dCrossComp ) ) );
-            ahrs.setPen( QColor( 0xFF, 0x90, 0x01 ) );
-            ahrs.drawText( c.dW2 + 3.0, dCrossPos - 2.0, QString::number( static_cast<int>( dCrossComp ) ) );
-            ahrs.setFont( med );
+        }
+
+        // Draw the wind bug
+        if( m_iWindBugAngle >= 0 )
+        {
+            ahrs.translate( layout.headCenter );
+            ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.translate( -layout.headCenter );
+            ahrs.drawPixmap( c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam - (m_headIcon.height() / 2), m_windIcon );
+
+            QString      qsWind = QString::number( m_iWindBugSpeed );
+            QFontMetrics windMetrics( tiny );
+            QRect        windRect = windMetrics.boundingRect( qsWind );
+
+            ahrs.setFont( tiny );
             ahrs.setPen( Qt::black );
-            ahrs.drawText( c.dW2 + 5.0, dCrossPos + c.iMedFontHeight - 5, qsCrossAng );
-            ahrs.setPen( Qt::cyan );
-            ahrs.drawText( c.dW2 + 3.0, dCrossPos + c.iMedFontHeight - 7, qsCrossAng );
+            ahrs.drawText( c.dW2 - (windRect.width() / 2), c.dH - c.dHeadDiam - c.dH160, qsWind );
+            ahrs.setPen( Qt::white );
+            ahrs.drawText( c.dW2 - (windRect.width() / 2) - 1, c.dH - c.dHeadDiam - c.dH160 - 1, qsWind );
+
+            // If long press triggered crosswind component display and the heading bug is set
+            if( m_bShowCrosswind && (m_iHeadBugAngle >= 0) )
+            {
+                linePen.setWidth( c.iThinPen );
+                linePen.setColor( Qt::cyan );
+                ahrs.setPen( linePen );
+                ahrs.drawLine( c.dW2, c.dH - 10 - c.dHeadDiam, c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
+
+                // Draw the crosswind component calculated from heading vs wind
+                double dAng = fabs( static_cast<double>( m_iWindBugAngle ) - static_cast<double>( m_iHeadBugAngle ) );
+                while( dAng > 180.0 )
+                    dAng -= 360.0;
+                dAng = fabs( dAng );
+                double dCrossComp = fabs( static_cast<double>( m_iWindBugSpeed ) * sin( dAng * ToRad ) );
+                double dCrossPos = c.dH - (c.dW / 1.3) - 10.0;
+                QString qsCrossAng = QString( "%1%2" ).arg( static_cast<int>( dAng ) ).arg( QChar( 176 ) );
+
+                ahrs.resetTransform();
+                ahrs.translate( c.dW2, c.dH - c.dW2 - 10.0 );
+                ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+                ahrs.translate( -c.dW2, -(c.dH - c.dW2 - 10.0) );
+                ahrs.setFont( large );
+                ahrs.setPen( Qt::black );
+                ahrs.drawText( c.dW2 + 5.0, dCrossPos, QString::number( static_cast<int>( dCrossComp ) ) );
+                ahrs.setPen( QColor( 0xFF, 0x90, 0x01 ) );
+                ahrs.drawText( c.dW2 + 3.0, dCrossPos - 2.0, QString::number( static_cast<int>( dCrossComp ) ) );
+                ahrs.setFont( med );
+                ahrs.setPen( Qt::black );
+                ahrs.drawText( c.dW2 + 5.0, dCrossPos + c.iMedFontHeight - 5, qsCrossAng );
+                ahrs.setPen( Qt::cyan );
+                ahrs.drawText( c.dW2 + 3.0, dCrossPos + c.iMedFontHeight - 7, qsCrossAng );
+            }
+
+            ahrs.resetTransform();
         }
 
-        ahrs.resetTransform();
+        stageDone( MapRegion );
     }
 
+    if( m_settings.bShowAirspaces )
+        draw.paintAirspaceAlert();
+
     if( (m_iTimerMin >= 0) && (m_iTimerSec >= 0) )
         draw.paintTimer( m_iTimerMin, m_iTimerSec );
 
@@ -1226,12 +1245,11 @@ void AHRSCanvas::paintPortrait()
 
 
 
-void AHRSCanvas::paintLandscape()
+void AHRSCanvas::paintLandscape( QPaintDevice *pDevice, const QRegion &dirty )
 {
-    QPainter        ahrs( this );
+    QPainter        ahrs( pDevice );
     CanvasConstants c = m_pCanvas->constants();
     double          dPitchH = c.dH2 + (g_situation.dAHRSpitch / 22.5 * c.dH2);     // The visible portion is only 1/4 of the 90 deg range
-    QPolygon        shape;
     QPen            linePen( Qt::black );
     double          dSlipSkid = c.dW2 - ((g_situation.dAHRSSlipSkid / 100.0) * c.dW2);
     double          dPxPerVSpeed = c.dH / 40.0;
@@ -1239,13 +1257,19 @@ void AHRSCanvas::paintLandscape()
     double          dPxPerFt = static_cast<double>( m_AltTape.height() ) / 20000.0 * 0.99;  // 0.99 accounts for the few pixels above and below the numbers in the pixmap that offset the position at the extremes of the scale
     QFontMetrics    tinyMetrics( tiny );
     QPixmap         num( 320, 84 );
+    bool            bAttitude;
+    const CanvasLayout &layout = m_pCanvas->layout();
     AHRSDraw        draw( &ahrs, &c, m_pCanvas,
                           &m_directAP, &m_fromAP, &m_toAP, &m_airports, &m_airspaces, m_dZoomNM, &m_settings, m_iMagDev,
-                          &m_trafficRed,
-                          &m_trafficYellow,
-                          &m_trafficGreen,
-                          &m_trafficCyan,
-                          &m_trafficOrange );
+                          &m_trafficAtlas );
+
+    draw.setAirspaceAlert( &m_airspaceAlert );
+    if( !layersValid( c ) )
+        buildLayers( c );
+
+    // The moving map is drawn on the worker pool while the attitude and tapes are painted here
+    if( dirty.intersects( m_regions[MapRegion] ) )
+        startMapLayers( c );
 
     if( dSlipSkid < (c.dW4 + 25.0) )
         dSlipSkid = c.dW4 + 25.0;
@@ -1256,416 +1280,1093 @@ void AHRSCanvas::paintLandscape()
 
     ahrs.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
 
-    // Clip the attitude to the left half of the display
-    ahrs.setClipRect( 0, 0, c.dW, c.dH );
+    // A map-only repaint still has to put back the attitude under the edge of the map region, but nothing more of it
+    bAttitude = dirty.intersects( m_regions[AttitudeRegion] );
+    if( bAttitude || dirty.intersects( m_attitudeUnderMap ) )
+    {
+        stageStart();
 
-    // Translate to dead center and rotate by stratux roll then translate back
-    ahrs.translate( c.dW2 - c.dW20, c.dH2 );
-    ahrs.rotate( -g_situation.dAHRSroll );
-    ahrs.translate( -(c.dW2 - c.dW20), -c.dH2 );
+        if( !bAttitude )
+            ahrs.setClipRegion( m_attitudeUnderMap );
 
-    ahrs.translate( -c.dW20, 0.0 );
+        // Clip the attitude to the left half of the display
+        ahrs.setClipRect( layout.attitudeClip, bAttitude ? Qt::ReplaceClip : Qt::IntersectClip );
 
-    // Top half sky blue gradient offset by stratux pitch
-    QLinearGradient skyGradient( 0.0, -c.dH4, 0.0, dPitchH );
-    skyGradient.setColorAt( 0, Qt::blue );
-    skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
-    ahrs.fillRect( -400.0, -c.dH4, c.dW + 800.0, dPitchH + c.dH4, skyGradient );
+        // Translate to dead center and rotate by stratux roll then translate back
+        ahrs.translate( c.dW2 - c.dW20, c.dH2 );
+        ahrs.rotate( -g_situation.dAHRSroll );
+        ahrs.translate( -(c.dW2 - c.dW20), -c.dH2 );
 
-    // Draw brown gradient horizon half offset by stratux pitch
-    // Extreme overdraw accounts for extreme roll angles that might expose the corners
-    QLinearGradient groundGradient( 0.0, c.dH2, 0, c.dH + c.dH4 );
-    groundGradient.setColorAt( 0, QColor( 170, 85, 0 ) );
-    groundGradient.setColorAt( 1, Qt::black );
+        ahrs.translate( -c.dW20, 0.0 );
 
-    ahrs.fillRect( -400.0, dPitchH, c.dW + 800.0, c.dH, groundGradient );
-    ahrs.setPen( linePen );
-    ahrs.drawLine( -400, dPitchH, c.dW + 800.0, dPitchH );
+        // Top half sky blue gradient offset by stratux pitch
+        QLinearGradient skyGradient( 0.0, -c.dH4, 0.0, dPitchH );
+        skyGradient.setColorAt( 0, Qt::blue );
+        skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
+        ahrs.fillRect( -400.0, -c.dH4, c.dW + 800.0, dPitchH + c.dH4, skyGradient );
 
-    for( double i = 0.0; i < 20.0; i += 10.0 )
-    {
-        linePen.setColor( Qt::cyan );
-        ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH - ((i + 10.0) / 45.0 * c.dH2), c.dW2 + c.dW5, dPitchH - (( i + 10.0) / 45.0 * c.dH2) );
-        linePen.setColor( QColor( 67, 33, 9 ) );
+        // Draw brown gradient horizon half offset by stratux pitch
+        // Extreme overdraw accounts for extreme roll angles that might expose the corners
+        QLinearGradient groundGradient( 0.0, c.dH2, 0, c.dH + c.dH4 );
+        groundGradient.setColorAt( 0, QColor( 170, 85, 0 ) );
+        groundGradient.setColorAt( 1, Qt::black );
+
+        ahrs.fillRect( -400.0, dPitchH, c.dW + 800.0, c.dH, groundGradient );
         ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH + ((i + 10.0) / 45.0 * c.dH2), c.dW2 + c.dW5, dPitchH + (( i + 10.0) / 45.0 * c.dH2) );
-    }
+        ahrs.drawLine( -400, dPitchH, c.dW + 800.0, dPitchH );
 
-    ahrs.translate( c.dW20, 0.0 );
+        ahrs.translate( 0.0, dPitchH );
+        drawLayer( &ahrs, PitchLadderLayer );
 
-    // Reset rotation
-    ahrs.resetTransform();
+        // Reset rotation
+        ahrs.resetTransform();
 
-    // Remove the clipping rect
-    ahrs.setClipping( false );
+        // Remove the clipping rect
+        if( bAttitude )
+            ahrs.setClipping( false );
+        else
+            ahrs.setClipRegion( m_attitudeUnderMap );
 
-    ahrs.translate( -c.dW20, 0.0 );
-
-    // Slip/Skid indicator
-    draw.drawSlipSkid( dSlipSkid );
-
-    // Draw the top roll indicator
-    ahrs.translate( c.dW2, c.dH20 + ((c.dW - c.dW5) / 2.0) );
-    ahrs.rotate( -g_situation.dAHRSroll );
-    ahrs.translate( -c.dW2, -(c.dH20 + ((c.dW - c.dW5) / 2.0)) );
-    ahrs.drawPixmap( c.dW2 - ((c.dW - c.dW5) / 2.0), c.dH20, c.dW - c.dW5, c.dW - c.dW5, m_RollIndicator );
-    ahrs.resetTransform();
-
-    ahrs.translate( -c.dW20, 0.0 );
-
-    QPolygonF arrow;
-
-    arrow.append( QPointF( c.dW2, c.dH10 ) );
-    arrow.append( QPointF( c.dW2 + c.dW40, c.dH10 + c.dH40 ) );
-    arrow.append( QPointF( c.dW2 - c.dW40, c.dH10 + c.dH40 ) );
-    ahrs.setBrush( Qt::white );
-    ahrs.setPen( Qt::black );
-    ahrs.drawPolygon( arrow );
-
-    // Draw the yellow pitch indicators
-    ahrs.setBrush( Qt::yellow );
-    shape.append( QPoint( c.dW5 + c.dW10, c.dH2 - c.dH160 - 4.0 ) );
-    shape.append( QPoint( c.dW2 - c.dW10, c.dH2 - c.dH160 - 4.0 ) );
-    shape.append( QPoint( c.dW2 - c.dW10 + 20, c.dH2 ) );
-    shape.append( QPoint( c.dW2 - c.dW10, c.dH2 + c.dH160 + 4.0 ) );
-    shape.append( QPoint( c.dW5 + c.dW10, c.dH2 + c.dH160 + 4.0 ) );
-    ahrs.drawPolygon( shape );
-    shape.clear();
-    shape.append( QPoint( c.dW - c.dW5 - c.dW10, c.dH2 - c.dH160 - 4.0 ) );
-    shape.append( QPoint( c.dW2 + c.dW10, c.dH2 - c.dH160 - 4.0 ) );
-    shape.append( QPoint( c.dW2 + c.dW10 - 20, c.dH2 ) );
-    shape.append( QPoint( c.dW2 + c.dW10, c.dH2 + c.dH160 + 4.0 ) );
-    shape.append( QPoint( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH160 + 4.0 ) );
-    ahrs.drawPolygon( shape );
-    shape.clear();
-    shape.append( QPoint( c.dW2, c.dH2 ) );
-    shape.append( QPoint( c.dW2 - c.dW20, c.dH2 + 20 ) );
-    shape.append( QPoint( c.dW2 + c.dW20, c.dH2 + 20 ) );
-    ahrs.drawPolygon( shape );
-
-    ahrs.translate( c.dW20, 0.0 );
-
-    // Arrow for heading position above heading dial
-    arrow.clear();
-    arrow.append( QPointF( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 - c.dH80 ) );
-    arrow.append( QPointF( c.dW + c.dW2 + c.dW40, c.dH - 10.0 - c.dHeadDiam2 - c.dH40 ) );
-    arrow.append( QPointF( c.dW + c.dW2 - c.dW40, c.dH - 10.0 - c.dHeadDiam2 - c.dH40 ) );
-    ahrs.setBrush( Qt::white );
-    ahrs.setPen( Qt::black );
-    ahrs.drawPolygon( arrow );
-
-    // Draw the heading pixmap and rotate it to the current heading
-    ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    ahrs.rotate( -g_situation.dAHRSGyroHeading );
-    ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
-    ahrs.drawPixmap( c.dW + c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam, m_HeadIndicator );
-    ahrs.resetTransform();
-
-    draw.drawDirectOrFromTo();
-
-    // Draw the central airplane
-    ahrs.drawPixmap( c.dW + c.dW2 - c.dW20, c.dH - 10.0 - c.dHeadDiam2 - c.dW20, c.dW10, c.dW10, m_planeIcon );
-
-    // Draw the Altitude tape
-    ahrs.fillRect( c.dW - c.dW5 - c.dW40, 0, c.dW5 + c.dW40, c.dH, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( c.dW - c.dW5 - c.dW40 + 5, c.dH2 + 10.0 - m_AltTape.height() + (g_situation.dBaroPressAlt * dPxPerFt) , m_AltTape );
-
-    // Draw the altitude bug
-    if( m_iAltBug >= 0 )
-    {
-        double dAltTip = c.dH2 - 10.0 - ((static_cast<double>( m_iAltBug ) - g_situation.dBaroPressAlt) * dPxPerFt);
-
-        ahrs.drawPixmap( c.dW - c.dW5 - c.dW20 - c.dW40, dAltTip - c.dH40, c.dW20, c.dH20, m_AltBug );
-    }
-
-    // Draw the vertical speed static pixmap
-    ahrs.fillRect( c.dW - c.dW20 - c.dW40, 0.0, c.dW40, c.dH, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( c.dW - c.dW20, 0, c.dW20, c.dH, m_VertSpeedTape );
-
-    // Draw the vertical speed indicator
-    ahrs.translate( 0.0, c.dH2 - (dPxPerVSpeed * g_situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
-    arrow.clear();
-    arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 30.0 ), 0.0 ) );
-    arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( -7.0 ) ) );
-    arrow.append( QPoint( c.dW, m_pCanvas->scaledV( -15.0 ) ) );
-    arrow.append( QPoint( c.dW, m_pCanvas->scaledV( 15.0 ) ) );
-    arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( 7.0 ) ) );
-    ahrs.setPen( Qt::black );
-    ahrs.setBrush( Qt::white );
-    ahrs.drawPolygon( arrow );
-
-    QString qsFullVspeed = QString::number( g_situation.dGPSVertSpeed / 100.0, 'f', 1 );
-    QString qsFracVspeed = qsFullVspeed.right( 1 );
-    QString qsIntVspeed = qsFullVspeed.left( qsFullVspeed.length() - 2 );
-    QFontMetrics weeMetrics( wee );
-
-    // Draw vertical speed indicator as In thousands and hundreds of FPM in tiny text on the vertical speed arrow
-    ahrs.setFont( wee );
-    QRect intRect( weeMetrics.boundingRect( qsIntVspeed ) );
-
-    ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( 4.0 ), qsIntVspeed );
-    ahrs.setFont( itsy );
-    ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ) + intRect.width() + 2, m_pCanvas->scaledV( 4.0 ), qsFracVspeed );
-    ahrs.resetTransform();
-
-    // Draw the current altitude
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
-    draw.drawCurrAlt( &num );
-
-    // Draw the Speed tape
-    ahrs.fillRect( 0, 0, c.dW10 + 5.0, c.dH, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( 5, c.dH2 + 5.0 - m_SpeedTape.height() + (g_situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
-
-    // Draw the current speed
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
-    draw.drawCurrSpeed( &num );
-
-    ahrs.setFont( wee );
-    ahrs.setPen( Qt::black );
-    QString qsUnits( speedUnits() );
-    ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0) + 1, c.dH2 + c.dH80 + 1, qsUnits );
-    ahrs.setPen( Qt::white );
-    ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0), c.dH2 + c.dH80, qsUnits );
-
-    // Arrow for heading position above heading dial
-    arrow.clear();
-    arrow.append( QPointF( c.dW + c.dW2, c.dH - c.dHeadDiam - 10.0 - c.dH80 ) );
-    arrow.append( QPointF( c.dW + c.dW2 + c.dW40, c.dH - c.dHeadDiam - 10.0 - c.dH40 ) );
-    arrow.append( QPointF( c.dW + c.dW2 - c.dW40, c.dH - c.dHeadDiam - 10.0 - c.dH40 ) );
-    ahrs.setBrush( Qt::white );
-    ahrs.setPen( Qt::black );
-    ahrs.drawPolygon( arrow );
-
-    // Draw the heading value over the indicator
-    ahrs.setPen( QPen( Qt::white, c.iThinPen ) );
-    ahrs.setBrush( Qt::black );
-    ahrs.drawRect( c.dW + c.dW2 - (c.dWNum * 3.0 / 2.0) - (c.dW * 0.0125), 10.0, (c.dWNum * 3.0) + (c.dW * 0.025), c.dHNum + (c.dH * 0.015) );
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSGyroHeading ), 3 );
-    ahrs.drawPixmap( c.dW + c.dW2 - (c.dWNum * 3.0 / 2.0), 10.0 + (c.dH * 0.0075), num );
-
-    // Draw the G-Force indicator box and scale
-    ahrs.setFont( tiny );
-    ahrs.setPen( Qt::black );
-    ahrs.drawText( c.dW2 - c.dW20 - c.dW10 - (c.iTinyFontWidth / 2) + 1, c.dH - 15, "0" );
-    ahrs.drawText( c.dW2 - c.dW20 - (c.iTinyFontWidth / 2) + 1, c.dH - 15, "1" );
-    ahrs.drawText( c.dW2 - c.dW20 + c.dW10 - (c.iTinyFontWidth / 2) + 1, c.dH - 15, "2" );
-    ahrs.setPen( Qt::white );
-    ahrs.drawText( c.dW2 - c.dW20 - c.dW10 - (c.iTinyFontWidth / 2), c.dH - 16, "0" );
-    ahrs.drawText( c.dW2 - c.dW20 - (c.iTinyFontWidth / 2), c.dH - 16, "1" );
-    ahrs.drawText( c.dW2 - c.dW20 + c.dW10 - (c.iTinyFontWidth / 2), c.dH - 16, "2" );
-
-    // Arrow for G-Force indicator
-    arrow.clear();
-    arrow.append( QPoint( 0, c.dH - c.iTinyFontHeight - 10.0 ) );
-    arrow.append( QPoint( -14.0, c.dH - c.iTinyFontHeight - 25.0 ) );
-    arrow.append( QPoint( 16.0, c.dH - c.iTinyFontHeight - 25.0 ) );
-    ahrs.setPen( Qt::black );
-    ahrs.setBrush( Qt::white );
-    ahrs.translate( (fabs( 1.0 - g_situation.dAHRSGLoad ) * (c.dW5 + c.dW10) * 20.0) + c.dW2 - c.dW20 - c.dW10, -c.dH80 );
-    ahrs.drawPolygon( arrow );
-    ahrs.resetTransform();
-
-    // Left Tank indicators background
-    ahrs.drawPixmap( c.dW10 + c.dW20, c.dH2 + c.dH10, c.dW20, c.dH2 - c.dH5, m_Lfuel );
-    // Tank indicators level
-    QPen levelPen( Qt::black, c.dH40 + 4 );
-    levelPen.setCapStyle( Qt::RoundCap );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40 + c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-    levelPen.setWidth( c.dH40 );
-    levelPen.setColor( QColor( 255, 150, 255 ) );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40 + c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-    // Right Tank indicators background
-    ahrs.drawPixmap( c.dW - c.dW5 - c.dW10 - 1, c.dH2 + c.dH10, c.dW20, c.dH2 - c.dH5, m_Rfuel );
-    // Right Tank indicators level
-    levelPen.setColor( Qt::black );
-    levelPen.setWidth( c.dH40 + 4 );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW - c.dW5 - c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                   c.dW - c.dW40 - c.dW5 - c.dW20 - 1,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
-    levelPen.setWidth( c.dH40 );
-    levelPen.setColor( QColor( 255, 150, 255 ) );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW - c.dW5 - c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                   c.dW - c.dW40 - c.dW5 - c.dW20 - 1,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
-
-    // Tank indicator active indicators
-    ahrs.setFont( large );
-    if( m_bFuelFlowStarted )
-    {
-        QPen fuelPen( Qt::yellow, c.dH80 );
+        ahrs.translate( -c.dW20, 0.0 );
 
-        ahrs.setPen( fuelPen );
+        // Slip/Skid indicator
+        draw.drawSlipSkid( dSlipSkid );
 
-        if( !m_tanks.bDualTanks )
-        {
-            ahrs.drawLine( c.dW10, c.dH2 + c.dH10 - c.dH80 - 5, c.dW10, c.dH2 + c.dH10 - c.dH80 - 5 );
-            ahrs.drawLine( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH10 - c.dH80 - 5, c.dW - c.dW5, c.dH2 + c.dH10 - c.dH80 - 5 );
-        }
-        else
-        {
-            if( m_tanks.bOnLeftTank )
-                ahrs.drawLine( c.dW10, c.dH2 + c.dH10 - 15, c.dW5, c.dH2 + c.dH10 - 15 );
-            else
-                ahrs.drawLine( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH10 - 15, c.dW - c.dW5, c.dH2 + c.dH10 - 15 );
-        }
+        // Draw the top roll indicator
+        ahrs.translate( c.dW2, c.dH20 + ((c.dW - c.dW5) / 2.0) );
+        ahrs.rotate( -g_situation.dAHRSroll );
+        ahrs.translate( -c.dW2, -(c.dH20 + ((c.dW - c.dW5) / 2.0)) );
+        drawLayer( &ahrs, RollScaleLayer );
+        ahrs.resetTransform();
+
+        ahrs.translate( -c.dW20, 0.0 );
+
+        // Roll pointer and the yellow pitch indicators
+        drawLayer( &ahrs, AttitudeMarksLayer );
+        ahrs.setClipping( false );
+
+        ahrs.translate( c.dW20, 0.0 );
+
+        stageDone( AttitudeRegion );
     }
 
-    // Update the airspace positions
-    draw.updateAirspaces();
+    if( dirty.intersects( m_regions[MapRegion] ) )
+    {
+        stageStart();
+
+        // Arrow for heading position above heading dial
+        ahrs.setBrush( Qt::white );
+        ahrs.setPen( Qt::black );
+        ahrs.drawPolygon( layout.headCenterArrow );
 
-    // Update the airport positions
-    if( m_settings.eShowAirports != Canvas::ShowNoAirports )
-        draw.updateAirports();
+        // Draw the heading pixmap and rotate it to the current heading
+        ahrs.translate( layout.headCenter );
+        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.translate( -layout.headCenter );
+        drawLayer( &ahrs, HeadingDialLayer );
+        ahrs.resetTransform();
 
-    // Update the traffic positions
-    draw.updateTraffic();
+        draw.drawDirectOrFromTo();
 
-    ahrs.drawPixmap( c.dW + c.dW40, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_DirectTo );
-    ahrs.drawPixmap( c.dW + c.dW40 + c.dH20, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_FromTo );
+        // Draw the central airplane
+        ahrs.drawPixmap( QRectF( layout.headCenter - QPointF( c.dW20, c.dW20 ), QSizeF( c.dW10, c.dW10 ) ), m_planeIcon, m_planeIcon.rect() );
 
-    // Draw the heading overlay so the markers aren't covered by other elements
-    ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    ahrs.rotate( -g_situation.dAHRSGyroHeading );
-    ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
-    ahrs.drawPixmap( c.dW + c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam,  m_HeadIndicatorOverlay );
-    ahrs.resetTransform();
+        stageDone( MapRegion );
+    }
 
-    // Draw the heading bug
-    if( m_iHeadBugAngle >= 0 )
+    if( dirty.intersects( m_regions[AltitudeRegion] ) )
     {
-        ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
-        ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
-        ahrs.drawPixmap( c.dW + c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam, m_headIcon );
+        stageStart();
+
+        // Draw the Altitude tape
+        drawLayer( &ahrs, AltTapeBackLayer );
+        ahrs.drawPixmap( c.dW - c.dW5 - c.dW40 + 5, c.dH2 + 10.0 - m_AltTape.height() + (g_situation.dBaroPressAlt * dPxPerFt) , m_AltTape );
 
-        // If long press triggered crosswind component display and the wind bug is set
-        if( m_bShowCrosswind && (m_iWindBugAngle >= 0) )
+        // Draw the altitude bug
+        if( m_iAltBug >= 0 )
         {
-            linePen.setWidth( c.iThinPen );
-            linePen.setColor( QColor( 0xFF, 0x90, 0x01 ) );
-            ahrs.setPen( linePen );
-            ahrs.drawLine( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam, c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam );
+            double dAltTip = c.dH2 - 10.0 - ((static_cast<double>( m_iAltBug ) - g_situation.dBaroPressAlt) * dPxPerFt);
+
+            ahrs.setClipRegion( m_regions[AltitudeRegion] );
+            ahrs.drawPixmap( c.dW - c.dW5 - c.dW20 - c.dW40, dAltTip - c.dH40, c.dW20, c.dH20, m_AltBug );
+            ahrs.setClipping( false );
         }
 
-        ahrs.resetTransform();
+        stageDone( AltitudeRegion );
     }
 
-    // Draw the wind bug
-    if( m_iWindBugAngle >= 0 )
+    if( dirty.intersects( m_regions[VertSpeedRegion] ) )
     {
-        ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSGyroHeading );
-        ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
-        ahrs.drawPixmap( c.dW + c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam, m_windIcon );
+        stageStart();
 
-        QString      qsWind = QString::number( m_iWindBugSpeed );
-        QFontMetrics windMetrics( tiny );
-        QRect        windRect = windMetrics.boundingRect( qsWind );
+        // Draw the vertical speed static pixmap
+        drawLayer( &ahrs, VertSpeedScaleLayer );
 
-        ahrs.setFont( tiny );
+        // Draw the vertical speed indicator
+        ahrs.translate( 0.0, c.dH2 - (dPxPerVSpeed * g_situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
         ahrs.setPen( Qt::black );
-        ahrs.drawText( c.dW + c.dW2 - (windRect.width() / 2), c.dH - 10.0 - c.dHeadDiam, qsWind );
-        ahrs.setPen( Qt::white );
-        ahrs.drawText( c.dW + c.dW2 - (windRect.width() / 2) - 1, c.dH - 10.0 - c.dHeadDiam, qsWind );
+        ahrs.setBrush( Qt::white );
+        ahrs.drawPolygon( layout.vertSpeedArrow );
 
-        // If long press triggered crosswind component display and the heading bug is set
-        if( m_bShowCrosswind && (m_iHeadBugAngle >= 0) )
-        {
-            linePen.setWidth( c.iThinPen );
-            linePen.setColor( Qt::cyan );
-            ahrs.setPen( linePen );
-            ahrs.drawLine( c.dW + c.dW2, c.dH - 10 - c.dHeadDiam, c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam );
-
-            // Draw the crosswind component calculated from heading vs wind
-            double dAng = fabs( static_cast<double>( m_iWindBugAngle ) - static_cast<double>( m_iHeadBugAngle ) );
-            while( dAng > 180.0 )
-                dAng -= 360.0;
-            dAng = fabs( dAng );
-            double dCrossComp = fabs( static_cast<double>( m_iWindBugSpeed ) * sin( dAng * ToRad ) );
-            double dCrossPos = c.dH - (c.dW / 1.3) - 10.0;
-            QString qsCrossAng = QString( "%1%2" ).arg( static_cast<int>( dAng ) ).arg( QChar( 176 ) );
+        QString qsFullVspeed = QString::number( g_situation.dGPSVertSpeed / 100.0, 'f', 1 );
+        QString qsFracVspeed = qsFullVspeed.right( 1 );
+        QString qsIntVspeed = qsFullVspeed.left( qsFullVspeed.length() - 2 );
+        QFontMetrics weeMetrics( wee );
 
-            ahrs.resetTransform();
-            ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
-            ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
-            ahrs.setFont( large );
-            ahrs.setPen( Qt::black );
-            ahrs.drawText( c.dW + c.dW2 + 5.0, dCrossPos, QString::number( static_cast<int>( dCrossComp ) ) );
-            ahrs.setPen( QColor( 0xFF, 0x90, 0x01 ) );
-            ahrs.drawText( c.dW + c.dW2 + 3.0, dCrossPos - 2.0, QString::number( static_cast<int>( dCrossComp ) ) );
-            ahrs.setFont( med );
-            ahrs.setPen( Qt::black );
-            ahrs.drawText( c.dW + c.dW2 + 5.0, dCrossPos + c.iMedFontHeight - 5, qsCrossAng );
-            ahrs.setPen( Qt::cyan );
-            ahrs.drawText( c.dW + c.dW2 + 3.0, dCrossPos + c.iMedFontHeight - 7, qsCrossAng );
-        }
+        // Draw vertical speed indicator as In thousands and hundreds of FPM in tiny text on the vertical speed arrow
+        ahrs.setFont( wee );
+        QRect intRect( weeMetrics.boundingRect( qsIntVspeed ) );
 
+        ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( 4.0 ), qsIntVspeed );
+        ahrs.setFont( itsy );
+        ahrs.drawText( c.dW - m_pCanvas->scaledH( 20.0 ) + intRect.width() + 2, m_pCanvas->scaledV( 4.0 ), qsFracVspeed );
         ahrs.resetTransform();
-    }
-
-    if( (m_iTimerMin >= 0) && (m_iTimerSec >= 0) )
-        draw.paintTimer( m_iTimerMin, m_iTimerSec );
 
-    if( m_bShowGPSDetails )
-        draw.paintInfo();
-    else if( m_bDisplayTanksSwitchNotice )
-        draw.paintSwitchNotice( &m_tanks );
-}
+        stageDone( VertSpeedRegion );
+    }
 
+    if( dirty.intersects( m_regions[AltitudeRegion] ) )
+    {
+        stageStart();
 
-void AHRSCanvas::timerReminder( int iMinutes, int iSeconds )
-{
-    CanvasConstants c = m_pCanvas->constants();
+        // Draw the current altitude
+        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
+        draw.drawCurrAlt( &num );
 
-    m_iTimerMin = iMinutes;
-    m_iTimerSec = iSeconds;
+        stageDone( AltitudeRegion );
+    }
 
-    if( (iMinutes == 0) && (iSeconds == 0) )
+    if( dirty.intersects( m_regions[SpeedRegion] ) )
     {
-        TimerDialog  dlg( this );
+        stageStart();
 
-        dlg.setGeometry( c.dW2 - c.dW5, c.dH - c.dW2 - 20 - c.dH5, c.dW5 + c.dW5, c.dH5 + c.dH5 );
+        // Draw the Speed tape
+        drawLayer( &ahrs, SpeedTapeBackLayer );
+        ahrs.drawPixmap( 5, c.dH2 + 5.0 - m_SpeedTape.height() + (g_situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
 
-        int          iSel = dlg.exec();
-        AHRSMainWin *pMainWin = static_cast<AHRSMainWin *>( parentWidget()->parentWidget() );
+        // Draw the current speed
+        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
+        draw.drawCurrSpeed( &num );
 
-        if( iSel == QDialog::Rejected )
-        {
-            m_iTimerMin = m_iTimerSec = -1;
-            return;
-        }
-        else if( iSel == TimerDialog::Restart )
-            pMainWin->restartTimer();
-        else if( iSel == TimerDialog::Change )
-            pMainWin->changeTimer();
+        ahrs.setFont( wee );
+        ahrs.setPen( Qt::black );
+        QString qsUnits( speedUnits() );
+        ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0) + 1, c.dH2 + c.dH80 + 1, qsUnits );
+        ahrs.setPen( Qt::white );
+        ahrs.drawText( c.dW10 + c.dW40 + (c.dW80 / 2.0), c.dH2 + c.dH80, qsUnits );
+
+        stageDone( SpeedRegion );
     }
-}
 
+    if( dirty.intersects( m_regions[MapRegion] ) )
+    {
+        stageStart();
+
+        // Arrow for heading position above heading dial
+        ahrs.setBrush( Qt::white );
+        ahrs.setPen( Qt::black );
+        ahrs.drawPolygon( layout.headArrow );
+
+        // Draw the heading value over the indicator
+        ahrs.setPen( QPen( Qt::white, c.iThinPen ) );
+        ahrs.setBrush( Qt::black );
+        ahrs.drawRect( c.dW + c.dW2 - (c.dWNum * 3.0 / 2.0) - (c.dW * 0.0125), 10.0, (c.dWNum * 3.0) + (c.dW * 0.025), c.dHNum + (c.dH * 0.015) );
+        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSGyroHeading ), 3 );
+        ahrs.drawPixmap( c.dW + c.dW2 - (c.dWNum * 3.0 / 2.0), 10.0 + (c.dH * 0.0075), num );
+
+        stageDone( MapRegion );
+    }
+
+    if( dirty.intersects( m_regions[InfoRegion] ) )
+    {
+        stageStart();
+
+        // Draw the G-Force indicator box and scale
+        drawLayer( &ahrs, GForceScaleLayer );
+
+        // Arrow for G-Force indicator
+        ahrs.setPen( Qt::black );
+        ahrs.setBrush( Qt::white );
+        ahrs.translate( (fabs( 1.0 - g_situation.dAHRSGLoad ) * (c.dW5 + c.dW10) * 20.0) + c.dW2 - c.dW20 - c.dW10, -c.dH80 );
+        ahrs.drawPolygon( layout.gForceArrow );
+        ahrs.resetTransform();
+
+        // Left Tank indicators background
+        ahrs.drawPixmap( c.dW10 + c.dW20, c.dH2 + c.dH10, c.dW20, c.dH2 - c.dH5, m_Lfuel );
+        // Tank indicators level
+        QPen levelPen( Qt::black, c.dH40 + 4 );
+        levelPen.setCapStyle( Qt::RoundCap );
+        ahrs.setPen( levelPen );
+        ahrs.drawLine( c.dW10 + c.dW20,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
+                       c.dW40 + c.dW10 + c.dW20,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
+        levelPen.setWidth( c.dH40 );
+        levelPen.setColor( QColor( 255, 150, 255 ) );
+        ahrs.setPen( levelPen );
+        ahrs.drawLine( c.dW10 + c.dW20,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
+                       c.dW40 + c.dW10 + c.dW20,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
+        // Right Tank indicators background
+        ahrs.drawPixmap( c.dW - c.dW5 - c.dW10 - 1, c.dH2 + c.dH10, c.dW20, c.dH2 - c.dH5, m_Rfuel );
+        // Right Tank indicators level
+        levelPen.setColor( Qt::black );
+        levelPen.setWidth( c.dH40 + 4 );
+        ahrs.setPen( levelPen );
+        ahrs.drawLine( c.dW - c.dW5 - c.dW20,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
+                       c.dW - c.dW40 - c.dW5 - c.dW20 - 1,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
+        levelPen.setWidth( c.dH40 );
+        levelPen.setColor( QColor( 255, 150, 255 ) );
+        ahrs.setPen( levelPen );
+        ahrs.drawLine( c.dW - c.dW5 - c.dW20,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
+                       c.dW - c.dW40 - c.dW5 - c.dW20 - 1,
+                       c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
+
+        // Tank indicator active indicators
+        ahrs.setFont( large );
+        if( m_bFuelFlowStarted )
+        {
+            QPen fuelPen( Qt::yellow, c.dH80 );
+
+            ahrs.setPen( fuelPen );
+
+            if( !m_tanks.bDualTanks )
+            {
+                ahrs.drawLine( c.dW10, c.dH2 + c.dH10 - c.dH80 - 5, c.dW10, c.dH2 + c.dH10 - c.dH80 - 5 );
+                ahrs.drawLine( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH10 - c.dH80 - 5, c.dW - c.dW5, c.dH2 + c.dH10 - c.dH80 - 5 );
+            }
+            else
+            {
+                if( m_tanks.bOnLeftTank )
+                    ahrs.drawLine( c.dW10, c.dH2 + c.dH10 - 15, c.dW5, c.dH2 + c.dH10 - 15 );
+                else
+                    ahrs.drawLine( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH10 - 15, c.dW - c.dW5, c.dH2 + c.dH10 - 15 );
+            }
+        }
+
+        stageDone( InfoRegion );
+    }
+
+    if( dirty.intersects( m_regions[MapRegion] ) )
+    {
+        stageStart();
+
+        // Airspaces, airports and traffic
+        finishMapLayers( &ahrs );
+        draw.drawZoom();
+
+        ahrs.drawPixmap( c.dW + c.dW40, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_DirectTo );
+        ahrs.drawPixmap( c.dW + c.dW40 + c.dH20, c.dH - c.dH20 - c.dH40, c.dH20, c.dH20, m_FromTo );
+
+        // Draw the heading overlay so the markers aren't covered by other elements
+        ahrs.translate( layout.headCenter );
+        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.translate( -layout.headCenter );
+        drawLayer( &ahrs, HeadingOverlayLayer );
+        ahrs.resetTransform();
+
+        // Draw the heading bug
+        if( m_iHeadBugAngle >= 0 )
+        {
+            ahrs.translate( layout.headCenter );
+            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.translate( -layout.headCenter );
+            ahrs.drawPixmap( c.dW + c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam, m_headIcon );
+
+            // If long press triggered crosswind component display and the wind bug is set
+            if( m_bShowCrosswind && (m_iWindBugAngle >= 0) )
+            {
+                linePen.setWidth( c.iThinPen );
+                linePen.setColor( QColor( 0xFF, 0x90, 0x01 ) );
+                ahrs.setPen( linePen );
+                ahrs.drawLine( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam, c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam );
+            }
+
+            ahrs.resetTransform();
+        }
+
+        // Draw the wind bug
+        if( m_iWindBugAngle >= 0 )
+        {
+            ahrs.translate( layout.headCenter );
+            ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.translate( -layout.headCenter );
+            ahrs.drawPixmap( c.dW + c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam, m_windIcon );
+
+            QString      qsWind = QString::number( m_iWindBugSpeed );
+            QFontMetrics windMetrics( tiny );
+            QRect        windRect = windMetrics.boundingRect( qsWind );
+
+            ahrs.setFont( tiny );
+            ahrs.setPen( Qt::black );
+            ahrs.drawText( c.dW + c.dW2 - (windRect.width() / 2), c.dH - 10.0 - c.dHeadDiam, qsWind );
+            ahrs.setPen( Qt::white );
+            ahrs.drawText( c.dW + c.dW2 - (windRect.width() / 2) - 1, c.dH - 10.0 - c.dHeadDiam, qsWind );
+
+            // If long press triggered crosswind component display and the heading bug is set
+            if( m_bShowCrosswind && (m_iHeadBugAngle >= 0) )
+            {
+                linePen.setWidth( c.iThinPen );
+                linePen.setColor( Qt::cyan );
+                ahrs.setPen( linePen );
+                ahrs.drawLine( c.dW + c.dW2, c.dH - 10 - c.dHeadDiam, c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam );
+
+                // Draw the crosswind component calculated from heading vs wind
+                double dAng = fabs( static_cast<double>( m_iWindBugAngle ) - static_cast<double>( m_iHeadBugAngle ) );
+                while( dAng > 180.0 )
+                    dAng -= 360.0;
+                dAng = fabs( dAng );
+                double dCrossComp = fabs( static_cast<double>( m_iWindBugSpeed ) * sin( dAng * ToRad ) );
+                double dCrossPos = c.dH - (c.dW / 1.3) - 10.0;
+                QString qsCrossAng = QString( "%1%2" ).arg( static_cast<int>( dAng ) ).arg( QChar( 176 ) );
+
+                ahrs.resetTransform();
+                ahrs.translate( layout.headCenter );
+                ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+                ahrs.translate( -layout.headCenter );
+                ahrs.setFont( large );
+                ahrs.setPen( Qt::black );
+                ahrs.drawText( c.dW + c.dW2 + 5.0, dCrossPos, QString::number( static_cast<int>( dCrossComp ) ) );
+                ahrs.setPen( QColor( 0xFF, 0x90, 0x01 ) );
+                ahrs.drawText( c.dW + c.dW2 + 3.0, dCrossPos - 2.0, QString::number( static_cast<int>( dCrossComp ) ) );
+                ahrs.setFont( med );
+                ahrs.setPen( Qt::black );
+                ahrs.drawText( c.dW + c.dW2 + 5.0, dCrossPos + c.iMedFontHeight - 5, qsCrossAng );
+                ahrs.setPen( Qt::cyan );
+                ahrs.drawText( c.dW + c.dW2 + 3.0, dCrossPos + c.iMedFontHeight - 7, qsCrossAng );
+            }
+
+            ahrs.resetTransform();
+        }
+
+        stageDone( MapRegion );
+    }
+
+    if( m_settings.bShowAirspaces )
+        draw.paintAirspaceAlert();
+
+    if( (m_iTimerMin >= 0) && (m_iTimerSec >= 0) )
+        draw.paintTimer( m_iTimerMin, m_iTimerSec );
+
+    if( m_bShowGPSDetails )
+        draw.paintInfo();
+    else if( m_bDisplayTanksSwitchNotice )
+        draw.paintSwitchNotice( &m_tanks );
+}
+
+
+// The static parts of the instruments only change with the screen geometry so they're rendered once here and each frame just
+// composites them, rotated or shifted as needed. Each layer is drawn with the same coordinates the paint functions use.
+void AHRSCanvas::buildLayers( CanvasConstants &c )
+{
+    QPainter            layer;
+    const CanvasLayout &layout = m_pCanvas->layout();
+    QPen                linePen( Qt::black, c.iThinPen );
+    QPolygonF           arrow;
+    QPolygon            shape;
+    QRectF              marks;
+    double              dLadderScale = m_bPortrait ? c.dH4 : c.dH2;
+    double              dLadderH = (20.0 / 45.0 * dLadderScale) + c.iThinPen;
+    double              dTapeH = m_bPortrait ? c.dH2 : c.dH;
+    double              dIndicatorSize = c.dW - c.dW5;
+
+    // Pitch ladder drawn around the zero pitch line
+    startLayer( &layer, PitchLadderLayer, QRectF( c.dW2 - c.dW5 - c.iThinPen, -dLadderH, (c.dW5 + c.iThinPen) * 2.0, dLadderH * 2.0 ) );
+    layer.setRenderHint( QPainter::Antialiasing, true );
+    for( double i = 0.0; i < 20.0; i += 10.0 )
+    {
+        linePen.setColor( Qt::cyan );
+        layer.setPen( linePen );
+        layer.drawLine( QPointF( c.dW2 - c.dW20, -((i + 2.5) / 45.0 * dLadderScale) ), QPointF( c.dW2 + c.dW20, -((i + 2.5) / 45.0 * dLadderScale) ) );
+        layer.drawLine( QPointF( c.dW2 - c.dW20, -((i + 5.0) / 45.0 * dLadderScale) ), QPointF( c.dW2 + c.dW20, -((i + 5.0) / 45.0 * dLadderScale) ) );
+        layer.drawLine( QPointF( c.dW2 - c.dW20, -((i + 7.5) / 45.0 * dLadderScale) ), QPointF( c.dW2 + c.dW20, -((i + 7.5) / 45.0 * dLadderScale) ) );
+        layer.drawLine( QPointF( c.dW2 - c.dW5, -((i + 10.0) / 45.0 * dLadderScale) ), QPointF( c.dW2 + c.dW5, -((i + 10.0) / 45.0 * dLadderScale) ) );
+        linePen.setColor( QColor( 67, 33, 9 ) );
+        layer.setPen( linePen );
+        layer.drawLine( QPointF( c.dW2 - c.dW20, (i + 2.5) / 45.0 * dLadderScale ), QPointF( c.dW2 + c.dW20, (i + 2.5) / 45.0 * dLadderScale ) );
+        layer.drawLine( QPointF( c.dW2 - c.dW20, (i + 5.0) / 45.0 * dLadderScale ), QPointF( c.dW2 + c.dW20, (i + 5.0) / 45.0 * dLadderScale ) );
+        layer.drawLine( QPointF( c.dW2 - c.dW20, (i + 7.5) / 45.0 * dLadderScale ), QPointF( c.dW2 + c.dW20, (i + 7.5) / 45.0 * dLadderScale ) );
+        layer.drawLine( QPointF( c.dW2 - c.dW5, (i + 10.0) / 45.0 * dLadderScale ), QPointF( c.dW2 + c.dW5, (i + 10.0) / 45.0 * dLadderScale ) );
+    }
+    layer.end();
+
+    // Roll pointer and the yellow pitch indicators
+    if( m_bPortrait )
+    {
+        arrow.append( QPointF( c.dW2, c.dH40 + (c.dH * 0.0625) ) );
+        arrow.append( QPointF( c.dW2 + (c.dWa * 0.03125), c.dH40 + (c.dH * 0.08125) ) );
+        arrow.append( QPointF( c.dW2 - (c.dWa * 0.03125), c.dH40 + (c.dH * 0.08125) ) );
+        marks = QRectF( c.dW5, c.dH4 - c.dH160 - 2.0, c.dW - c.dW5 - c.dW5, (c.dH160 * 2.0) + 24.0 ).united( arrow.boundingRect() );
+    }
+    else
+    {
+        arrow.append( QPointF( c.dW2, c.dH10 ) );
+        arrow.append( QPointF( c.dW2 + c.dW40, c.dH10 + c.dH40 ) );
+        arrow.append( QPointF( c.dW2 - c.dW40, c.dH10 + c.dH40 ) );
+        marks = QRectF( c.dW5, c.dH2 - c.dH160 - 6.0, c.dW - c.dW5 - c.dW5, (c.dH160 * 2.0) + 28.0 ).united( arrow.boundingRect() );
+    }
+    startLayer( &layer, AttitudeMarksLayer, marks.adjusted( -2.0, -2.0, 2.0, 2.0 ) );
+    layer.setRenderHint( QPainter::Antialiasing, true );
+    layer.setBrush( Qt::white );
+    layer.setPen( Qt::black );
+    layer.drawPolygon( arrow );
+    layer.setBrush( Qt::yellow );
+    if( m_bPortrait )
+    {
+        shape.append( QPoint( c.dW5 + c.dW20, c.dH4 - c.dH160 ) );
+        shape.append( QPoint( c.dW2 - c.dW10, c.dH4 - c.dH160 ) );
+        shape.append( QPoint( c.dW2 - c.dW10 + 20, c.dH4 ) );
+        shape.append( QPoint( c.dW2 - c.dW10, c.dH4 + c.dH160 ) );
+        shape.append( QPoint( c.dW5 + c.dW20, c.dH4 + c.dH160 ) );
+        layer.drawPolygon( shape );
+        shape.clear();
+        shape.append( QPoint( c.dW - c.dW5 - c.dW20, c.dH4 - c.dH160 ) );
+        shape.append( QPoint( c.dW2 + c.dW10, c.dH4 - c.dH160 ) );
+        shape.append( QPoint( c.dW2 + c.dW10 - 20, c.dH4 ) );
+        shape.append( QPoint( c.dW2 + c.dW10, c.dH4 + c.dH160 ) );
+        shape.append( QPoint( c.dW - c.dW5 - c.dW20, c.dH4 + c.dH160 ) );
+        layer.drawPolygon( shape );
+        shape.clear();
+        shape.append( QPoint( c.dW2, c.dH4 ) );
+        shape.append( QPoint( c.dW2 - c.dW20, c.dH4 + 20 ) );
+        shape.append( QPoint( c.dW2 + c.dW20, c.dH4 + 20 ) );
+        layer.drawPolygon( shape );
+    }
+    else
+    {
+        shape.append( QPoint( c.dW5 + c.dW10, c.dH2 - c.dH160 - 4.0 ) );
+        shape.append( QPoint( c.dW2 - c.dW10, c.dH2 - c.dH160 - 4.0 ) );
+        shape.append( QPoint( c.dW2 - c.dW10 + 20, c.dH2 ) );
+        shape.append( QPoint( c.dW2 - c.dW10, c.dH2 + c.dH160 + 4.0 ) );
+        shape.append( QPoint( c.dW5 + c.dW10, c.dH2 + c.dH160 + 4.0 ) );
+        layer.drawPolygon( shape );
+        shape.clear();
+        shape.append( QPoint( c.dW - c.dW5 - c.dW10, c.dH2 - c.dH160 - 4.0 ) );
+        shape.append( QPoint( c.dW2 + c.dW10, c.dH2 - c.dH160 - 4.0 ) );
+        shape.append( QPoint( c.dW2 + c.dW10 - 20, c.dH2 ) );
+        shape.append( QPoint( c.dW2 + c.dW10, c.dH2 + c.dH160 + 4.0 ) );
+        shape.append( QPoint( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH160 + 4.0 ) );
+        layer.drawPolygon( shape );
+        shape.clear();
+        shape.append( QPoint( c.dW2, c.dH2 ) );
+        shape.append( QPoint( c.dW2 - c.dW20, c.dH2 + 20 ) );
+        shape.append( QPoint( c.dW2 + c.dW20, c.dH2 + 20 ) );
+        layer.drawPolygon( shape );
+    }
+    layer.end();
+
+    // Roll scale and heading dial pre-scaled so drawing them is just a rotated blit
+    startLayer( &layer, RollScaleLayer, QRectF( c.dW10, c.dH20, dIndicatorSize, dIndicatorSize ) );
+    layer.setRenderHint( QPainter::SmoothPixmapTransform, true );
+    layer.drawPixmap( QRectF( c.dW10, c.dH20, dIndicatorSize, dIndicatorSize ), m_RollIndicator, m_RollIndicator.rect() );
+    layer.end();
+
+    startLayer( &layer, HeadingDialLayer, layout.headRect );
+    layer.setRenderHint( QPainter::SmoothPixmapTransform, true );
+    layer.drawPixmap( layout.headRect, m_HeadIndicator, m_HeadIndicator.rect() );
+    layer.end();
+
+    startLayer( &layer, HeadingOverlayLayer, layout.headRect );
+    layer.setRenderHint( QPainter::SmoothPixmapTransform, true );
+    layer.drawPixmap( layout.headRect, m_HeadIndicatorOverlay, m_HeadIndicatorOverlay.rect() );
+    layer.end();
+
+    // In portrait the tapes run down beside the heading dial so their backgrounds are cut around it
+    if( m_bPortrait )
+        startLayer( &layer, AltTapeBackLayer, QRectF( c.dW - c.dW5, 0.0, c.dW5, c.dH2 + c.dH4 ) );
+    else
+        startLayer( &layer, AltTapeBackLayer, QRectF( c.dW - c.dW5 - c.dW40, 0.0, c.dW5 + c.dW40, c.dH ) );
+    if( m_bPortrait )
+        layer.setClipPath( layout.headMask );
+    layer.fillRect( QRectF( 0.0, 0.0, c.dW + c.dW, c.dH ), QColor( 0, 0, 0, 100 ) );
+    layer.end();
+
+    startLayer( &layer, SpeedTapeBackLayer, QRectF( 0.0, 0.0, c.dW10 + 5.0, dTapeH ) );
+    if( m_bPortrait )
+        layer.setClipPath( layout.headMask );
+    layer.fillRect( QRectF( 0.0, 0.0, c.dW + c.dW, c.dH ), QColor( 0, 0, 0, 100 ) );
+    layer.end();
+
+    startLayer( &layer, VertSpeedScaleLayer, QRectF( c.dW - c.dW20 - c.dW40, 0.0, c.dW20 + c.dW40, dTapeH ) );
+    layer.fillRect( QRectF( c.dW - c.dW20 - c.dW40, 0.0, c.dW40, dTapeH ), QColor( 0, 0, 0, 100 ) );
+    layer.setRenderHint( QPainter::SmoothPixmapTransform, true );
+    layer.drawPixmap( QRectF( c.dW - c.dW20, 0.0, c.dW20, dTapeH ), m_VertSpeedTape, m_VertSpeedTape.rect() );
+    layer.end();
+
+    // G-Force scale numbers
+    if( m_bPortrait )
+        startLayer( &layer, GForceScaleLayer, QRectF( c.dW - c.dW5 - 2.0, c.dH - 18.0 - c.iTinyFontHeight, c.dW5 + 2.0, c.iTinyFontHeight + 18.0 ) );
+    else
+        startLayer( &layer, GForceScaleLayer, QRectF( c.dW2 - c.dW20 - c.dW10 - c.iTinyFontWidth, c.dH - 18.0 - c.iTinyFontHeight, c.dW5 + (c.iTinyFontWidth * 3.0), c.iTinyFontHeight + 18.0 ) );
+    layer.setRenderHint( QPainter::TextAntialiasing, true );
+    layer.setFont( tiny );
+    layer.setPen( Qt::black );
+    if( m_bPortrait )
+    {
+        layer.drawText( c.dW - c.dW5, c.dH - 15, "0" );
+        layer.drawText( c.dW - c.dW5 + c.dW10 - (c.iTinyFontWidth / 2), c.dH - 15, "1" );
+        layer.drawText( c.dW - c.iTinyFontWidth - 10, c.dH - 15, "2" );
+        layer.setPen( Qt::white );
+        layer.drawText( c.dW - c.dW5 + 1, c.dH - 16, "0" );
+        layer.drawText( c.dW - c.dW5 + c.dW10 - (c.iTinyFontWidth / 2), c.dH - 16, "1" );
+        layer.drawText( c.dW - c.iTinyFontWidth - 11, c.dH - 16, "2" );
+    }
+    else
+    {
+        layer.drawText( c.dW2 - c.dW20 - c.dW10 - (c.iTinyFontWidth / 2) + 1, c.dH - 15, "0" );
+        layer.drawText( c.dW2 - c.dW20 - (c.iTinyFontWidth / 2) + 1, c.dH - 15, "1" );
+        layer.drawText( c.dW2 - c.dW20 + c.dW10 - (c.iTinyFontWidth / 2) + 1, c.dH - 15, "2" );
+        layer.setPen( Qt::white );
+        layer.drawText( c.dW2 - c.dW20 - c.dW10 - (c.iTinyFontWidth / 2), c.dH - 16, "0" );
+        layer.drawText( c.dW2 - c.dW20 - (c.iTinyFontWidth / 2), c.dH - 16, "1" );
+        layer.drawText( c.dW2 - c.dW20 + c.dW10 - (c.iTinyFontWidth / 2), c.dH - 16, "2" );
+    }
+    layer.end();
+
+    buildRegions( c );
+
+    m_dLayerW = c.dW;
+    m_dLayerH = c.dH;
+    m_bLayerPortrait = m_bPortrait;
+    m_bLayersValid = true;
+}
+
+
+// Screen areas of each instrument. Every element the paint functions draw in an instrument's block lies inside its region,
+// so a paint event can skip any block that doesn't overlap what's dirty and the widget clip takes care of the rest.
+void AHRSCanvas::buildRegions( CanvasConstants &c )
+{
+    double dDialX = m_pCanvas->layout().headCenter.x();
+    double dDialY = m_pCanvas->layout().headCenter.y();
+    double dRollR = (c.dW - c.dW5) / 2.0 * 1.415;   // Corners of the roll scale square as it turns
+    double dRollX = m_bPortrait ? c.dW2 : (c.dW2 - c.dW20);
+    double dRollY = c.dH20 + ((c.dW - c.dW5) / 2.0);
+    double dTapeH = m_bPortrait ? (c.dH2 + c.dH4) : c.dH;
+    double dVSpeedX = qMin( c.dW - c.dW20 - c.dW40, c.dW - m_pCanvas->scaledH( 30.0 ) );
+    double dBugR = c.dHeadDiam2 + qMax( static_cast<double>( m_headIcon.height() ), c.dH20 );
+    QRectF roll( dRollX - dRollR, dRollY - dRollR, dRollR * 2.0, dRollR * 2.0 );
+    QRectF heading;
+
+    // The heading readout sits above the dial in portrait; in landscape it's at the top of the right half and the
+    // direct-to/from-to buttons are drawn with the map
+    if( m_bPortrait )
+        heading = QRectF( c.dW2 - (c.dWNum * 2.0), c.dH - c.dHeadDiam - 10.0 - c.dH80 - c.dH40 - c.dHNum - c.dH20, c.dWNum * 4.0, c.dHNum + c.dH20 + c.dH80 );
+    else
+        heading = QRectF( c.dW + c.dW2 - (c.dWNum * 2.0), 0.0, c.dWNum * 4.0, c.dHNum + c.dH20 + 10.0 );
+
+    m_regions[MapRegion] = QRegion( QRectF( dDialX - dBugR, dDialY - dBugR, dBugR * 2.0, dBugR * 2.0 ).toAlignedRect(), QRegion::Ellipse ).united( heading.toAlignedRect() );
+    if( !m_bPortrait )
+        m_regions[MapRegion] = m_regions[MapRegion].united( QRectF( c.dW + c.dW40, c.dH - c.dH20 - c.dH40, c.dH10, c.dH20 ).toAlignedRect() );
+
+    // The attitude stops where the map starts so neither one drags the other into its repaint. Whatever of the attitude
+    // shows around the dial inside the map region is put back whenever the map is painted.
+    m_regions[AttitudeRegion] = QRegion( m_pCanvas->layout().attitudeClip.toAlignedRect() ).united( roll.toAlignedRect() );
+    m_attitudeUnderMap = m_regions[AttitudeRegion].intersected( m_regions[MapRegion] );
+    m_regions[AttitudeRegion] = m_regions[AttitudeRegion].subtracted( m_regions[MapRegion] );
+    m_regions[SpeedRegion] = QRegion( QRectF( 0.0, 0.0, c.dW5 + c.dW80 + c.iThinPen + 2.0, dTapeH ).toAlignedRect() );
+    m_regions[AltitudeRegion] = QRegion( QRectF( c.dW - c.dW5 - c.dW20 - c.dW40 - c.iThinPen, 0.0, c.dW5 + c.dW20 + c.dW40 + c.iThinPen, dTapeH ).toAlignedRect() );
+    m_regions[VertSpeedRegion] = QRegion( QRectF( dVSpeedX, 0.0, c.dW - dVSpeedX, m_bPortrait ? (c.dH2 + c.dH20) : c.dH ).toAlignedRect() );
+    if( m_bPortrait )
+        m_regions[InfoRegion] = QRegion( QRectF( 0.0, c.dH2 + c.dH40 - c.dH80 - 20.0, c.dW, c.dH2 - c.dH40 + c.dH80 + 20.0 ).toAlignedRect() );
+    else
+        m_regions[InfoRegion] = QRegion( QRectF( 0.0, c.dH2 + c.dH10 - c.dH80 - 20.0, c.dW, c.dH2 - c.dH10 + c.dH80 + 20.0 ).toAlignedRect() );
+}
 
+
+// Queue a repaint of just one instrument for when the governor says the next frame is due; before the regions exist
+// everything gets painted
+void AHRSCanvas::markDirty( InstrumentRegion eRegion, bool bUrgent )
+{
+    if( !m_bLayersValid )
+    {
+        update();
+        return;
+    }
+
+    m_pendingRegion += m_regions[eRegion];
+    m_governor.request( bUrgent );
+}
+
+
+void AHRSCanvas::flushDirty()
+{
+    if( m_pendingRegion.isEmpty() )
+        return;
+
+    if( m_governor.statsShown() )
+        m_pendingRegion += governorRect();
+    if( m_bShowProfile )
+        m_pendingRegion += profileRect();
+    update( m_pendingRegion );
+    m_pendingRegion = QRegion();
+}
+
+
+// Strip across the top for the governor debug overlay
+QRect AHRSCanvas::governorRect()
+{
+    return QRect( 0, 0, width(), m_pCanvas->constants().iSmallFontHeight + 8 );
+}
+
+
+// Frame rate, frame time and CPU state; toggled by swiping right
+void AHRSCanvas::paintGovernorStats()
+{
+    QPainter stats( this );
+    QString  qsCpu = (m_governor.cpuPercent() < 0) ? QString( "--" ) : QString( "%1%" ).arg( m_governor.cpuPercent() );
+    QString  qsTemp = (m_governor.cpuTemp() < 0.0) ? QString( "--" ) : QString( "%1C" ).arg( m_governor.cpuTemp(), 0, 'f', 1 );
+    QString  qsMHz = (m_governor.cpuMHz() < 0) ? QString( "--" ) : QString( "%1MHz" ).arg( m_governor.cpuMHz() );
+
+    stats.fillRect( governorRect(), QColor( 0, 0, 0, 160 ) );
+    stats.setFont( small );
+    stats.setPen( m_governor.throttled() ? Qt::red : Qt::white );
+    stats.drawText( governorRect(), Qt::AlignCenter, QString( "%1 fps  %2 ms  every %3 ms  CPU %4  %5  %6%7" )
+                                                         .arg( m_governor.fps(), 0, 'f', 1 )
+                                                         .arg( m_governor.frameMs(), 0, 'f', 1 )
+                                                         .arg( m_governor.interval() )
+                                                         .arg( qsCpu )
+                                                         .arg( qsTemp )
+                                                         .arg( qsMHz )
+                                                         .arg( m_governor.throttled() ? "  THROTTLED" : "" ) );
+}
+
+
+void AHRSCanvas::governorStatsChanged()
+{
+    update( governorRect() );
+    if( m_bShowProfile )
+        update( profileRect() );
+}
+
+
+// Panel under the governor strip with a line per profiler stage
+QRect AHRSCanvas::profileRect()
+{
+    return QRect( 0, governorRect().bottom() + 1, width() / 2, (Profiler::StageCount * (m_pCanvas->constants().iTinyFontHeight + 2)) + 8 );
+}
+
+
+void AHRSCanvas::paintProfile()
+{
+    QPainter    profile( this );
+    QRect       lineRect = profileRect().adjusted( 8, 4, -4, -4 );
+    QStringList lines = Profiler::summary();
+    QString     qsLine;
+
+    profile.fillRect( profileRect(), QColor( 0, 0, 0, 160 ) );
+    profile.setFont( tiny );
+    profile.setPen( Qt::white );
+    lineRect.setHeight( m_pCanvas->constants().iTinyFontHeight + 2 );
+    foreach( qsLine, lines )
+    {
+        profile.drawText( lineRect, Qt::AlignLeft | Qt::AlignVCenter, qsLine );
+        lineRect.translate( 0, lineRect.height() );
+    }
+}
+
+
+// What's in the rings goes to a timestamped CSV next to the data files
+void AHRSCanvas::dumpProfile()
+{
+    QString qsFile;
+
+    Builder::getStorage( &qsFile );
+    qsFile.append( QString( "/data/space.skyfun.stratofier/profile-%1.csv" ).arg( QDateTime::currentDateTime().toString( "yyyyMMdd-hhmmss" ) ) );
+    if( Profiler::dump( qsFile ) )
+        qDebug() << "Profile saved to" << qsFile;
+}
+
+
+// Each map layer gets its own image and worker. Everything they draw from, traffic and ownship included, is copied into
+// the job here so they never touch the globals and nothing has to be locked. If the platform can't render text off the
+// GUI thread they're drawn inline into the same images instead.
+// With MapRasterCache set the airspaces and airports are drawn north-up and only redrawn when what's in them changes;
+// the rest of the time the last raster is just turned to the heading. Traffic moves every update so it's always drawn.
+void AHRSCanvas::startMapLayers( CanvasConstants &c )
+{
+    QPointF center( m_pCanvas->layout().headCenter );
+    QRect   rect( m_pCanvas->layout().mapRect );
+    bool    bThreaded = QFontDatabase::supportsThreadedFontRendering();
+    int     iLayer;
+
+    for( iLayer = 0; iLayer < AHRSDraw::MapLayerCount; iLayer++ )
+    {
+        MapLayerJob *pJob = &m_mapJobs[iLayer];
+        bool         bNorthUp = m_settings.bMapRasterCache && (iLayer != AHRSDraw::TrafficMapLayer);
+
+        m_mapFutures[iLayer].waitForFinished();
+
+        if( bNorthUp && mapRasterValid( pJob, rect, center ) )
+            continue;
+
+        // Only rebuilt here once the traffic worker is done with the old one
+        if( (iLayer == AHRSDraw::TrafficMapLayer) && (m_trafficAtlas.isNull() || (m_dTrafficSprite != c.dW20)) )
+            buildTrafficAtlas( c );
+
+        pJob->iLayer = iLayer;
+        pJob->bNorthUp = bNorthUp;
+        pJob->bValid = bNorthUp;
+        pJob->rect = rect;
+        pJob->center = center;
+        pJob->dHeading = bNorthUp ? 0.0 : g_situation.dAHRSGyroHeading;
+        pJob->c = c;
+        pJob->pCanvas = m_pCanvas;
+        pJob->directAP = m_directAP;
+        pJob->fromAP = m_fromAP;
+        pJob->toAP = m_toAP;
+        pJob->dZoomNM = m_dZoomNM;
+        pJob->settings = m_settings;
+        pJob->iMagDev = m_iMagDev;
+        pJob->pTrafficAtlas = &m_trafficAtlas;
+
+        if( iLayer == AHRSDraw::AirspaceMapLayer )
+        {
+            pJob->bActive = m_settings.bShowAirspaces && (!m_airspaces.isEmpty());
+            pJob->airspaces = m_airspaces;
+            pJob->alerted = m_airspaceAlert.alertedNames();
+        }
+        else if( iLayer == AHRSDraw::AirportMapLayer )
+        {
+            pJob->bActive = (m_settings.eShowAirports != Canvas::ShowNoAirports) && (!m_airports.isEmpty());
+            pJob->airports = m_airports;
+        }
+        else
+        {
+            pJob->bActive = !g_trafficList.isEmpty();
+            pJob->traffic = g_trafficList;
+            pJob->ownship = g_situation;
+        }
+
+        if( !pJob->bActive )
+            continue;
+
+        if( bThreaded )
+            m_mapFutures[iLayer] = QtConcurrent::run( AHRSDraw::renderMapLayer, pJob );
+        else
+            AHRSDraw::renderMapLayer( pJob );
+    }
+}
+
+
+// Whether the north-up raster from an earlier frame still shows what this one would draw. Ownship moving shows up
+// here too since the nearby lists are rebuilt (and so no longer shared with the job's copy) when it does.
+bool AHRSCanvas::mapRasterValid( MapLayerJob *pJob, const QRect &rect, const QPointF &center )
+{
+    if( (!pJob->bValid) || (pJob->rect != rect) || (pJob->center != center) || (pJob->dZoomNM != m_dZoomNM) )
+        return false;
+
+    if( pJob->iLayer == AHRSDraw::AirspaceMapLayer )
+    {
+        return (pJob->settings.bShowAirspaces == m_settings.bShowAirspaces) &&
+               (pJob->settings.bShowAltitudes == m_settings.bShowAltitudes) &&
+               pJob->airspaces.isSharedWith( m_airspaces );
+    }
+
+    return (pJob->settings.eShowAirports == m_settings.eShowAirports) &&
+           (pJob->settings.bShowPrivate == m_settings.bShowPrivate) &&
+           (pJob->settings.bShowRunways == m_settings.bShowRunways) &&
+           pJob->airports.isSharedWith( m_airports );
+}
+
+
+// Composite bottom to top; the north-up rasters are turned to the heading and clipped to the heading indicator
+void AHRSCanvas::finishMapLayers( QPainter *pAhrs )
+{
+    int iLayer;
+
+    for( iLayer = 0; iLayer < AHRSDraw::MapLayerCount; iLayer++ )
+    {
+        MapLayerJob *pJob = &m_mapJobs[iLayer];
+
+        m_mapFutures[iLayer].waitForFinished();
+        if( !pJob->bActive )
+            continue;
+
+        if( pJob->bNorthUp )
+        {
+            pAhrs->save();
+            pAhrs->setClipPath( m_pCanvas->layout().headClip );
+            pAhrs->setRenderHint( QPainter::SmoothPixmapTransform, true );
+            pAhrs->translate( pJob->center );
+            pAhrs->rotate( -g_situation.dAHRSGyroHeading );
+            pAhrs->translate( -pJob->center );
+            pAhrs->drawImage( pJob->rect.topLeft(), pJob->image );
+            pAhrs->restore();
+        }
+        else
+            pAhrs->drawImage( pJob->rect.topLeft(), pJob->image );
+    }
+}
+
+
+// Every threat colour pre-rotated in 5 degree steps along with its stick so each target is drawn with one plain blit.
+// A cell is twice the chevron size so the stick fits whichever way it points.
+// It goes in the asset cache like the scaled artwork.
+void AHRSCanvas::buildTrafficAtlas( CanvasConstants &c )
+{
+    QImage *icons[AHRSDraw::TrafficSpriteCount] = { &m_trafficRed, &m_trafficOrange, &m_trafficYellow, &m_trafficGreen, &m_trafficCyan };
+    QColor  sticks[AHRSDraw::TrafficSpriteCount] = { Qt::red, QColor( 0xFF, 0xA5, 0x00 ), Qt::yellow, Qt::green, Qt::cyan };
+    int     iCell = static_cast<int>( ceil( c.dW20 * 2.0 ) ) + 4;
+    QRectF  iconRect( -c.dW20 / 2.0, -c.dW20 / 2.0, c.dW20, c.dW20 );
+    QPen    stickPen( Qt::green, 2 );
+    int     iSprite, iStep;
+    QString qsKey = QString( "traffic-%1-%2-%3" ).arg( AssetCache::resourceHash( QStringList() << ":/graphics/resources/TrafficRed.png"
+                                                                                               << ":/graphics/resources/TrafficOrange.png"
+                                                                                               << ":/graphics/resources/TrafficYellow.png"
+                                                                                               << ":/graphics/resources/TrafficGreen.png"
+                                                                                               << ":/graphics/resources/TrafficCyan.png" ) )
+                                                 .arg( c.dW20, 0, 'f', 2 )
+                                                 .arg( AHRSDraw::TrafficSpriteSteps );
+
+    m_dTrafficSprite = c.dW20;
+    m_trafficAtlas = AssetCache::lookup( qsKey );
+    if( !m_trafficAtlas.isNull() )
+        return;
+
+    m_trafficAtlas = QImage( iCell * AHRSDraw::TrafficSpriteSteps, iCell * AHRSDraw::TrafficSpriteCount, QImage::Format_ARGB32_Premultiplied );
+    m_trafficAtlas.fill( Qt::transparent );
+
+    QPainter atlas( &m_trafficAtlas );
+
+    atlas.setRenderHints( QPainter::Antialiasing | QPainter::SmoothPixmapTransform, true );
+    for( iSprite = 0; iSprite < AHRSDraw::TrafficSpriteCount; iSprite++ )
+    {
+        stickPen.setColor( sticks[iSprite] );
+        atlas.setPen( stickPen );
+        for( iStep = 0; iStep < AHRSDraw::TrafficSpriteSteps; iStep++ )
+        {
+            atlas.resetTransform();
+            atlas.translate( (iStep * iCell) + (iCell / 2.0), (iSprite * iCell) + (iCell / 2.0) );
+            atlas.rotate( iStep * 360.0 / AHRSDraw::TrafficSpriteSteps );
+            atlas.drawImage( iconRect, *icons[iSprite] );
+            atlas.drawLine( QPointF( 0.0, 0.0 ), QPointF( 0.0, -c.dW20 ) );
+        }
+    }
+    atlas.end();
+
+    // The copy is shallow; writing it out is what's slow
+    QtConcurrent::run( AssetCache::store, qsKey, m_trafficAtlas );
+}
+
+
+// Anything already in the asset cache goes straight in. Otherwise it's scaled on a worker and the instruments keep the
+// artwork they have until it's back (at startup they aren't drawn at all until then).
+void AHRSCanvas::startAssets( CanvasConstants &c )
+{
+    CanvasAssets assets = loadAssets( c, m_bPortrait, false );
+
+    if( assets.bComplete )
+    {
+        applyAssets( assets );
+        return;
+    }
+
+    m_bAssetsPending = true;
+    m_assetWatcher.setFuture( QtConcurrent::run( AHRSCanvas::loadAssets, c, m_bPortrait, true ) );
+}
+
+
+// Runs on a worker so it only deals in images. Everything is scaled to the size it's drawn at.
+CanvasAssets AHRSCanvas::loadAssets( CanvasConstants c, bool bPortrait, bool bScale )
+{
+    CanvasAssets assets;
+    int          iBugSize = static_cast<int>( c.dWa * (bPortrait ? 0.1333 : 0.08) ) / 2;
+    QSize        bugSize( iBugSize, iBugSize );
+    QSize        dialSize( qRound( c.dHeadDiam ), qRound( c.dHeadDiam ) );
+    QSize        rollSize( qRound( c.dW - c.dW5 ), qRound( c.dW - c.dW5 ) );
+
+    assets.headIcon = AssetCache::scaled( ":/icons/resources/HeadingIcon.png", bugSize, bScale );
+    assets.windIcon = AssetCache::scaled( ":/icons/resources/WindIcon.png", bugSize, bScale );
+    if( bPortrait )
+        assets.vertSpeedTape = AssetCache::scaled( ":/graphics/resources/vspeedP.png", QSize( qRound( c.dW20 ), qRound( c.dH2 ) ), bScale );
+    else
+        assets.vertSpeedTape = AssetCache::scaled( ":/graphics/resources/vspeedL.png", QSize( qRound( c.dW20 ), qRound( c.dH ) ), bScale );
+    assets.headIndicator = AssetCache::scaled( ":/graphics/resources/headBG.png", dialSize, bScale );
+    assets.headIndicatorOverlay = AssetCache::scaled( ":/graphics/resources/head.png", dialSize, bScale );
+    assets.rollIndicator = AssetCache::scaled( ":/graphics/resources/roll.png", rollSize, bScale );
+    assets.altTape = AssetCache::scaled( ":/graphics/resources/alttape.png", QSize( static_cast<int>( c.dW10 ), 0 ), bScale );
+    assets.speedTape = AssetCache::scaled( ":/graphics/resources/speedtape.png", QSize( static_cast<int>( c.dW10 - c.dW40 ), 0 ), bScale );
+    assets.fuel = AssetCache::scaled( ":/graphics/resources/fuel.png", QSize( qRound( c.dW20 ), qRound( c.dH2 - c.dH5 ) ), bScale );
+
+    assets.bComplete = !(assets.headIcon.isNull() || assets.windIcon.isNull() || assets.vertSpeedTape.isNull() ||
+                         assets.headIndicator.isNull() || assets.headIndicatorOverlay.isNull() || assets.rollIndicator.isNull() ||
+                         assets.altTape.isNull() || assets.speedTape.isNull() || assets.fuel.isNull());
+
+    return assets;
+}
+
+
+void AHRSCanvas::applyAssets( const CanvasAssets &assets )
+{
+    m_headIcon = QPixmap::fromImage( assets.headIcon );
+    m_windIcon = QPixmap::fromImage( assets.windIcon );
+    m_VertSpeedTape = QPixmap::fromImage( assets.vertSpeedTape );
+    m_HeadIndicator = QPixmap::fromImage( assets.headIndicator );
+    m_HeadIndicatorOverlay = QPixmap::fromImage( assets.headIndicatorOverlay );
+    m_RollIndicator = QPixmap::fromImage( assets.rollIndicator );
+    m_AltTape = QPixmap::fromImage( assets.altTape );
+    m_SpeedTape = QPixmap::fromImage( assets.speedTape );
+    m_Lfuel = QPixmap::fromImage( assets.fuel );
+    m_Rfuel = QPixmap::fromImage( assets.fuel.mirrored( true, false ) );
+
+    m_bAssetsPending = false;
+    m_bInitialized = true;
+    invalidateLayers();
+    update();
+}
+
+
+// A newer load replaces the watcher's future so a stale one never gets here
+void AHRSCanvas::assetsReady()
+{
+    if( !m_bAssetsPending )
+        return;
+
+    applyAssets( m_assetWatcher.result() );
+
+    // A rotation during the first load was skipped since nothing was initialized yet
+    if( geometryChanged() )
+        orient2();
+}
+
+
+// Alerted airspaces are drawn differently so the cached airspace raster has to be redrawn
+void AHRSCanvas::airspaceAlertsChanged()
+{
+    m_mapJobs[AHRSDraw::AirspaceMapLayer].bValid = false;
+    markDirty( MapRegion, true );
+}
+
+
+// Only the render benchmark sets m_pStageNs; painting to a QImage is synchronous so the elapsed time is the real cost
+void AHRSCanvas::stageStart()
+{
+    if( m_pStageNs != nullptr )
+        m_stageTimer.start();
+}
+
+
+void AHRSCanvas::stageDone( InstrumentRegion eRegion )
+{
+    if( m_pStageNs != nullptr )
+        m_pStageNs[eRegion] += m_stageTimer.nsecsElapsed();
+}
+
+
+// Size the layer pixmap to the bounds and leave the painter set up so the caller draws in widget coordinates
+void AHRSCanvas::startLayer( QPainter *pPainter, CanvasLayerId eLayer, const QRectF &bounds )
+{
+    QRect layerRect = bounds.toAlignedRect();
+
+    m_layers[eLayer].origin = layerRect.topLeft();
+    m_layers[eLayer].pixmap = QPixmap( layerRect.size().expandedTo( QSize( 1, 1 ) ) );
+    m_layers[eLayer].pixmap.fill( Qt::transparent );
+
+    pPainter->begin( &m_layers[eLayer].pixmap );
+    pPainter->translate( -m_layers[eLayer].origin );
+}
+
+
+void AHRSCanvas::drawLayer( QPainter *pAhrs, CanvasLayerId eLayer )
+{
+    pAhrs->drawPixmap( m_layers[eLayer].origin, m_layers[eLayer].pixmap );
+}
+
+
+bool AHRSCanvas::layersValid( CanvasConstants &c )
+{
+    return m_bLayersValid && (m_dLayerW == c.dW) && (m_dLayerH == c.dH) && (m_bLayerPortrait == m_bPortrait);
+}
+
+
+// Anything that changes the look of the static layers calls this; they're rebuilt on the next paint
+void AHRSCanvas::invalidateLayers()
+{
+    m_bLayersValid = false;
+}
+
+
+void AHRSCanvas::startFuelFlow()
+{
+    m_fuelFlow.start( &m_tanks );
+    m_bFuelFlowStarted = true;
+    markDirty( InfoRegion );
+}
+
+
+void AHRSCanvas::stopFuelFlow()
+{
+    m_fuelFlow.stop();
+    m_bFuelFlowStarted = false;
+    markDirty( InfoRegion );
+}
+
+
+void AHRSCanvas::timerReminder( int iMinutes, int iSeconds )
+{
+    CanvasConstants c = m_pCanvas->constants();
+
+    m_iTimerMin = iMinutes;
+    m_iTimerSec = iSeconds;
+    markDirty( InfoRegion );
+
+    if( (iMinutes == 0) && (iSeconds == 0) )
+    {
+        TimerDialog  dlg( this );
+
+        dlg.setGeometry( c.dW2 - c.dW5, c.dH - c.dW2 - 20 - c.dH5, c.dW5 + c.dW5, c.dH5 + c.dH5 );
+
+        int          iSel = dlg.exec();
+        AHRSMainWin *pMainWin = static_cast<AHRSMainWin *>( parentWidget()->parentWidget() );
+
+        if( iSel == QDialog::Rejected )
+        {
+            m_iTimerMin = m_iTimerSec = -1;
+            markDirty( InfoRegion );
+            return;
+        }
+        else if( iSel == TimerDialog::Restart )
+            pMainWin->restartTimer();
+        else if( iSel == TimerDialog::Change )
+            pMainWin->changeTimer();
+    }
+}
+
+
+// Usually the widget hasn't been resized for the new orientation yet and resizeEvent() picks it up when it is; if it
+// already has there won't be another resize
 void AHRSCanvas::orient( bool bPortrait )
 {
     m_bPortrait = bPortrait;
-    QTimer::singleShot( 1000, this, SLOT( orient2() ) );
+    if( geometryChanged() )
+        orient2();
+}
+
+
+void AHRSCanvas::resizeEvent( QResizeEvent *pEvent )
+{
+    QWidget::resizeEvent( pEvent );
+    if( geometryChanged() )
+        orient2();
+}
+
+
+// Whether the widget has settled at a size for the current orientation that the canvas wasn't worked out for
+bool AHRSCanvas::geometryChanged()
+{
+    if( m_pCanvas == nullptr )
+        return false;
+
+    CanvasConstants c = m_pCanvas->constants();
+
+    if( (width() < height()) != m_bPortrait )
+        return false;
+
+    return (c.dWa != static_cast<double>( width() )) || (c.dH != static_cast<double>( height() ));
 }
 
 
@@ -1679,29 +2380,13 @@ void AHRSCanvas::orient2()
     m_pCanvas->init( width(), height(), m_bPortrait );
 
     CanvasConstants c = m_pCanvas->constants();
-    int             iBugSize = static_cast<int>( c.dWa * (m_bPortrait ? 0.1333 : 0.08) );
 
-    // Reload the icons so we don't loose resolution
-    m_headIcon.load( ":/icons/resources/HeadingIcon.png" );
-    m_windIcon.load( ":/icons/resources/WindIcon.png" );
-    // Rescale them
-    m_headIcon = m_headIcon.scaled( iBugSize, iBugSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-    m_windIcon = m_windIcon.scaled( iBugSize, iBugSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+    // Rescaled from the original artwork each time so nothing loses resolution going back and forth
+    startAssets( c );
 
-    if( m_bPortrait )
-        m_VertSpeedTape.load( ":/graphics/resources/vspeedP.png" );
-    else
-        m_VertSpeedTape.load( ":/graphics/resources/vspeedL.png" );
-
-    // Reload these for the same reason as above
-    m_AltTape.load( ":/graphics/resources/alttape.png" );
-    m_SpeedTape.load( ":/graphics/resources/speedtape.png" );
-    // Rescale them
-    m_AltTape = m_AltTape.scaledToWidth( c.dW10, Qt::SmoothTransformation );
-    m_SpeedTape = m_SpeedTape.scaledToWidth( c.dW10 - c.dW40, Qt::SmoothTransformation );
-    QTransform flipper;
-    flipper.scale( -1, 1 );
-    m_Rfuel = m_Lfuel.transformed( flipper );
+    // Digits are blitted from a pre-scaled atlas so it has to match the new number size
+    Builder::buildGlyphAtlas( &c );
+    invalidateLayers();
 
     m_bInitialized = true;
 }
@@ -1716,8 +2401,24 @@ void AHRSCanvas::swipeLeft()
 }
 
 
+// Steps through the debug overlays: the governor strip, then the profiler panel under it as well, then off again
+// (which saves the profile)
 void AHRSCanvas::swipeRight()
 {
+    if( !m_governor.statsShown() )
+        m_governor.showStats( true );
+    else if( !m_bShowProfile )
+    {
+        m_bShowProfile = true;
+        Profiler::setEnabled( true );
+    }
+    else
+    {
+        dumpProfile();
+        m_bShowProfile = false;
+        Profiler::setEnabled( false );
+        m_governor.showStats( false );
+    }
     update();
 }
 
@@ -1744,6 +2445,7 @@ void AHRSCanvas::setSwitchableTanks( bool bSwitchable )
         m_tanks.dRightCapacity = 0.0;
         m_tanks.dRightRemaining = 0.0;
     }
+    markDirty( InfoRegion );
 }
 
 
@@ -1778,6 +2480,7 @@ const QString AHRSCanvas::speedUnits()
 void AHRSCanvas::dark( bool bDark )
 {
     m_bDark = bDark;
+    invalidateLayers();
     repaint();
     QApplication::processEvents();
 }
@@ -9,9 +9,9 @@ Stratofier Stratux AHRS Display
 #include <QLineF>
 #include <QTransform>
 #include <QVariant>
-#include <QSettings>
 #include <QBitmap>
 #include <QPainterPath>
+#include <QPair>
 
 
 #include <math.h>
@@ -20,6 +20,10 @@ Stratofier Stratux AHRS Display
 #include "StratuxStreams.h"
 #include "TrafficMath.h"
 #include "Builder.h"
+#include "AirspaceAlert.h"
+#include "StratofierDefs.h"
+#include "LabelCache.h"
+#include "Profiler.h"
 
 
 extern QFont itsy;
@@ -30,7 +34,6 @@ extern QFont med;
 extern QFont large;
 
 extern StratuxSituation      g_situation;
-extern QSettings            *g_pSet;
 extern QList<StratuxTraffic> g_trafficList;
 extern QString               g_qsStratofierVersion;
 
@@ -46,11 +49,7 @@ AHRSDraw::AHRSDraw( QPainter *pAHRS,
                     double dZoomNM,
                     StratofierSettings *pSettings,
                     int iMagDev,
-                    QPixmap *trafficRed,
-                    QPixmap *trafficYellow,
-                    QPixmap *trafficGreen,
-                    QPixmap *trafficCyan,
-                    QPixmap *trafficOrange )
+                    QImage *pTrafficAtlas )
     : m_pAHRS( pAHRS ),
       m_pC( pC ),
       m_pCanvas( pCanvas ),
@@ -62,11 +61,12 @@ AHRSDraw::AHRSDraw( QPainter *pAHRS,
       m_dZoomNM( dZoomNM ),
       m_pSettings( pSettings ),
       m_iMagDev( iMagDev ),
-      m_trafficRed( trafficRed ),
-      m_trafficYellow( trafficYellow ),
-      m_trafficGreen( trafficGreen ),
-      m_trafficCyan( trafficCyan ),
-      m_trafficOrange( trafficOrange )
+      m_pTrafficAtlas( pTrafficAtlas ),
+      m_pAlert( nullptr ),
+      m_pTraffic( &g_trafficList ),
+      m_pOwnship( &g_situation ),
+      m_pAlerted( nullptr ),
+      m_dHeading( g_situation.dAHRSGyroHeading )
 {
 }
 
@@ -130,10 +130,13 @@ void AHRSDraw::drawCurrSpeed( QPixmap *pNum, bool bGS )
 
 void AHRSDraw::drawDirectOrFromTo()
 {
+    ProfileScope scope( Profiler::DirectToStage );
+
     if( ((m_pDirectAP->qsID == "NULL") && (m_pFromAP->qsID == "NULL")) || (m_pAirports->count() == 0) )
         return;
 
-    QPen coursePen( Qt::yellow, 8, Qt::SolidLine, Qt::RoundCap );
+    QPen   coursePen( Qt::yellow, 8, Qt::SolidLine, Qt::RoundCap );
+    double dPxPerNM = static_cast<double>( m_pC->dW - 30.0 ) / (m_dZoomNM * 2.0);    // Same scale as the airports
 
     maskHeading();
 
@@ -148,15 +151,10 @@ void AHRSDraw::drawDirectOrFromTo()
         Airport ap = m_pAirports->at( iAP );
 
         if( m_pC->bPortrait )
-        {
             ball.setP1( QPointF( m_pC->dW2, m_pC->dH - m_pC->dW2 - 10.0 ) );
-            ball.setP2( ap.logicalPt );
-        }
         else
-        {
             ball.setP1( QPointF( m_pC->dW + m_pC->dW2, m_pC->dH - m_pC->dW2 - 10.0 ) );
-            ball.setP2( ap.logicalPt );
-        }
+        ball.setP2( project( ap.bd, dPxPerNM ) );
         if( ball.length() > (m_pC->dW2 - 30.0) )
             ball.setLength( m_pC->dW2 - 30.0 );
 
@@ -186,7 +184,7 @@ void AHRSDraw::drawDirectOrFromTo()
         Airport apTo = m_pAirports->at( iToAP );
 
         m_pAHRS->setPen( coursePen );
-        m_pAHRS->drawLine( apFrom.logicalPt, apTo.logicalPt );
+        m_pAHRS->drawLine( project( apFrom.bd, dPxPerNM ), project( apTo.bd, dPxPerNM ) );
 
         double dDispBearing = apTo.bd.dBearing;
         QPixmap num( 320, 84 );
@@ -204,30 +202,27 @@ void AHRSDraw::drawDirectOrFromTo()
 }
 
 
+// Everything of one style is gathered up and drawn in one go (all the shadows, then all the rings, runways and IDs)
+// rather than switching pens back and forth for every airport
 void AHRSDraw::updateAirports()
 {
-    Airport      ap;
-    QLineF       ball;
-    double	     dPxPerNM = static_cast<double>( m_pC->dW - 30.0 ) / (m_dZoomNM * 2.0);	// Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
-    double       dAPDist;
-    QPen         apPen( Qt::magenta );
-    QLineF       runwayLine;
-    int          iRunway, iAPRunway;
-    double       dAirportDiam = m_pC->dWa * (m_pC->bPortrait ? 0.03125 : 0.01875);
-    QRect        apRect;
-    double       deltaY;
-    double       dHead = g_situation.dAHRSGyroHeading;
-    int          iAP = 0;
-
-    QFontMetrics apMetrics( tiny );
-
-    m_pAHRS->setFont( tiny );
+    ProfileScope scope( Profiler::AirportsStage );
+
+    Airport                      ap;
+    double	                     dPxPerNM = static_cast<double>( m_pC->dW - 30.0 ) / (m_dZoomNM * 2.0);	// Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
+    QPen                         apPen( Qt::black );
+    QLineF                       runwayLine;
+    int                          iRunway, iAPRunway;
+    double                       dAirportDiam = m_pC->dWa * (m_pC->bPortrait ? 0.03125 : 0.01875);
+    bool                         bRunways = (m_dZoomNM <= 30) && m_pSettings->bShowRunways;
+    QList<Airport>               shown;
+    QPainterPath                 shadowPath, ringPath, runwayPath;
+    QList<QPair<QPointF, int> >  runwayNums;
+    QPair<QPointF, int>          runwayNum;
+    CachedLabel                  apLabel;
 
     maskHeading();
 
-    apPen.setWidth( m_pC->iThinPen );
-    m_pAHRS->setBrush( Qt::NoBrush );
-
     foreach( ap, *m_pAirports )
     {
         if( ap.bGrass && (m_pSettings->eShowAirports == Canvas::ShowPavedAirports) )
@@ -237,59 +232,50 @@ void AHRSDraw::updateAirports()
         else if( (ap.qsID == "R") && (!m_pSettings->bShowPrivate) )
             continue;
 
-        apRect = apMetrics.boundingRect( ap.qsID );
-
-        dAPDist = ap.bd.dDistance * dPxPerNM;
-
-        ball.setP1( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - m_pC->dHeadDiam2 - 10.0 ) );
-        ball.setP2( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - m_pC->dHeadDiam2 - 10.0 + dAPDist ) );
-
-        // Airport angle in reference to you (which clock position it's at)
-        ball.setAngle( ap.bd.dBearing - dHead - 90.0 );
-        // Qt Y coords are backward
-        deltaY = ball.p2().y() - (m_pC->dH - m_pC->dHeadDiam2 - 10.0);
-        ball.setP2( QPointF( ball.p2().x(), m_pC->dH - m_pC->dHeadDiam2 - 10.0 - deltaY ) );
-
-        apPen.setWidth( m_pC->iThinPen );
-        apPen.setColor( Qt::black );
-        m_pAHRS->setPen( apPen );
-        ap.logicalPt.setX( ball.p2().x() );
-        ap.logicalPt.setY( ball.p2().y() );
-        m_pAHRS->drawEllipse( ap.logicalPt.x() - (dAirportDiam / 2.0) + 1.0, ap.logicalPt.y()- (dAirportDiam / 2.0) + 1.0, dAirportDiam, dAirportDiam );
-        apPen.setColor( Qt::magenta );
-        m_pAHRS->setPen( apPen );
-        m_pAHRS->drawEllipse( ap.logicalPt.x() - (dAirportDiam / 2.0), ap.logicalPt.y() - (dAirportDiam / 2.0), dAirportDiam, dAirportDiam );
-        apPen.setColor( Qt::black );
-        m_pAHRS->setPen( apPen );
-        m_pAHRS->drawText( ball.p2().x() - (dAirportDiam / 2.0) - (apRect.width() / 2) + 2, ball.p2().y() - (dAirportDiam / 2.0) + apRect.height() - 1, ap.qsID );
-        // Draw the runways and tiny headings after the black ID shadow but before the yellow ID text
-        if( (m_dZoomNM <= 30) && m_pSettings->bShowRunways )
+        ap.logicalPt = project( ap.bd, dPxPerNM );
+        shadowPath.addEllipse( ap.logicalPt + QPointF( 1.0, 1.0 ), dAirportDiam / 2.0, dAirportDiam / 2.0 );
+        ringPath.addEllipse( ap.logicalPt, dAirportDiam / 2.0, dAirportDiam / 2.0 );
+        if( bRunways )
         {
             for( iRunway = 0; iRunway < ap.runways.count(); iRunway++ )
             {
                 iAPRunway = ap.runways.at( iRunway );
-                runwayLine.setP1( QPointF( ball.p2().x(), ball.p2().y() ) );
-                runwayLine.setP2( QPointF( ball.p2().x(), ball.p2().y() + (dAirportDiam * 2.0) ) );
+                runwayLine.setP1( ap.logicalPt );
+                runwayLine.setP2( QPointF( ap.logicalPt.x(), ap.logicalPt.y() + (dAirportDiam * 2.0) ) );
                 runwayLine.setAngle( 270.0 - static_cast<double>( iAPRunway ) );
-                apPen.setColor( Qt::magenta );
-                apPen.setWidth( m_pC->iThickPen );
-                m_pAHRS->setPen( apPen );
-                m_pAHRS->drawLine( runwayLine );
-                if( ((iAPRunway - dHead) > 90) && ((iAPRunway - dHead) < 270) )
+                runwayPath.moveTo( runwayLine.p1() );
+                runwayPath.lineTo( runwayLine.p2() );
+                if( ((iAPRunway - m_dHeading) > 90) && ((iAPRunway - m_dHeading) < 270) )
                     runwayLine.setLength( runwayLine.length() + m_pC->dW80 );
-                QPixmap num( 128, 84 ); // It would need to be resized back anyway so creating a new one each time is faster
-                num.fill( Qt::transparent );
-                Builder::buildNumber( &num, m_pC, iAPRunway / 10, 2 );
-                num = num.scaledToWidth( m_pC->dW20, Qt::SmoothTransformation );
-                m_pAHRS->drawPixmap( runwayLine.p2(), num );
+                runwayNums.append( qMakePair( runwayLine.p2(), iAPRunway / 10 ) );
             }
         }
-        apPen.setColor( Qt::yellow );
+        shown.append( ap );
+    }
+
+    m_pAHRS->setBrush( Qt::NoBrush );
+    apPen.setWidth( m_pC->iThinPen );
+    m_pAHRS->setPen( apPen );
+    m_pAHRS->drawPath( shadowPath );
+    apPen.setColor( Qt::magenta );
+    m_pAHRS->setPen( apPen );
+    m_pAHRS->drawPath( ringPath );
+
+    // Draw the runways and tiny headings under the IDs
+    if( bRunways )
+    {
+        apPen.setWidth( m_pC->iThickPen );
         m_pAHRS->setPen( apPen );
-        m_pAHRS->drawText( ball.p2().x() - (dAirportDiam / 2.0) - (apRect.width() / 2) + 1, ball.p2().y() - (dAirportDiam / 2.0) + apRect.height() - 2, ap.qsID );
+        m_pAHRS->drawPath( runwayPath );
+        foreach( runwayNum, runwayNums )
+            m_pAHRS->drawImage( runwayNum.first, LabelCache::runway( m_pC, runwayNum.second, static_cast<int>( m_pC->dW20 ) ) );
+    }
 
-        m_pAirports->replace( iAP, ap );    // Update airports with logical coords for painting DirectTo and FromTo
-        iAP++;
+    foreach( ap, shown )
+    {
+        apLabel = LabelCache::label( ap.qsID, tiny, Qt::yellow, Qt::black, QPoint( 1, 1 ) );
+        LabelCache::draw( m_pAHRS, QPointF( ap.logicalPt.x() - (dAirportDiam / 2.0) - (apLabel.textSize.width() / 2) + 1,
+                                            ap.logicalPt.y() - (dAirportDiam / 2.0) + apLabel.textSize.height() - 2 ), apLabel );
     }
 
     m_pAHRS->setClipping( false );
@@ -298,17 +284,16 @@ void AHRSDraw::updateAirports()
 
 void AHRSDraw::updateAirspaces()
 {
+    ProfileScope scope( Profiler::AirspacesStage );
+
     if( !m_pSettings->bShowAirspaces )
         return;
 
     Airspace     as;
-    QLineF       ball;
     double	     dPxPerNM = static_cast<double>( m_pC->dHeadDiam ) / (m_dZoomNM * 2.0);	// Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
-    double       dASDist;
     QPen         asPen( Qt::yellow );
     BearingDist  bd;
     QPolygonF    airspacePoly;
-    double       deltaY;
 
     maskHeading();
 
@@ -318,19 +303,7 @@ void AHRSDraw::updateAirspaces()
     {
         airspacePoly.clear();
         foreach( bd, as.shapeHav )
-        {
-            dASDist = bd.dDistance * dPxPerNM;
-
-            ball.setP1( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 ) );
-            ball.setP2( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 - dASDist ) );
-
-            // Airspace polygon point angle in reference to you (which clock position it's at)
-            ball.setAngle( bd.dBearing - g_situation.dAHRSGyroHeading - 90.0 );
-            // Qt Y coords are backward
-            deltaY = ball.p2().y() - (m_pC->dH - 10.0 - m_pC->dHeadDiam2);
-            ball.setP2( QPointF( ball.p2().x(), m_pC->dH - 10.0 - m_pC->dHeadDiam2 - deltaY ) );
-            airspacePoly.append( ball.p2() );
-        }
+            airspacePoly.append( project( bd, dPxPerNM ) );
         m_pAHRS->setBrush( Qt::NoBrush );
         switch( as.eType )
         {
@@ -372,136 +345,136 @@ void AHRSDraw::updateAirspaces()
                 asPen.setColor( Qt::transparent );
                 break;
         }
+        // Anything we're in or about to be in gets a fat red outline regardless of type
+        if( (m_pAlerted != nullptr) && m_pAlerted->contains( as.qsName ) )
+        {
+            asPen.setColor( Qt::red );
+            asPen.setWidth( m_pC->iFatPen );
+        }
+        else
+            asPen.setWidth( m_pC->iThinPen );
         m_pAHRS->setPen( asPen );
         m_pAHRS->drawPolygon( airspacePoly );
+        // Top over bottom centered on the label anchor worked out when the airspace was loaded
         if( (as.iAltTop > 0) && m_pSettings->bShowAltitudes )
         {
-            QRectF asBound = airspacePoly.boundingRect();
-            QLineF asLine( asBound.topRight(), asBound.bottomLeft() );
-            while( !airspacePoly.containsPoint( asLine.p2(), Qt::OddEvenFill ) )
-                asLine.setLength( asLine.length() - 1.0 );
-            asLine.setLength( asLine.length() - 2.0 );
+            QPointF labelPt = project( as.labelHav, dPxPerNM );
+            QRectF  topRect( labelPt.x() - m_pC->dW10, labelPt.y() - m_pC->iTinyFontHeight, m_pC->dW10 * 2.0, m_pC->iTinyFontHeight );
+            QRectF  bottomRect( labelPt.x() - m_pC->dW10, labelPt.y(), m_pC->dW10 * 2.0, m_pC->iTinyFontHeight );
+
             m_pAHRS->setPen( Qt::darkGray );
             m_pAHRS->setFont( itsy );
-            m_pAHRS->drawText( QPointF( asLine.p2().x(), asLine.p2().y() - m_pC->iTinyFontHeight ), QString::number( as.iAltTop / 100 ) );
+            m_pAHRS->drawText( topRect, Qt::AlignHCenter | Qt::AlignBottom, QString::number( as.iAltTop / 100 ) );
             if( as.iAltBottom <= 0 )
-                m_pAHRS->drawText( asLine.p2(), "GND" );
+                m_pAHRS->drawText( bottomRect, Qt::AlignHCenter | Qt::AlignTop, "GND" );
             else
-                m_pAHRS->drawText( asLine.p2(), QString::number( as.iAltBottom / 100 ) );
+                m_pAHRS->drawText( bottomRect, Qt::AlignHCenter | Qt::AlignTop, QString::number( as.iAltBottom / 100 ) );
         }
     }
     m_pAHRS->setClipping( false );
 }
 
 
-// Draw the traffic onto the heading indicator and the tail numbers on the side
+// Draw the traffic onto the heading indicator
 void AHRSDraw::updateTraffic()
 {
+    ProfileScope scope( Profiler::TrafficStage );
+
     StratuxTraffic traffic;
-    QPen           stickPen( Qt::green, 2 );
     double		   dPxPerNM = m_pC->dHeadDiam / (m_dZoomNM * 2.0);     // Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
-    QLineF		   ball, info, stick;
+    QLineF		   ball, info;
     double         dAlt;
     QString        qsSign;
-    QFontMetrics   smallMetrics( small );
     QColor         closenessColor( Qt::green );
-    QRectF         trafficRect( 0.0, 0.0, m_pC->dW20, m_pC->dW20 );
-    QPointF        unBall;
-    double         dHead = g_situation.dAHRSGyroHeading;
+    double         dHead = m_dHeading;
+    double         dTrack;
+    int            iSprite, iStep;
+    int            iCell = m_pTrafficAtlas->height() / TrafficSpriteCount;
+
+    if( m_pTrafficAtlas->isNull() )
+        return;
 
     maskHeading();
 
     // Draw a chevron for each aircraft; the outer edge of the heading indicator is calibrated to be 20 NM out from your position
-    foreach( traffic, g_trafficList )
+    foreach( traffic, *m_pTraffic )
     {
         // If bearing and distance were able to be calculated then show relative position
         if( traffic.bHasADSB && (traffic.qsTail != m_pSettings->qsOwnshipID) )
         {
             double dTrafficDist = traffic.dDist * dPxPerNM;
-            double dAltDist = traffic.dAlt - g_situation.dBaroPressAlt;
+            double dAltDist = traffic.dAlt - m_pOwnship->dBaroPressAlt;
             double dAltDistAbs = fabs( dAltDist );
 
             if( m_pSettings->bShowAllTraffic || (dAltDistAbs < 5000) )
             {
                 closenessColor = Qt::green;
 
-                ball.setP1( QPointF( (m_pC->bPortrait ? 0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 ) );
-                ball.setP2( QPointF( (m_pC->bPortrait ? 0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 - dTrafficDist ) );
+                ball.setP1( m_pCanvas->layout().headCenter );
+                ball.setP2( m_pCanvas->layout().headCenter - QPointF( 0.0, dTrafficDist ) );
 
                 // Traffic angle in reference to you (which clock position they're at regardless of their own course)
                 ball.setAngle( -(traffic.dBearing - dHead - 90.0) );
 
-                // Draw the arrow
-                trafficRect.moveCenter( ball.p2() );
-                m_pAHRS->translate( ball.p2() );
-                m_pAHRS->rotate( traffic.dTrack - 90.0 + g_situation.dAHRSMagHeading - static_cast<double>( m_iMagDev * 2.0 ) );
-                unBall.setX( -ball.p2().x() );
-                unBall.setY( -ball.p2().y() );
-                m_pAHRS->translate( unBall );
-
+                // Draw the arrow and stick from the sprite atlas cell nearest its track
                 if( traffic.bOnGround )
                 {
-                    m_pAHRS->drawPixmap( trafficRect.toRect(), *m_trafficCyan );
-                    stickPen.setColor( Qt::cyan );
+                    iSprite = TrafficCyanSprite;
                     closenessColor = Qt::cyan;
                 }
                 else if( dAltDistAbs > 2000 )
                 {
-                    m_pAHRS->drawPixmap( trafficRect.toRect(), *m_trafficGreen );
-                    stickPen.setColor( Qt::green );
+                    iSprite = TrafficGreenSprite;
                     closenessColor = Qt::green;
                 }
                 else if( (dAltDistAbs <= 2000) && (dAltDistAbs > 1000) )
                 {
-                    m_pAHRS->drawPixmap( trafficRect.toRect(), *m_trafficYellow );
-                    stickPen.setColor( Qt::yellow );
+                    iSprite = TrafficYellowSprite;
                     closenessColor = Qt::yellow;
                 }
                 else if( (dAltDistAbs <= 1000) && (dAltDistAbs > 500) )
                 {
-                    m_pAHRS->drawPixmap( trafficRect.toRect(), *m_trafficOrange );
-                    stickPen.setColor( QColor( 0xFF, 0xA5, 0x00 ) );
+                    iSprite = TrafficOrangeSprite;
                     closenessColor = QColor( 0xFF, 0xA5, 0x00 );
                 }
                 else
                 {
-                    m_pAHRS->drawPixmap( trafficRect.toRect(), *m_trafficRed );
-                    stickPen.setColor( Qt::red );
+                    iSprite = TrafficRedSprite;
                     closenessColor = Qt::red;
                 }
-                // Create the stick
-                stick.setP1( ball.p2() );
-                stick.setP2( QPointF( ball.p2().x(), ball.p2().y() - m_pC->dW20 ) );
-                m_pAHRS->setPen( stickPen );
-                m_pAHRS->drawLine( stick );
-                m_pAHRS->resetTransform();
+                dTrack = traffic.dTrack - 90.0 + m_pOwnship->dAHRSMagHeading - static_cast<double>( m_iMagDev * 2.0 );
+                iStep = qRound( dTrack * TrafficSpriteSteps / 360.0 ) % TrafficSpriteSteps;
+                if( iStep < 0 )
+                    iStep += TrafficSpriteSteps;
+                m_pAHRS->drawImage( QPointF( ball.p2().x() - (iCell / 2.0), ball.p2().y() - (iCell / 2.0) ),
+                                    *m_pTrafficAtlas, QRectF( iStep * iCell, iSprite * iCell, iCell, iCell ) );
 
                 // Draw the ID, numerical track heading and altitude delta
-                dAlt = (traffic.dAlt - g_situation.dBaroPressAlt) / 100.0;
+                dAlt = (traffic.dAlt - m_pOwnship->dBaroPressAlt) / 100.0;
                 if( dAlt > 0 )
                     qsSign = "+";
                 else if( dAlt < 0 )
                     qsSign = "-";
-                m_pAHRS->setPen( Qt::black );
-                m_pAHRS->setFont( wee );
-                info.setP1( ball.p2() );
-                info.setP2( QPointF( ball.p2().x() + m_pC->dW40, ball.p2().y() ) );
-                info.setAngle( 30.0 );
-                m_pAHRS->drawText( info.p2(), traffic.qsTail.isEmpty() ? "UNKWN" : traffic.qsTail );
-                info.setAngle( -50.0 );
-                m_pAHRS->drawText( info.p2(), QString( "%1%2" ).arg( qsSign ).arg( static_cast<int>( fabs( dAlt ) ) ) );
-                m_pAHRS->setPen( closenessColor );
-                info.translate( 2.0, 2.0 );
+                info.setP1( QPointF( ball.p2().x() + 2.0, ball.p2().y() + 2.0 ) );
+                info.setP2( QPointF( ball.p2().x() + 2.0 + m_pC->dW40, ball.p2().y() + 2.0 ) );
                 info.setAngle( 30.0 );
-                m_pAHRS->drawText( info.p2(), traffic.qsTail.isEmpty() ? "UNKWN" : traffic.qsTail );
+                LabelCache::draw( m_pAHRS, info.p2(),
+                                  LabelCache::label( traffic.qsTail.isEmpty() ? "UNKWN" : traffic.qsTail, wee, closenessColor, Qt::black, QPoint( -2, -2 ) ) );
                 info.setAngle( -50.0 );
-                m_pAHRS->drawText( info.p2(), QString( "%1%2" ).arg( qsSign ).arg( static_cast<int>( fabs( dAlt ) ) ) );
+                LabelCache::draw( m_pAHRS, info.p2(),
+                                  LabelCache::label( QString( "%1%2" ).arg( qsSign ).arg( static_cast<int>( fabs( dAlt ) ) ), wee, closenessColor, Qt::black, QPoint( -2, -2 ) ) );
             }
         }
     }
 
     m_pAHRS->setClipping( false );
+}
+
 
+// Zoom level and magnetic deviation in the corner; these sit outside the heading indicator so they aren't part of the
+// traffic layer
+void AHRSDraw::drawZoom()
+{
     QString qsZoom = QString( "%1nm" ).arg( static_cast<int>( m_dZoomNM ) );
     QString qsMagDev = QString( "%1%2" ).arg( m_iMagDev ).arg( QChar( 0xB0 ) );
 
@@ -591,8 +564,53 @@ void AHRSDraw::paintTimer( int iTimerMin, int iTimerSec )
 }
 
 
+// Banner across the top of the heading indicator for the most urgent airspace alert
+void AHRSDraw::paintAirspaceAlert()
+{
+    if( m_pAlert == nullptr )
+        return;
+
+    QList<AirspaceAlertState> alerts = m_pAlert->alerts();
+
+    if( alerts.isEmpty() )
+        return;
+
+    AirspaceAlertState alert = alerts.first();
+    QString            qsAlert;
+    QFontMetrics       smallMetrics( small );
+    QPen               linePen( Qt::black );
+    double             dCenterX = (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2;
+    double             dTop = m_pC->dH - 10.0 - m_pC->dHeadDiam + (m_pC->dHeadDiam * 0.1);
+    double             dWidth;
+
+    if( alert.iMinutes == 0 )
+        qsAlert = QString( "INSIDE %1" ).arg( alert.qsName );
+    else
+        qsAlert = QString( "%1 IN %2 MIN" ).arg( alert.qsName ).arg( alert.iMinutes );
+
+    dWidth = qMin( static_cast<double>( smallMetrics.width( qsAlert ) + 20 ), m_pC->dHeadDiam * 0.8 );
+    qsAlert = smallMetrics.elidedText( qsAlert, Qt::ElideMiddle, static_cast<int>( dWidth ) - 20 );
+
+    QRectF bannerRect( dCenterX - (dWidth / 2.0), dTop, dWidth, m_pC->iSmallFontHeight * 1.5 );
+
+    linePen.setWidth( m_pC->iThinPen );
+    m_pAHRS->setPen( linePen );
+    // Red if we're in it or it's a minute away, amber for the longer look ahead
+    if( alert.iMinutes <= 1 )
+        m_pAHRS->setBrush( QColor( 0xFF, 0x00, 0x00, 200 ) );
+    else
+        m_pAHRS->setBrush( QColor( 0xFF, 0xA5, 0x00, 200 ) );
+    m_pAHRS->drawRect( bannerRect );
+    m_pAHRS->setFont( small );
+    m_pAHRS->setPen( Qt::white );
+    m_pAHRS->drawText( bannerRect, Qt::AlignCenter, qsAlert );
+}
+
+
 void AHRSDraw::paintInfo()
 {
+    ProfileScope scope( Profiler::InfoStage );
+
     QLinearGradient cloudyGradient( 0.0, 50.0, 0.0, m_pC->dH - 50.0 );
     QFont           med_bu( med );
     QPen            linePen( Qt::black );
@@ -647,12 +665,54 @@ void AHRSDraw::paintInfo()
 }
 
 
-void AHRSDraw::maskHeading()
+// Runs on a worker thread (or inline if the platform can't render text off the GUI thread). QPainter on a QImage is
+// safe anywhere; the painter is offset so the drawing code works in widget coordinates as usual. The drawing reads the
+// job's copies of the traffic, ownship and alerts rather than the globals.
+void AHRSDraw::renderMapLayer( MapLayerJob *pJob )
 {
-    QPainterPath maskPath;
+    if( pJob->image.size() != pJob->rect.size() )
+        pJob->image = QImage( pJob->rect.size(), QImage::Format_ARGB32_Premultiplied );
+    pJob->image.fill( Qt::transparent );
+
+    QPainter layer( &pJob->image );
+    AHRSDraw draw( &layer, &pJob->c, pJob->pCanvas, &pJob->directAP, &pJob->fromAP, &pJob->toAP,
+                   &pJob->airports, &pJob->airspaces, pJob->dZoomNM, &pJob->settings, pJob->iMagDev,
+                   pJob->pTrafficAtlas );
+
+    draw.setTraffic( &pJob->traffic, &pJob->ownship );
+    draw.setAlerted( &pJob->alerted );
+    draw.setHeading( pJob->dHeading );
+    layer.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+    layer.translate( -pJob->rect.x(), -pJob->rect.y() );
+
+    switch( pJob->iLayer )
+    {
+        case AirspaceMapLayer:
+            draw.updateAirspaces();
+            break;
+        case AirportMapLayer:
+            draw.updateAirports();
+            break;
+        case TrafficMapLayer:
+            draw.updateTraffic();
+            break;
+    }
+}
+
 
-    maskPath.addEllipse( QPointF( (m_pC->bPortrait ? 0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 ),
-                         m_pC->dHeadDiam2, m_pC->dHeadDiam2 );
-    m_pAHRS->setClipPath( maskPath );
+// Where something at the given bearing and distance from ownship lands on the heading indicator, turned so the
+// map heading is up (north for the cached map raster).
+QPointF AHRSDraw::project( const BearingDist &bd, double dPxPerNM )
+{
+    double dAngle = (bd.dBearing - m_dHeading) * ToRad;
+    double dDist = bd.dDistance * dPxPerNM;
+
+    return m_pCanvas->layout().headCenter + QPointF( dDist * sin( dAngle ), -dDist * cos( dAngle ) );
+}
+
+
+void AHRSDraw::maskHeading()
+{
+    m_pAHRS->setClipPath( m_pCanvas->layout().headClip );
 }
 
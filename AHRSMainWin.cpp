@@ -12,7 +12,6 @@ Stratofier Stratux AHRS Display
 #include <QDesktopWidget>
 #include <QScreen>
 #include <QGuiApplication>
-#include <QSettings>
 #include <QPushButton>
 #include <QSpacerItem>
 #include <QNetworkAccessManager>
@@ -38,9 +37,10 @@ Stratofier Stratux AHRS Display
 #include "Canvas.h"
 #include "Keypad.h"
 #include "Builder.h"
+#include "SettingsStore.h"
 
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 
 // Standard fonts used throughout the app
@@ -69,7 +69,7 @@ AHRSMainWin::AHRSMainWin( const QString &qsIP, bool bPortrait, StreamReader *pSt
       m_iTimerTimer( -1 ),
       m_iSent( 0 )
 {
-    m_pStratuxStream->setUnits( static_cast<Canvas::Units>( g_pSet->value( "UnitsAirspeed" ).toInt() ) );
+    m_pStratuxStream->setUnits( g_pSettings->settings().eUnits );
 
     itsy.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
     wee.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
@@ -336,7 +336,7 @@ void AHRSMainWin::fuelTanks( FuelTanks tanks )
         tanks.dRightRemaining = 0.0;
     }
     m_pAHRSDisp->setFuelTanks( tanks );
-    m_pAHRSDisp->m_bFuelFlowStarted = true;
+    m_pAHRSDisp->startFuelFlow();
     QTimer::singleShot( 10, this, SLOT( fuelTanks2() ) );
 }
 
@@ -350,7 +350,7 @@ void AHRSMainWin::fuelTanks2()
 
 void AHRSMainWin::stopFuelFlow()
 {
-    m_pAHRSDisp->m_bFuelFlowStarted = false;
+    m_pAHRSDisp->stopFuelFlow();
     QTimer::singleShot( 10, this, SLOT( fuelTanks2() ) );
 }
 
@@ -373,8 +373,7 @@ void AHRSMainWin::unitsAirspeed()
         else
             pDlg->m_pUnitsAirspeedButton->setText( "KPH" );
     }
-    g_pSet->setValue( "UnitsAirspeed", static_cast<int>( g_eUnitsAirspeed ) );
-    g_pSet->sync();
+    g_pSettings->setValue( "UnitsAirspeed", static_cast<int>( g_eUnitsAirspeed ) );
     m_pStratuxStream->setUnits( g_eUnitsAirspeed );
     m_pAHRSDisp->update();
 }
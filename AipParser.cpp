@@ -0,0 +1,426 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+
+#include "AipParser.h"
+#include "StratofierDefs.h"
+
+
+// Binary index header; bump the version whenever the record layout below changes
+static const quint32 g_uiIndexMagic = 0x53414958;  // "SAIX"
+static const quint32 g_uiIndexVersion = 1;
+
+
+AipParser::AipParser()
+{
+    reset();
+}
+
+
+void AipParser::reset()
+{
+    m_xml.clear();
+    m_path.clear();
+    m_qsText.clear();
+    m_bComplete = false;
+    m_bError = false;
+    m_bInAirport = false;
+    m_bInAirspace = false;
+    m_bElevMeters = false;
+    m_airports.clear();
+    m_airspaces.clear();
+}
+
+
+// Whatever arrived is parsed right away; a record split across two chunks just waits for the next one
+void AipParser::addData( const QByteArray &data )
+{
+    if( m_bComplete || m_bError )
+        return;
+
+    m_xml.addData( data );
+    parse();
+}
+
+
+QList<Airport> AipParser::takeAirports()
+{
+    QList<Airport> airports = m_airports;
+
+    m_airports.clear();
+
+    return airports;
+}
+
+
+QList<Airspace> AipParser::takeAirspaces()
+{
+    QList<Airspace> airspaces = m_airspaces;
+
+    m_airspaces.clear();
+
+    return airspaces;
+}
+
+
+void AipParser::parse()
+{
+    while( !m_xml.atEnd() )
+    {
+        switch( m_xml.readNext() )
+        {
+            case QXmlStreamReader::StartElement:
+                startElement();
+                break;
+            case QXmlStreamReader::EndElement:
+                endElement();
+                break;
+            case QXmlStreamReader::Characters:
+                m_qsText.append( m_xml.text() );
+                break;
+            case QXmlStreamReader::EndDocument:
+                m_bComplete = true;
+                break;
+            default:
+                break;
+        }
+
+        if( m_bError )
+            return;
+    }
+
+    // Running out of data mid-document isn't an error here, it just means there's more on the way
+    if( m_xml.hasError() && (m_xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) )
+    {
+        qDebug() << m_xml.errorString() << m_xml.lineNumber() << m_xml.columnNumber();
+        m_bError = true;
+    }
+}
+
+
+void AipParser::startElement()
+{
+    QStringRef tag = m_xml.name();
+
+    m_qsText.clear();
+
+    // Don't proceed if this isn't an OpenAIP file
+    if( m_path.isEmpty() && (tag != QLatin1String( "OPENAIP" )) )
+    {
+        m_bError = true;
+        return;
+    }
+
+    m_path.append( tag.toString() );
+
+    if( (tag == QLatin1String( "AIRPORT" )) && (m_xml.attributes().value( "TYPE" ) != QLatin1String( "HELI_CIVIL" )) )
+    {
+        m_bInAirport = true;
+        m_ap.bd.dBearing = 0.0;
+        m_ap.bd.dDistance = 0.0;
+        m_ap.dLat = 0.0;
+        m_ap.dLong = 0.0;
+        m_ap.dElev = 0.0;
+        m_ap.bGrass = false;
+        m_ap.qsID.clear();
+        m_ap.qsName.clear();
+        m_ap.runways.clear();
+        m_ap.frequencies.clear();
+    }
+    else if( tag == QLatin1String( "ASP" ) )
+    {
+        QStringRef category = m_xml.attributes().value( "CATEGORY" );
+
+        m_bInAirspace = true;
+        m_as.qsName.clear();
+        m_as.eType = Canvas::Airspace_Class_G;
+        m_as.iAltTop = 0;
+        m_as.iAltBottom = 0;
+        m_as.shape.clear();
+        m_as.shapeLOD.clear();
+
+        if( category == QLatin1String( "G" ) )
+            m_as.eType = Canvas::Airspace_Class_G;
+        else if( category == QLatin1String( "E" ) )
+            m_as.eType = Canvas::Airspace_Class_E;
+        else if( category == QLatin1String( "D" ) )
+            m_as.eType = Canvas::Airspace_Class_D;
+        else if( category == QLatin1String( "C" ) )
+            m_as.eType = Canvas::Airspace_Class_C;
+        // The AIP database doesn't distinguish between MOA, TFR and SFRA types; most can be resolved by the name but those that can't will
+        // remain assigned to this unofficial type and should probably be colored the same as Restricted or Prohibited
+        else if( category == QLatin1String( "DANGER" ) )
+            m_as.eType = Canvas::Airspace_Danger;
+        else if( category == QLatin1String( "PROHIBITED" ) )
+            m_as.eType = Canvas::Airspace_Prohibited;
+        else if( category == QLatin1String( "RESTRICTED" ) )
+            m_as.eType = Canvas::Airspace_Restricted;
+    }
+    else if( m_bInAirport )
+    {
+        if( tag == QLatin1String( "ELEV" ) )
+            m_bElevMeters = m_xml.attributes().value( "UNIT" ).contains( "M", Qt::CaseInsensitive );
+        else if( (tag == QLatin1String( "DIRECTION" )) && (m_path.count() >= 2) && (m_path.at( m_path.count() - 2 ) == "RWY") )
+            m_ap.runways.append( m_xml.attributes().value( "TC" ).toInt() );
+        else if( tag == QLatin1String( "RADIO" ) )
+        {
+            m_freq.dFreq = 0.0;
+            m_freq.qsDescription.clear();
+        }
+    }
+}
+
+
+void AipParser::endElement()
+{
+    if( m_path.isEmpty() )
+        return;
+
+    QString tag = m_path.takeLast();
+    QString parent = m_path.isEmpty() ? QString() : m_path.last();
+
+    if( m_bInAirport )
+    {
+        if( tag == "AIRPORT" )
+        {
+            if( m_ap.qsID.isEmpty() )
+                m_ap.qsID = "R";
+            m_airports.append( m_ap );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
+            m_bInAirport = false;
+        }
+        else if( (tag == "ICAO") && (parent == "AIRPORT") )
+            m_ap.qsID = m_qsText;
+        else if( (tag == "NAME") && (parent == "AIRPORT") )
+        {
+            m_ap.qsName = m_qsText;
+            // Clean up really long names
+            m_ap.qsName.replace( "REGIONAL", "RGNL" );
+            m_ap.qsName.replace( "EXECUTIVE", "EXEC" );
+            m_ap.qsName.replace( "INTERNATIONAL", "INTL" );
+            m_ap.qsName.replace( "AERODROME", "AERO" );
+            m_ap.qsName.replace( "BALLOONPORT", "BALLOON" );
+            m_ap.qsName.remove( "AIRPORT" );
+            m_ap.qsName.remove( "FIELD" );
+        }
+        else if( parent == "GEOLOCATION" )
+        {
+            if( tag == "LAT" )
+                m_ap.dLat = m_qsText.toDouble();
+            else if( tag == "LON" )
+                m_ap.dLong = m_qsText.toDouble();
+            else if( tag == "ELEV" )
+                m_ap.dElev = m_qsText.toDouble() * (m_bElevMeters ? MetersToFeet : 1.0);
+        }
+        else if( (tag == "SFC") && (parent == "RWY") )
+        {
+            if( m_qsText == "GRAS" )
+                m_ap.bGrass = true;
+        }
+        else if( parent == "RADIO" )
+        {
+            if( tag == "FREQUENCY" )
+                m_freq.dFreq = m_qsText.toDouble();
+            else if( tag == "DESCRIPTION" )
+                m_freq.qsDescription = m_qsText;
+        }
+        else if( tag == "RADIO" )
+            m_ap.frequencies.append( m_freq );
+    }
+    else if( m_bInAirspace )
+    {
+        if( tag == "ASP" )
+        {
+            m_airspaces.append( m_as );
+            m_bInAirspace = false;
+        }
+        else if( (tag == "NAME") && (parent == "ASP") )
+        {
+            m_as.qsName = m_qsText;
+            // Try to resolve the ambiguous "DANGER" category to what it really is
+            if( m_as.qsName.contains( "MOA" ) || m_as.qsName.contains( "BY NOTAM" ) )
+                m_as.eType = Canvas::Airspace_MOA;
+            else if( m_as.qsName.contains( "TFR" ) )
+                m_as.eType = Canvas::Airspace_TFR;
+            else if( m_as.qsName.contains( "SFRA" ) )
+                m_as.eType = Canvas::Airspace_SFRA;
+        }
+        else if( (tag == "ALT") && (parent == "ALTLIMIT_TOP") )
+            m_as.iAltTop = m_qsText.toInt();       // Assume feet
+        else if( (tag == "ALT") && (parent == "ALTLIMIT_BOTTOM") )
+            m_as.iAltBottom = m_qsText.toInt();    // Assume feet
+        else if( (tag == "POLYGON") && (parent == "GEOMETRY") )
+        {
+            QStringList qslPolyCoords = m_qsText.split( ',' );
+            QString     qsCoordPair;
+
+            foreach( qsCoordPair, qslPolyCoords )
+            {
+                qsCoordPair = qsCoordPair.trimmed();
+
+                QStringList qslCoords = qsCoordPair.split( ' ' );
+                if( qslCoords.count() == 2 )
+                    m_as.shape.append( QPointF( qslCoords.first().toDouble(), qslCoords.last().toDouble() ) );
+            }
+        }
+    }
+
+    m_qsText.clear();
+}
+
+
+// Prefer the binary index when it's at least as new as the dataset; otherwise parse the XML and leave an index for next time
+bool AipParser::load( const QString &qsAip, QList<Airport> *pAirports, QList<Airspace> *pAirspaces )
+{
+    QString   qsIndex = indexPath( qsAip );
+    QFileInfo aipInfo( qsAip );
+    QFileInfo indexInfo( qsIndex );
+
+    if( !aipInfo.exists() )
+        return false;
+
+    if( indexInfo.exists() && (indexInfo.lastModified() >= aipInfo.lastModified()) )
+    {
+        if( readIndex( qsIndex, pAirports, pAirspaces ) )
+            return true;
+    }
+
+    QFile     aipDatabase( qsAip );
+    AipParser parser;
+
+    if( !aipDatabase.open( QIODevice::ReadOnly ) )
+        return false;
+
+    while( (!aipDatabase.atEnd()) && (!parser.hasError()) )
+        parser.addData( aipDatabase.read( 65536 ) );
+    aipDatabase.close();
+
+    // A file cut short parses cleanly right up to where it stops, so only a document that got all the way to its end
+    // is good enough to load and to leave an index behind for
+    if( parser.hasError() || (!parser.isComplete()) )
+    {
+        qDebug() << "Incomplete AIP file" << qsAip;
+        return false;
+    }
+
+    QList<Airport>  airports = parser.takeAirports();
+    QList<Airspace> airspaces = parser.takeAirspaces();
+
+    writeIndex( qsIndex, airports, airspaces );
+
+    if( pAirports != nullptr )
+        pAirports->append( airports );
+    if( pAirspaces != nullptr )
+        pAirspaces->append( airspaces );
+
+    return true;
+}
+
+
+QString AipParser::indexPath( const QString &qsAip )
+{
+    QString qsIndex = qsAip;
+
+    if( qsIndex.endsWith( ".aip" ) )
+        qsIndex.chop( 4 );
+
+    return qsIndex + ".idx";
+}
+
+
+bool AipParser::readIndex( const QString &qsIndex, QList<Airport> *pAirports, QList<Airspace> *pAirspaces )
+{
+    QFile   indexFile( qsIndex );
+    quint32 uiMagic, uiVersion;
+    qint32  iCount, iFreqCount, iType;
+    int     i, iFreq;
+
+    if( !indexFile.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream in( &indexFile );
+
+    in.setVersion( QDataStream::Qt_5_0 );
+    in >> uiMagic >> uiVersion;
+    if( (uiMagic != g_uiIndexMagic) || (uiVersion != g_uiIndexVersion) )
+        return false;
+
+    QList<Airport>  airports;
+    QList<Airspace> airspaces;
+
+    in >> iCount;
+    for( i = 0; (i < iCount) && (in.status() == QDataStream::Ok); i++ )
+    {
+        Airport ap;
+
+        in >> ap.qsID >> ap.qsName >> ap.dLat >> ap.dLong >> ap.dElev >> ap.bGrass >> ap.runways >> iFreqCount;
+        for( iFreq = 0; iFreq < iFreqCount; iFreq++ )
+        {
+            Frequency f;
+
+            in >> f.dFreq >> f.qsDescription;
+            ap.frequencies.append( f );
+        }
+        ap.bd.dBearing = 0.0;
+        ap.bd.dDistance = 0.0;
+        airports.append( ap );
+    }
+
+    in >> iCount;
+    for( i = 0; (i < iCount) && (in.status() == QDataStream::Ok); i++ )
+    {
+        Airspace as;
+
+        in >> iType >> as.qsName >> as.iAltTop >> as.iAltBottom >> as.shape;
+        as.eType = static_cast<Canvas::AirspaceType>( iType );
+        airspaces.append( as );
+    }
+
+    // A truncated index is as good as none; the caller falls back to the XML
+    if( in.status() != QDataStream::Ok )
+        return false;
+
+    if( pAirports != nullptr )
+        pAirports->append( airports );
+    if( pAirspaces != nullptr )
+        pAirspaces->append( airspaces );
+
+    return true;
+}
+
+
+bool AipParser::writeIndex( const QString &qsIndex, const QList<Airport> &airports, const QList<Airspace> &airspaces )
+{
+    QSaveFile indexFile( qsIndex );
+    Airport   ap;
+    Airspace  as;
+    Frequency f;
+
+    if( !indexFile.open( QIODevice::WriteOnly ) )
+        return false;
+
+    QDataStream out( &indexFile );
+
+    out.setVersion( QDataStream::Qt_5_0 );
+    out << g_uiIndexMagic << g_uiIndexVersion;
+
+    out << static_cast<qint32>( airports.count() );
+    foreach( ap, airports )
+    {
+        out << ap.qsID << ap.qsName << ap.dLat << ap.dLong << ap.dElev << ap.bGrass << ap.runways << static_cast<qint32>( ap.frequencies.count() );
+        foreach( f, ap.frequencies )
+            out << f.dFreq << f.qsDescription;
+    }
+
+    out << static_cast<qint32>( airspaces.count() );
+    foreach( as, airspaces )
+        out << static_cast<qint32>( as.eType ) << as.qsName << as.iAltTop << as.iAltBottom << as.shape;
+
+    return indexFile.commit();
+}
@@ -0,0 +1,218 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+
+#include "AirportCache.h"
+
+
+AirportCache::AirportCache()
+{
+}
+
+
+void AirportCache::clear()
+{
+    m_records.clear();
+    m_runways.clear();
+    m_frequencies.clear();
+    m_pool.clear();
+    m_strings.clear();
+}
+
+
+// Flatten an airport into the shared arrays
+void AirportCache::append( const Airport &ap )
+{
+    AirportRecord rec;
+    Frequency     f;
+    int           i;
+
+    rec.dLat = ap.dLat;
+    rec.dLong = ap.dLong;
+    rec.fElev = static_cast<float>( ap.dElev );
+    rec.bGrass = ap.bGrass;
+    rec.uiID = addString( ap.qsID, &rec.ucIDLen );
+    rec.uiName = addString( ap.qsName, &rec.ucNameLen );
+
+    rec.uiRunway = static_cast<quint32>( m_runways.count() );
+    rec.ucRunwayCount = static_cast<quint8>( qMin( ap.runways.count(), 255 ) );
+    for( i = 0; i < rec.ucRunwayCount; i++ )
+        m_runways.append( static_cast<qint16>( ap.runways.at( i ) ) );
+
+    rec.uiFrequency = static_cast<quint32>( m_frequencies.count() );
+    rec.ucFrequencyCount = static_cast<quint8>( qMin( ap.frequencies.count(), 255 ) );
+    for( i = 0; i < rec.ucFrequencyCount; i++ )
+    {
+        FrequencyRecord freq;
+
+        f = ap.frequencies.at( i );
+        freq.dFreq = f.dFreq;
+        freq.uiDescription = addString( f.qsDescription, &freq.ucDescriptionLen );
+        m_frequencies.append( freq );
+    }
+
+    m_records.append( rec );
+}
+
+
+// Give back the growth slack once everything is loaded; the lookup for pooling strings is only needed while building
+void AirportCache::squeeze()
+{
+    m_records.squeeze();
+    m_runways.squeeze();
+    m_frequencies.squeeze();
+    m_pool.squeeze();
+    m_strings.clear();
+    m_strings.squeeze();
+}
+
+
+// Each distinct string goes in the pool once; frequency descriptions especially ("TOWER", "GROUND", "CTAF") repeat for
+// nearly every airport. Nothing in the OpenAIP data comes close to 255 bytes but clip it anyway so the length fits the
+// record, backing up so a multi-byte character isn't split.
+quint32 AirportCache::addString( const QString &qs, quint8 *pLen )
+{
+    QByteArray utf8 = qs.toUtf8();
+    quint32    uiOffset;
+
+    if( utf8.size() > 255 )
+    {
+        int iLen = 255;
+
+        while( (iLen > 0) && ((static_cast<quint8>( utf8.at( iLen ) ) & 0xC0) == 0x80) )
+            iLen--;
+        utf8.truncate( iLen );
+    }
+    *pLen = static_cast<quint8>( utf8.size() );
+
+    QHash<QByteArray, quint32>::const_iterator it = m_strings.constFind( utf8 );
+
+    if( it != m_strings.constEnd() )
+        return it.value();
+
+    uiOffset = static_cast<quint32>( m_pool.size() );
+    m_pool.append( utf8 );
+    m_strings.insert( utf8, uiOffset );
+
+    return uiOffset;
+}
+
+
+QString AirportCache::string( quint32 uiOffset, quint8 ucLen ) const
+{
+    return QString::fromUtf8( m_pool.constData() + uiOffset, ucLen );
+}
+
+
+const AirportRecord &AirportView::record() const
+{
+    return m_pCache->m_records.at( m_iIndex );
+}
+
+
+double AirportView::lat() const
+{
+    return record().dLat;
+}
+
+
+double AirportView::lon() const
+{
+    return record().dLong;
+}
+
+
+double AirportView::elev() const
+{
+    return static_cast<double>( record().fElev );
+}
+
+
+bool AirportView::grass() const
+{
+    return record().bGrass;
+}
+
+
+// Airports with no ICAO ID are stored as "R"
+bool AirportView::isPrivate() const
+{
+    const AirportRecord &rec = record();
+
+    return (rec.ucIDLen == 1) && (m_pCache->m_pool.at( rec.uiID ) == 'R');
+}
+
+
+// IDs are plain ASCII so this compares in place without building a QString
+bool AirportView::hasID( const QString &qsID ) const
+{
+    const AirportRecord &rec = record();
+
+    return qsID == QLatin1String( m_pCache->m_pool.constData() + rec.uiID, rec.ucIDLen );
+}
+
+
+QString AirportView::id() const
+{
+    return m_pCache->string( record().uiID, record().ucIDLen );
+}
+
+
+QString AirportView::name() const
+{
+    return m_pCache->string( record().uiName, record().ucNameLen );
+}
+
+
+int AirportView::runwayCount() const
+{
+    return record().ucRunwayCount;
+}
+
+
+int AirportView::runway( int iRunway ) const
+{
+    return m_pCache->m_runways.at( static_cast<int>( record().uiRunway ) + iRunway );
+}
+
+
+int AirportView::frequencyCount() const
+{
+    return record().ucFrequencyCount;
+}
+
+
+// Materialize the full struct for the nearby list and the dialogs that still work with Airport
+Airport AirportView::toAirport() const
+{
+    const AirportRecord &rec = record();
+    Airport              ap;
+    int                  i;
+
+    ap.qsID = id();
+    ap.qsName = name();
+    ap.dLat = rec.dLat;
+    ap.dLong = rec.dLong;
+    ap.dElev = static_cast<double>( rec.fElev );
+    ap.bGrass = rec.bGrass;
+    ap.bd.dBearing = 0.0;
+    ap.bd.dDistance = 0.0;
+
+    for( i = 0; i < rec.ucRunwayCount; i++ )
+        ap.runways.append( m_pCache->m_runways.at( static_cast<int>( rec.uiRunway ) + i ) );
+
+    for( i = 0; i < rec.ucFrequencyCount; i++ )
+    {
+        const FrequencyRecord &freq = m_pCache->m_frequencies.at( static_cast<int>( rec.uiFrequency ) + i );
+        Frequency              f;
+
+        f.dFreq = freq.dFreq;
+        f.qsDescription = m_pCache->string( freq.uiDescription, freq.ucDescriptionLen );
+        ap.frequencies.append( f );
+    }
+
+    return ap;
+}
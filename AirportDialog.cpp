@@ -10,9 +10,10 @@ Stratofier Stratux AHRS Display
 #include "AirportDialog.h"
 #include "TrafficMath.h"
 #include "StratuxStreams.h"
+#include "AirportCache.h"
 
 
-extern QList<Airport>   g_airportCache;
+extern AirportCache     g_airportCache;
 extern StratuxSituation g_situation;
 
 
@@ -29,6 +30,9 @@ AirportDialog::AirportDialog( QWidget *pParent, CanvasConstants *pC, const QStri
 
     m_pCancelButton->setMinimumHeight( static_cast<int>( pC->dH10 ) );
 
+    m_pSearchLabel->setFullKeyboard( true );
+    m_pSearchLabel->setTop( false );
+
     connect( m_pRange25, SIGNAL( clicked() ), this, SLOT( within() ) );
     connect( m_pRange50, SIGNAL( clicked() ), this, SLOT( within() ) );
     connect( m_pRange100, SIGNAL( clicked() ), this, SLOT( within() ) );
@@ -36,6 +40,7 @@ AirportDialog::AirportDialog( QWidget *pParent, CanvasConstants *pC, const QStri
     connect( m_pAirportsButton, SIGNAL( clicked() ), this, SLOT( airportsType() ) );
 
     connect( m_pAirportsTable, SIGNAL( itemPressed( QTableWidgetItem*) ), this, SLOT( airportSelected( QTableWidgetItem* ) ) );
+    connect( m_pSearchLabel, SIGNAL( textEdited( const QString& ) ), this, SLOT( search( const QString& ) ) );
 
     updateAirports();
 }
@@ -95,23 +100,45 @@ void AirportDialog::updateAirports()
     int          iRowHeight = static_cast<int>( static_cast<double>( lineMetric.boundingRect( "K" ).height() * 1.5 ) );
 
     // Clear the table
-    while( m_pAirportsTable->rowCount() > 0 )
-        m_pAirportsTable->removeRow( 0 );
+    m_pAirportsTable->setRowCount( 0 );
+
+    // Typing in the search box overrides the range buttons
+    if( !m_pSearchLabel->text().isEmpty() )
+    {
+        QList<int> results = TrafficMath::searchAirports( m_pSearchLabel->text(), 100 );
+        int        iAirport;
 
-    // Populate the table
-    foreach( ap, g_airportCache )
+        foreach( iAirport, results )
+        {
+            AirportView view = g_airportCache.at( iAirport );
+
+            if( m_bAllAirports || (!view.isPrivate()) )
+            {
+                ap = view.toAirport();
+                ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+                addAirportRow( ap, iRowHeight );
+            }
+        }
+    }
+    else
     {
-        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+        BearingDist bd;
 
-        if( ap.bd.dDistance <= m_dDist )
+        // Populate the table
+        for( int i = 0; i < g_airportCache.count(); i++ )
         {
-            if( m_bAllAirports || ((!m_bAllAirports) && (ap.qsID != "R")) )
+            AirportView view = g_airportCache.at( i );
+
+            bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, view.lat(), view.lon() );
+
+            if( bd.dDistance <= m_dDist )
             {
-                m_pAirportsTable->setRowCount( m_pAirportsTable->rowCount() + 1 );
-                m_pAirportsTable->setRowHeight( m_pAirportsTable->rowCount() - 1, iRowHeight );
-                m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 0, new QTableWidgetItem( ap.qsName ) );
-                m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 1, new QTableWidgetItem( "  " + ap.qsID ) );
-                m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 2, new QTableWidgetItem( QString( "  %1" ).arg( static_cast<int>( ap.bd.dDistance ), 3, 10, QChar( '0' ) ) ) );
+                if( m_bAllAirports || ((!m_bAllAirports) && (!view.isPrivate())) )
+                {
+                    ap = view.toAirport();
+                    ap.bd = bd;
+                    addAirportRow( ap, iRowHeight );
+                }
             }
         }
     }
@@ -126,6 +153,26 @@ void AirportDialog::updateAirports()
 }
 
 
+void AirportDialog::addAirportRow( const Airport &ap, int iRowHeight )
+{
+    int iRow = m_pAirportsTable->rowCount();
+
+    m_pAirportsTable->setRowCount( iRow + 1 );
+    m_pAirportsTable->setRowHeight( iRow, iRowHeight );
+    m_pAirportsTable->setItem( iRow, 0, new QTableWidgetItem( ap.qsName ) );
+    m_pAirportsTable->setItem( iRow, 1, new QTableWidgetItem( "  " + ap.qsID ) );
+    m_pAirportsTable->setItem( iRow, 2, new QTableWidgetItem( QString( "  %1" ).arg( static_cast<int>( ap.bd.dDistance ), 3, 10, QChar( '0' ) ) ) );
+}
+
+
+void AirportDialog::search( const QString &qsSearch )
+{
+    Q_UNUSED( qsSearch )
+
+    updateAirports();
+}
+
+
 void AirportDialog::airportsType()
 {
     m_bAllAirports = (!m_bAllAirports);
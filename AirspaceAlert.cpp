@@ -0,0 +1,228 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QTimerEvent>
+#include <QAtomicInt>
+
+#include <math.h>
+#include <algorithm>
+
+#include "AirspaceAlert.h"
+#include "StratuxStreams.h"
+#include "StratofierDefs.h"
+
+
+extern QList<Airspace>  g_airspaceCache;
+extern bool             g_bNoAirportsUpdate;
+extern QAtomicInt       g_iAirspaceCacheGen;
+extern StratuxSituation g_situation;
+extern Canvas::Units    g_eUnitsAirspeed;
+
+
+// Look ahead times along the GPS track
+static const int g_iAlertMinutes[] = { 1, 2, 5 };
+static const int g_iAlertMinutesCount = sizeof( g_iAlertMinutes ) / sizeof( g_iAlertMinutes[0] );
+
+
+AirspaceAlert::AirspaceAlert( QObject *pParent )
+    : QObject( pParent ),
+      m_iCacheGen( 0 )
+{
+    startTimer( 1000 );
+}
+
+
+AirspaceAlert::~AirspaceAlert()
+{
+}
+
+
+// Once a second; this deliberately lives outside the paint path which only reads the results
+void AirspaceAlert::timerEvent( QTimerEvent *pEvent )
+{
+    if( pEvent == nullptr )
+        return;
+
+    if( (!g_bNoAirportsUpdate) && (g_iAirspaceCacheGen.load() != m_iCacheGen) )
+        rebuild();
+
+    evaluate();
+}
+
+
+// Pull the airspace types worth warning about out of the cache and bucket their edges
+void AirspaceAlert::rebuild()
+{
+    Airspace as;
+    int      i, iBand, iFirst, iLast, iCount, iBands;
+    double   dY1, dY2;
+
+    m_iCacheGen = g_iAirspaceCacheGen.load();
+    m_zones.clear();
+
+    foreach( as, g_airspaceCache )
+    {
+        if( (as.eType != Canvas::Airspace_Restricted) &&
+            (as.eType != Canvas::Airspace_Prohibited) &&
+            (as.eType != Canvas::Airspace_TFR) &&
+            (as.eType != Canvas::Airspace_Class_B) )
+            continue;
+
+        iCount = as.shape.count();
+        if( iCount < 3 )
+            continue;
+
+        AlertZone zone;
+
+        zone.eType = as.eType;
+        zone.qsName = as.qsName;
+        zone.iAltTop = as.iAltTop;
+        zone.iAltBottom = as.iAltBottom;
+        zone.shape = as.shape;
+        zone.bounds = as.shape.boundingRect();
+
+        // Roughly four edges per band keeps the buckets small without making the table huge for big arcs
+        iBands = qBound( 1, iCount / 4, 256 );
+        zone.dBandHeight = zone.bounds.height() / static_cast<double>( iBands );
+        if( zone.dBandHeight <= 0.0 )
+            continue;
+        zone.bands.resize( iBands );
+
+        for( i = 0; i < iCount; i++ )
+        {
+            dY1 = zone.shape.at( i ).y();
+            dY2 = zone.shape.at( (i + 1) % iCount ).y();
+            iFirst = qBound( 0, static_cast<int>( (qMin( dY1, dY2 ) - zone.bounds.top()) / zone.dBandHeight ), iBands - 1 );
+            iLast = qBound( 0, static_cast<int>( (qMax( dY1, dY2 ) - zone.bounds.top()) / zone.dBandHeight ), iBands - 1 );
+            for( iBand = iFirst; iBand <= iLast; iBand++ )
+                zone.bands[iBand].append( i );
+        }
+
+        m_zones.append( zone );
+    }
+}
+
+
+// Even-odd ray cast against only the edges that share the point's latitude band
+bool AirspaceAlert::contains( const AlertZone &zone, const QPointF &pt )
+{
+    if( !zone.bounds.contains( pt ) )
+        return false;
+
+    int  iBand = qBound( 0, static_cast<int>( (pt.y() - zone.bounds.top()) / zone.dBandHeight ), zone.bands.count() - 1 );
+    int  iCount = zone.shape.count();
+    bool bInside = false;
+    int  i;
+
+    foreach( i, zone.bands.at( iBand ) )
+    {
+        const QPointF &p1 = zone.shape.at( i );
+        const QPointF &p2 = zone.shape.at( (i + 1) % iCount );
+
+        if( ((p1.y() > pt.y()) != (p2.y() > pt.y())) &&
+            (pt.x() < (((p2.x() - p1.x()) * (pt.y() - p1.y()) / (p2.y() - p1.y())) + p1.x())) )
+            bInside = (!bInside);
+    }
+
+    return bInside;
+}
+
+
+// Test where we are now and where we'll be along the current track against each zone and its altitude band
+void AirspaceAlert::evaluate()
+{
+    QList<AirspaceAlertState> alerts;
+
+    if( (g_situation.dGPSlat != 0.0) && (g_situation.dGPSlong != 0.0) )
+    {
+        double    dKnots = knots( g_situation.dGPSGroundSpeed );
+        double    dTrack = g_situation.dGPSTrueCourse * ToRad;
+        double    dLongScale = cos( g_situation.dGPSlat * ToRad );
+        QPointF   pts[g_iAlertMinutesCount + 1];
+        double    dAlts[g_iAlertMinutesCount + 1];
+        AlertZone zone;
+        int       i;
+
+        if( dLongScale < 0.01 )
+            dLongScale = 0.01;
+
+        pts[0] = QPointF( g_situation.dGPSlong, g_situation.dGPSlat );
+        dAlts[0] = g_situation.dBaroPressAlt;
+        // Flat earth is plenty accurate for five minutes worth of travel
+        for( i = 0; i < g_iAlertMinutesCount; i++ )
+        {
+            double dNM = dKnots * static_cast<double>( g_iAlertMinutes[i] ) / 60.0;
+
+            pts[i + 1] = QPointF( g_situation.dGPSlong + (dNM * sin( dTrack ) / (60.0 * dLongScale)),
+                                  g_situation.dGPSlat + (dNM * cos( dTrack ) / 60.0) );
+            dAlts[i + 1] = g_situation.dBaroPressAlt + (g_situation.dGPSVertSpeed * static_cast<double>( g_iAlertMinutes[i] ));
+        }
+
+        foreach( zone, m_zones )
+        {
+            for( i = 0; i <= g_iAlertMinutesCount; i++ )
+            {
+                // A zero top means OpenAIP didn't give us one so treat it as unlimited
+                if( (dAlts[i] < static_cast<double>( zone.iAltBottom )) || ((zone.iAltTop > 0) && (dAlts[i] > static_cast<double>( zone.iAltTop ))) )
+                    continue;
+
+                if( contains( zone, pts[i] ) )
+                {
+                    AirspaceAlertState state;
+
+                    state.qsName = zone.qsName;
+                    state.eType = zone.eType;
+                    state.iMinutes = (i == 0) ? 0 : g_iAlertMinutes[i - 1];
+                    alerts.append( state );
+                    break;
+                }
+            }
+        }
+
+        // Most urgent first
+        std::sort( alerts.begin(), alerts.end(), []( const AirspaceAlertState &a, const AirspaceAlertState &b ) { return a.iMinutes < b.iMinutes; } );
+    }
+
+    bool bChanged = (alerts.count() != m_alerts.count());
+
+    for( int i = 0; (!bChanged) && (i < alerts.count()); i++ )
+        bChanged = ((alerts.at( i ).qsName != m_alerts.at( i ).qsName) || (alerts.at( i ).iMinutes != m_alerts.at( i ).iMinutes));
+
+    m_alerts = alerts;
+
+    if( bChanged )
+        emit alertsChanged();
+}
+
+
+// Copied into the map layer jobs so the airspace worker never looks at the alert list itself
+QStringList AirspaceAlert::alertedNames()
+{
+    AirspaceAlertState state;
+    QStringList        names;
+
+    foreach( state, m_alerts )
+        names.append( state.qsName );
+
+    return names;
+}
+
+
+// Ground speed arrives in whatever units are selected for display
+double AirspaceAlert::knots( double dSpeed )
+{
+    switch( g_eUnitsAirspeed )
+    {
+        case Canvas::MPH:
+            return dSpeed / KnotsToMPH;
+        case Canvas::KPH:
+            return dSpeed / KnotsToKPH;
+        default:
+            break;
+    }
+
+    return dSpeed;
+}
@@ -0,0 +1,195 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QSvgRenderer>
+#include <QPainter>
+
+#include "AssetCache.h"
+#include "Builder.h"
+
+
+// Cost is in pixels; enough for both orientations' worth of tapes and dials
+static QCache<QString, QImage> g_assetCache( 8 * 1024 * 1024 );
+static QHash<QString, QString> g_assetHashes;
+static QMutex                  g_assetMutex;
+
+
+// Artwork that has an SVG version next to the PNG is rendered from that at exactly the size asked for instead
+QImage AssetCache::scaled( const QString &qsResource, const QSize &size, bool bScale )
+{
+    QString qsVector = vectorResource( qsResource );
+    QString qsKey = QString( "%1-%2x%3" ).arg( resourceHash( qsVector.isEmpty() ? qsResource : qsVector ) ).arg( size.width() ).arg( size.height() );
+    QImage  image = lookup( qsKey );
+
+    if( (!image.isNull()) || (!bScale) )
+        return image;
+
+    if( !qsVector.isEmpty() )
+    {
+        image = render( qsVector, size );
+        if( !image.isNull() )
+        {
+            store( qsKey, image );
+            return image;
+        }
+    }
+
+    image = QImage( qsResource );
+    if( image.isNull() )
+    {
+        qDebug() << "Cannot load asset" << qsResource;
+        return image;
+    }
+
+    if( size.height() == 0 )
+        image = image.scaledToWidth( size.width(), Qt::SmoothTransformation );
+    else
+        image = image.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+    image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    store( qsKey, image );
+
+    return image;
+}
+
+
+// Memory first, then the copy on disk
+QImage AssetCache::lookup( const QString &qsKey )
+{
+    {
+        QMutexLocker lock( &g_assetMutex );
+        QImage      *pCached = g_assetCache.object( qsKey );
+
+        if( pCached != nullptr )
+            return *pCached;
+    }
+
+    QImage image( cacheFile( qsKey ) );
+
+    if( image.isNull() )
+        return image;
+
+    image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+
+    QMutexLocker lock( &g_assetMutex );
+
+    g_assetCache.insert( qsKey, new QImage( image ), image.width() * image.height() );
+
+    return image;
+}
+
+
+// The file is swapped in whole so a launch that's killed mid-write can't leave a truncated image behind
+void AssetCache::store( const QString &qsKey, const QImage &image )
+{
+    {
+        QMutexLocker lock( &g_assetMutex );
+
+        g_assetCache.insert( qsKey, new QImage( image ), image.width() * image.height() );
+    }
+
+    QString   qsFile = cacheFile( qsKey );
+    QSaveFile file( qsFile );
+
+    QDir().mkpath( QFileInfo( qsFile ).path() );
+    if( !(file.open( QIODevice::WriteOnly ) && image.save( &file, "PNG" ) && file.commit()) )
+        qDebug() << "Cannot write asset cache" << qsFile;
+}
+
+
+// Resources are compiled in so this only changes with a new build, but it's cheaper to hash once than to keep asking
+QString AssetCache::resourceHash( const QString &qsResource )
+{
+    {
+        QMutexLocker lock( &g_assetMutex );
+
+        if( g_assetHashes.contains( qsResource ) )
+            return g_assetHashes.value( qsResource );
+    }
+
+    QFile   resource( qsResource );
+    QString qsHash;
+
+    if( resource.open( QIODevice::ReadOnly ) )
+        qsHash = QString( QCryptographicHash::hash( resource.readAll(), QCryptographicHash::Md5 ).toHex().left( 16 ) );
+
+    QMutexLocker lock( &g_assetMutex );
+
+    g_assetHashes.insert( qsResource, qsHash );
+
+    return qsHash;
+}
+
+
+QString AssetCache::resourceHash( const QStringList &resources )
+{
+    QString qsResource, qsHashes;
+
+    foreach( qsResource, resources )
+        qsHashes.append( resourceHash( qsResource ) );
+
+    return QString( QCryptographicHash::hash( qsHashes.toLatin1(), QCryptographicHash::Md5 ).toHex().left( 16 ) );
+}
+
+
+QString AssetCache::vectorResource( const QString &qsResource )
+{
+    QString qsVector = qsResource;
+
+    if( !qsVector.endsWith( ".png" ) )
+        return QString();
+
+    qsVector.chop( 4 );
+    qsVector.append( ".svg" );
+
+    return QFile::exists( qsVector ) ? qsVector : QString();
+}
+
+
+// The drawing is stretched to fill the size the same way the PNG would have been scaled
+QImage AssetCache::render( const QString &qsVector, const QSize &size )
+{
+    QSvgRenderer svg( qsVector );
+    QSize        renderSize = size;
+
+    if( !svg.isValid() )
+    {
+        qDebug() << "Cannot load vector asset" << qsVector;
+        return QImage();
+    }
+
+    if( renderSize.height() == 0 )
+        renderSize.setHeight( qRound( static_cast<double>( size.width() ) * svg.viewBoxF().height() / svg.viewBoxF().width() ) );
+
+    QImage image( renderSize, QImage::Format_ARGB32_Premultiplied );
+
+    image.fill( Qt::transparent );
+
+    QPainter vector( &image );
+
+    vector.setRenderHint( QPainter::Antialiasing, true );
+    svg.render( &vector, QRectF( QPointF( 0.0, 0.0 ), QSizeF( renderSize ) ) );
+    vector.end();
+
+    return image;
+}
+
+
+QString AssetCache::cacheFile( const QString &qsKey )
+{
+    QString qsFile;
+
+    Builder::getStorage( &qsFile );
+
+    return qsFile + QString( "/data/space.skyfun.stratofier/assets/%1.png" ).arg( qsKey );
+}
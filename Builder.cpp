@@ -4,6 +4,8 @@ Stratofier Stratux AHRS Display
 */
 
 #include <QPixmap>
+#include <QImage>
+#include <QMutex>
 #include <QPainter>
 #include <QProcess>
 #include <QtDebug>
@@ -26,58 +28,144 @@ Builder::Builder()
 }
 
 
-void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, int iNum, int iFieldWidth )
+// Every digit image is decoded and scaled once per screen geometry instead of once per digit per frame.
+// The atlas is a QImage so it can be drawn from any thread; the normal digits and colon are on the first row,
+// the bold digits on the second and the smaller bold digits used after a decimal point on the third.
+static QImage  g_glyphAtlas;
+static double  g_dAtlasWNum = 0.0;
+static double  g_dAtlasHNum = 0.0;
+static QMutex  g_atlasMutex;
+
+
+void Builder::buildGlyphAtlas( CanvasConstants *c )
 {
-    pNumber->fill( Qt::transparent );
+    QMutexLocker lock( &g_atlasMutex );
 
-    QPainter numPainter( pNumber );
-    QString  qsNum = QString( "%1" ).arg( iNum, iFieldWidth, 10, QChar( '0' ) );
-    QChar    cNum;
-    int      iX = 0;
+    buildGlyphAtlasLocked( c );
+}
 
-    foreach( cNum, qsNum )
+
+// Caller holds g_atlasMutex
+void Builder::buildGlyphAtlasLocked( CanvasConstants *c )
+{
+    int iFull = static_cast<int>( c->dWNum );
+    int iFullH = static_cast<int>( c->dHNum );
+    int iHalf = static_cast<int>( c->dWNum / 1.5 );
+    int iHalfH = static_cast<int>( c->dHNum / 1.5 );
+    int iGlyph;
+
+    if( (iFull <= 0) || (iFullH <= 0) )
+        return;
+
+    QImage atlas( iFull * 11, iFullH * 3, QImage::Format_ARGB32_Premultiplied );
+
+    atlas.fill( Qt::transparent );
+
+    QPainter atlasPainter( &atlas );
+
+    atlasPainter.setRenderHint( QPainter::SmoothPixmapTransform, true );
+    for( iGlyph = 0; iGlyph < 11; iGlyph++ )
+    {
+        QImage glyph( (iGlyph == 10) ? QString( ":/num/resources/colon.png" ) : QString( ":/num/resources/%1.png" ).arg( iGlyph ) );
+
+        atlasPainter.drawImage( QRect( iGlyph * iFull, 0, iFull, iFullH ), glyph );
+    }
+    for( iGlyph = 0; iGlyph < 10; iGlyph++ )
     {
-        QPixmap num( QString( ":/num/resources/%1.png" ).arg( cNum ) );
+        QImage glyph( QString( ":/num/resources/%1b.png" ).arg( iGlyph ) );
 
-        numPainter.drawPixmap( iX, 0, c->dWNum, c->dHNum, num );
-        iX += static_cast<int>( c->dWNum );
+        atlasPainter.drawImage( QRect( iGlyph * iFull, iFullH, iFull, iFullH ), glyph );
+        atlasPainter.drawImage( QRect( iGlyph * iFull, iFullH * 2, iHalf, iHalfH ), glyph );
     }
+    atlasPainter.end();
+
+    g_glyphAtlas = atlas;
+    g_dAtlasWNum = c->dWNum;
+    g_dAtlasHNum = c->dHNum;
+}
+
+
+// Hands back a shallow copy so the atlas can be rebuilt on an orientation change while another thread is still drawing from the old one
+QImage Builder::glyphAtlas( CanvasConstants *c )
+{
+    QMutexLocker lock( &g_atlasMutex );
+
+    if( g_glyphAtlas.isNull() || (g_dAtlasWNum != c->dWNum) || (g_dAtlasHNum != c->dHNum) )
+        buildGlyphAtlasLocked( c );
+
+    return g_glyphAtlas;
+}
+
+
+// Atlas column for a character or -1 if there's no glyph for it (a minus sign for instance just leaves a gap like it always has)
+static int glyphColumn( const QChar &cNum, bool bColon )
+{
+    if( cNum.isDigit() )
+        return cNum.digitValue();
+    if( bColon && (cNum == ':') )
+        return 10;
+
+    return -1;
+}
+
+
+void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, int iNum, int iFieldWidth )
+{
+    buildNumber( pNumber, c, QString( "%1" ).arg( iNum, iFieldWidth, 10, QChar( '0' ) ) );
 }
 
 
 void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, const QString &qsNum )
 {
     pNumber->fill( Qt::transparent );
+    paintNumber( pNumber, c, qsNum );
+}
+
+
+// Image version for drawing off the GUI thread where pixmaps can't be used
+void Builder::buildNumber( QImage *pNumber, CanvasConstants *c, int iNum, int iFieldWidth )
+{
+    pNumber->fill( Qt::transparent );
+    paintNumber( pNumber, c, QString( "%1" ).arg( iNum, iFieldWidth, 10, QChar( '0' ) ) );
+}
 
+
+void Builder::paintNumber( QPaintDevice *pNumber, CanvasConstants *c, const QString &qsNum )
+{
+    QImage   atlas = glyphAtlas( c );
     QPainter numPainter( pNumber );
     QChar    cNum;
     int      iX = 0;
-    QString  qsDigit;
+    int      iFull = static_cast<int>( c->dWNum );
+    int      iFullH = static_cast<int>( c->dHNum );
+    int      iCol;
 
     foreach( cNum, qsNum )
     {
-        if( cNum == ':' )
-            qsDigit = ":/num/resources/colon.png";
-        else
-            qsDigit = QString( ":/num/resources/%1.png" ).arg( cNum );
-        QPixmap num( qsDigit );
-        numPainter.drawPixmap( iX, 0, c->dWNum, c->dHNum, num );
-        iX += static_cast<int>( c->dWNum );
+        iCol = glyphColumn( cNum, true );
+        if( iCol >= 0 )
+            numPainter.drawImage( iX, 0, atlas, iCol * iFull, 0, iFull, iFullH );
+        iX += iFull;
     }
 }
 
 
-void Builder::buildNumber(QPixmap *pNumber, CanvasConstants *c, double dNum, int iPrec )
+void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, double dNum, int iPrec )
 {
     pNumber->fill( Qt::transparent );
 
+    QImage   atlas = glyphAtlas( c );
     QPainter numPainter( pNumber );
     QString  qsNum = QString::number( dNum, 'f', iPrec );
     QChar    cNum;
     int      iX = 0;
     bool     bMantissa = false;
     int      iFull = static_cast<int>( c->dWNum );
+    int      iFullH = static_cast<int>( c->dHNum );
     int      iHalf = static_cast<int>( c->dWNum / 1.5 );
+    int      iHalfH = static_cast<int>( c->dHNum / 1.5 );
+    int      iMantissaY = static_cast<int>( (c->dHNum * 0.25) - 1.0 );
+    int      iCol;
 
     foreach( cNum, qsNum )
     {
@@ -87,9 +175,14 @@ void Builder::buildNumber(QPixmap *pNumber, CanvasConstants *c, double dNum, int
             continue;
         }
 
-        QPixmap num( QString( ":/num/resources/%1b.png" ).arg( cNum ) );
-
-        numPainter.drawPixmap( static_cast<double>( iX ), bMantissa ? (c->dHNum * 0.25) - 1.0 : 0.0, (bMantissa ? c->dWNum / 1.5 : c->dWNum), (bMantissa ? c->dHNum / 1.5 : c->dHNum), num );
+        iCol = glyphColumn( cNum, false );
+        if( iCol >= 0 )
+        {
+            if( bMantissa )
+                numPainter.drawImage( iX, iMantissaY, atlas, iCol * iFull, iFullH * 2, iHalf, iHalfH );
+            else
+                numPainter.drawImage( iX, 0, atlas, iCol * iFull, iFullH, iFull, iFullH );
+        }
         iX += (bMantissa ? iHalf : iFull);
     }
 }
@@ -6,6 +6,7 @@ Stratofier Stratux AHRS Display
 #include <QFont>
 #include <QFontMetrics>
 #include <QRect>
+#include <QPainterPath>
 #include <QSettings>
 
 #include "Canvas.h"
@@ -98,6 +99,69 @@ void Canvas::init( double dWidth, double dHeight, bool bPortrait )
         m_preCalc.dHeadDiam = m_preCalc.dH - m_preCalc.dH5;
 
     m_preCalc.dHeadDiam2 = m_preCalc.dHeadDiam / 2.0;
+
+    initLayout();
+}
+
+
+// Only depends on the constants so it's redone whenever they are (on every orientation or size change)
+void Canvas::initLayout()
+{
+    CanvasConstants *c = &m_preCalc;
+    double           dDialX = (c->bPortrait ? 0.0 : c->dW) + c->dW2;
+    double           dDialTop = c->dH - 10.0 - c->dHeadDiam;
+
+    m_layout.headCenter = QPointF( dDialX, c->dH - 10.0 - c->dHeadDiam2 );
+    m_layout.headRect = QRectF( dDialX - c->dHeadDiam2, dDialTop, c->dHeadDiam, c->dHeadDiam );
+    m_layout.mapRect = m_layout.headRect.toAlignedRect().adjusted( -2, -2, 2, 2 );
+
+    m_layout.headClip = QPainterPath();
+    m_layout.headClip.addEllipse( m_layout.headCenter, c->dHeadDiam2, c->dHeadDiam2 );
+
+    m_layout.headMask = QPainterPath();
+    if( c->bPortrait )
+    {
+        m_layout.headMask.addRect( 0.0, 0.0, c->dW, c->dH );
+        m_layout.headMask = m_layout.headMask.subtracted( m_layout.headClip );
+    }
+
+    // Portrait stops the attitude at the bottom of the fuel indicators; landscape has the whole left half
+    if( c->bPortrait )
+        m_layout.attitudeClip = QRectF( 0.0, 0.0, c->dW, c->dH2 + c->dH5 );
+    else
+        m_layout.attitudeClip = QRectF( 0.0, 0.0, c->dW, c->dH );
+    m_layout.speedTapeClip = QRectF( 2.0, 2.0, c->dW5 - 4.0, c->dH2 + c->dH4 );
+
+    m_layout.headArrow.clear();
+    m_layout.headArrow.append( QPointF( dDialX, dDialTop - c->dH80 ) );
+    m_layout.headArrow.append( QPointF( dDialX + c->dW40, dDialTop - c->dH40 ) );
+    m_layout.headArrow.append( QPointF( dDialX - c->dW40, dDialTop - c->dH40 ) );
+
+    m_layout.headCenterArrow.clear();
+    m_layout.headCenterArrow.append( QPointF( dDialX, m_layout.headCenter.y() - c->dH80 ) );
+    m_layout.headCenterArrow.append( QPointF( dDialX + c->dW40, m_layout.headCenter.y() - c->dH40 ) );
+    m_layout.headCenterArrow.append( QPointF( dDialX - c->dW40, m_layout.headCenter.y() - c->dH40 ) );
+
+    m_layout.vertSpeedArrow.clear();
+    m_layout.vertSpeedArrow.append( QPoint( c->dW - scaledH( 30.0 ), 0.0 ) );
+    m_layout.vertSpeedArrow.append( QPoint( c->dW - scaledH( 20.0 ), scaledV( -7.0 ) ) );
+    m_layout.vertSpeedArrow.append( QPoint( c->dW, scaledV( -15.0 ) ) );
+    m_layout.vertSpeedArrow.append( QPoint( c->dW, scaledV( 15.0 ) ) );
+    m_layout.vertSpeedArrow.append( QPoint( c->dW - scaledH( 20.0 ), scaledV( 7.0 ) ) );
+
+    m_layout.gForceArrow.clear();
+    if( c->bPortrait )
+    {
+        m_layout.gForceArrow.append( QPoint( 1, c->dH - c->iTinyFontHeight - scaledV( 10.0 ) ) );
+        m_layout.gForceArrow.append( QPoint( scaledH( -14.0 ), c->dH - c->iTinyFontHeight - scaledV( 25.0 ) ) );
+        m_layout.gForceArrow.append( QPoint( scaledH( 16.0 ), c->dH - c->iTinyFontHeight - scaledV( 25.0 ) ) );
+    }
+    else
+    {
+        m_layout.gForceArrow.append( QPoint( 0, c->dH - c->iTinyFontHeight - 10.0 ) );
+        m_layout.gForceArrow.append( QPoint( -14.0, c->dH - c->iTinyFontHeight - 25.0 ) );
+        m_layout.gForceArrow.append( QPoint( 16.0, c->dH - c->iTinyFontHeight - 25.0 ) );
+    }
 }
 
 
@@ -107,6 +171,12 @@ CanvasConstants Canvas::constants()
 }
 
 
+const CanvasLayout &Canvas::layout()
+{
+    return m_layout;
+}
+
+
 double Canvas::scaledH( double d )
 {
     if( m_preCalc.bPortrait )
@@ -88,6 +88,7 @@ void ClickLabel::key( const QString &qsKey )
         qs.append( qsKey );
 
     setText( qs );
+    emit textEdited( qs );
 }
 
 
@@ -5,12 +5,12 @@ Stratofier Stratux AHRS Display
 
 #include <QScroller>
 #include <QListWidget>
-#include <QSettings>
 
 #include "CountryDialog.h"
+#include "SettingsStore.h"
 
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 
 CountryDialog::CountryDialog( QWidget *pParent, CanvasConstants *pC )
@@ -38,7 +38,7 @@ CountryDialog::~CountryDialog()
 
 void CountryDialog::populateCountriesAirports()
 {
-    QVariantList     countries = g_pSet->value( "CountryAirports", QVariantList() ).toList();
+    QVariantList     countries = g_pSettings->value( "CountryAirports" ).toList();
     QVariant         country;
     QListWidgetItem *pCountryItem;
 
@@ -54,7 +54,7 @@ void CountryDialog::populateCountriesAirports()
 
 void CountryDialog::populateCountriesAirspaces()
 {
-    QVariantList     countries = g_pSet->value( "CountryAirspaces", QVariantList() ).toList();
+    QVariantList     countries = g_pSettings->value( "CountryAirspaces" ).toList();
     QVariant         country;
     QListWidgetItem *pCountryItem;
 
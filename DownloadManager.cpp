@@ -0,0 +1,578 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QFile>
+#include <QCryptographicHash>
+#include <QTimerEvent>
+
+#include <stdio.h>
+
+#include "DownloadManager.h"
+#include "SettingsStore.h"
+
+
+extern SettingsStore *g_pSettings;
+
+
+static const int g_iRetryDelayMs = 2000;        // First retry; doubles for each one after
+static const int g_iMaxRetries = 3;
+
+
+DownloadManager::DownloadManager( QObject *pParent, int iMaxTransfers )
+    : QObject( pParent ),
+      m_pManager( new QNetworkAccessManager( this ) ),
+      m_pManifestReply( nullptr ),
+      m_qsBaseUrl( defaultBaseUrl() ),
+      m_iMaxTransfers( iMaxTransfers ),
+      m_bRunning( false ),
+      m_bAllOK( true ),
+      m_iDoneBytes( 0 )
+{
+}
+
+
+DownloadManager::~DownloadManager()
+{
+    cancel();
+}
+
+
+// The data server can be pointed somewhere else (a local test server for instance) with the DataUrl setting
+QString DownloadManager::defaultBaseUrl()
+{
+    QString qsBaseUrl = g_pSettings->value( "DataUrl", "http://skyfun.space/stratofier/" ).toString();
+
+    if( !qsBaseUrl.endsWith( '/' ) )
+        qsBaseUrl.append( '/' );
+
+    return qsBaseUrl;
+}
+
+
+void DownloadManager::enqueue( const QString &qsName, const QString &qsFile )
+{
+    DownloadJob job;
+
+    job.qsName = qsName;
+    job.url = QUrl( m_qsBaseUrl + "openaip_" + qsName + ".aip" );
+    job.qsFile = qsFile;
+
+    m_queue.append( job );
+}
+
+
+// The manifest comes first so every transfer can be verified; if the server doesn't have one we just go without
+void DownloadManager::start()
+{
+    if( m_bRunning )
+        return;
+
+    m_bRunning = true;
+    m_bAllOK = true;
+    m_iDoneBytes = 0;
+    m_manifest.clear();
+
+    m_pManifestReply = m_pManager->get( QNetworkRequest( QUrl( m_qsBaseUrl + "manifest.txt" ) ) );
+    connect( m_pManifestReply, SIGNAL( finished() ), this, SLOT( manifestFinished() ) );
+}
+
+
+// Partial files are left in place so the next start picks up where this one left off
+void DownloadManager::cancel()
+{
+    DownloadTransfer *pTransfer;
+    int               iTimer;
+
+    m_queue.clear();
+
+    foreach( iTimer, m_retries.keys() )
+        killTimer( iTimer );
+    m_retries.clear();
+
+    if( m_pManifestReply != nullptr )
+    {
+        m_pManifestReply->disconnect( this );
+        m_pManifestReply->abort();
+        m_pManifestReply->deleteLater();
+        m_pManifestReply = nullptr;
+    }
+
+    foreach( pTransfer, m_active )
+    {
+        if( pTransfer->pReply != nullptr )
+        {
+            pTransfer->pReply->disconnect( this );
+            pTransfer->pReply->abort();
+            pTransfer->pReply->deleteLater();
+        }
+        if( pTransfer->pFile != nullptr )
+        {
+            pTransfer->pFile->close();
+            delete pTransfer->pFile;
+        }
+        delete pTransfer;
+    }
+    m_active.clear();
+
+    m_bRunning = false;
+}
+
+
+void DownloadManager::manifestFinished()
+{
+    if( m_pManifestReply == nullptr )
+        return;
+
+    if( m_pManifestReply->error() == QNetworkReply::NoError )
+        parseManifest( m_pManifestReply->readAll() );
+    else
+        qDebug() << "No dataset manifest; downloads won't be verified" << m_pManifestReply->errorString();
+
+    m_pManifestReply->deleteLater();
+    m_pManifestReply = nullptr;
+
+    startNext();
+}
+
+
+// One dataset per line: name, size in bytes and hex SHA-256 separated by whitespace; # starts a comment
+void DownloadManager::parseManifest( const QByteArray &manifest )
+{
+    QList<QByteArray> lines = manifest.split( '\n' );
+    QByteArray        line;
+
+    foreach( line, lines )
+    {
+        line = line.simplified();
+        if( line.isEmpty() || line.startsWith( '#' ) )
+            continue;
+
+        QList<QByteArray> fields = line.split( ' ' );
+
+        if( fields.count() < 3 )
+            continue;
+
+        ManifestEntry entry;
+
+        entry.iSize = fields.at( 1 ).toLongLong();
+        entry.sha256 = fields.at( 2 ).toLower();
+        m_manifest.insert( QString::fromUtf8( fields.at( 0 ) ), entry );
+    }
+}
+
+
+void DownloadManager::startNext()
+{
+    while( (m_active.count() < m_iMaxTransfers) && (!m_queue.isEmpty()) )
+    {
+        DownloadTransfer *pTransfer = new DownloadTransfer;
+
+        pTransfer->job = m_queue.takeFirst();
+        pTransfer->pReply = nullptr;
+        pTransfer->pFile = nullptr;
+        pTransfer->iRetries = 0;
+        pTransfer->bWriting = false;
+        pTransfer->bBadRange = false;
+        m_active.append( pTransfer );
+        startTransfer( pTransfer );
+    }
+
+    if( m_active.isEmpty() && m_queue.isEmpty() && m_bRunning )
+    {
+        m_bRunning = false;
+        emit finished( m_bAllOK );
+    }
+}
+
+
+// Append to whatever's already in the .part file and ask the server for the rest. The range is only good against the
+// same copy of the file the part came from so it goes with that copy's validator; without one the part starts over.
+void DownloadManager::startTransfer( DownloadTransfer *pTransfer )
+{
+    QNetworkRequest request( pTransfer->job.url );
+    QFile           tag( pTransfer->job.qsFile + ".part.tag" );
+    QByteArray      tagValue;
+
+    pTransfer->pFile = new QFile( pTransfer->job.qsFile + ".part" );
+    if( !pTransfer->pFile->open( QIODevice::WriteOnly | QIODevice::Append ) )
+    {
+        qDebug() << "Cannot write" << pTransfer->pFile->fileName();
+        delete pTransfer->pFile;
+        pTransfer->pFile = nullptr;
+        m_bAllOK = false;
+        m_active.removeOne( pTransfer );
+        emit fileFinished( pTransfer->job.qsName, false );
+        delete pTransfer;
+        startNext();
+        return;
+    }
+
+    if( tag.open( QIODevice::ReadOnly ) )
+    {
+        tagValue = tag.readAll().trimmed();
+        tag.close();
+    }
+    if( tagValue.isEmpty() )
+        pTransfer->pFile->resize( 0 );
+
+    pTransfer->iResumeFrom = pTransfer->pFile->size();
+    pTransfer->iReceived = 0;
+    pTransfer->bWriting = false;
+    pTransfer->bBadRange = false;
+    pTransfer->iTotal = m_manifest.contains( pTransfer->job.qsName ) ? m_manifest.value( pTransfer->job.qsName ).iSize : 0;
+
+    // Anyone consuming the stream needs to catch up on what's already in the part before new data shows up
+    emit transferStarted( pTransfer->job.qsName, pTransfer->pFile->fileName(), pTransfer->iResumeFrom );
+
+    // Already have all of it from an earlier run that was interrupted before the rename
+    if( (pTransfer->iTotal > 0) && (pTransfer->iResumeFrom >= pTransfer->iTotal) )
+    {
+        finishTransfer( pTransfer );
+        return;
+    }
+
+    if( pTransfer->iResumeFrom > 0 )
+    {
+        request.setRawHeader( "Range", "bytes=" + QByteArray::number( pTransfer->iResumeFrom ) + "-" );
+        request.setRawHeader( "If-Range", tagValue );
+    }
+
+    pTransfer->pReply = m_pManager->get( request );
+
+    connect( pTransfer->pReply, SIGNAL( readyRead() ), this, SLOT( transferReadyRead() ) );
+    connect( pTransfer->pReply, SIGNAL( downloadProgress( qint64, qint64 ) ), this, SLOT( transferProgress( qint64, qint64 ) ) );
+    connect( pTransfer->pReply, SIGNAL( finished() ), this, SLOT( transferFinished() ) );
+}
+
+
+// Only a 200 or 206 body is the file; anything else (an error page, the body of a 416) is read off and dropped
+void DownloadManager::transferReadyRead()
+{
+    DownloadTransfer *pTransfer;
+    int               iStatus;
+
+    foreach( pTransfer, m_active )
+    {
+        if( pTransfer->pReply != sender() )
+            continue;
+
+        iStatus = status( pTransfer->pReply );
+        if( (iStatus != 200) && (iStatus != 206) )
+        {
+            pTransfer->pReply->readAll();
+            break;
+        }
+
+        // A 200 is the whole file, either because the server ignored the range or because the file changed since the
+        // part was started, so the part starts over and remembers which copy it's now holding. A 206 has to pick up
+        // exactly where the part ends; anything else would leave a gap or a repeat in the file, so the reply is
+        // dropped and the part fetched again from the start.
+        if( !pTransfer->bWriting )
+        {
+            if( (iStatus == 206) && (rangeStart( pTransfer->pReply ) != pTransfer->iResumeFrom) )
+            {
+                qDebug() << "Download range mismatch" << pTransfer->job.url << pTransfer->pReply->rawHeader( "Content-Range" );
+                pTransfer->bBadRange = true;
+                pTransfer->pReply->readAll();
+                pTransfer->pReply->abort();
+                break;
+            }
+            pTransfer->bWriting = true;
+            if( iStatus == 200 )
+                restartPart( pTransfer );
+        }
+
+        QByteArray data = pTransfer->pReply->readAll();
+
+        pTransfer->pFile->write( data );
+        pTransfer->iReceived += data.size();
+        emit transferData( pTransfer->job.qsName, data );
+        break;
+    }
+}
+
+
+void DownloadManager::transferProgress( qint64 iReceived, qint64 iTotal )
+{
+    Q_UNUSED( iReceived )
+
+    DownloadTransfer *pTransfer;
+
+    foreach( pTransfer, m_active )
+    {
+        if( (pTransfer->pReply == sender()) && pTransfer->bWriting && (iTotal > 0) )
+            pTransfer->iTotal = pTransfer->iResumeFrom + iTotal;
+    }
+
+    reportProgress();
+}
+
+
+void DownloadManager::reportProgress()
+{
+    DownloadTransfer *pTransfer;
+    qint64            iReceived = m_iDoneBytes;
+    qint64            iTotal = m_iDoneBytes;
+
+    foreach( pTransfer, m_active )
+    {
+        iReceived += pTransfer->iResumeFrom + pTransfer->iReceived;
+        iTotal += pTransfer->iTotal;
+    }
+
+    emit progress( iReceived, iTotal );
+}
+
+
+void DownloadManager::transferFinished()
+{
+    DownloadTransfer *pTransfer = nullptr;
+    DownloadTransfer *pT;
+
+    foreach( pT, m_active )
+    {
+        if( pT->pReply == sender() )
+        {
+            pTransfer = pT;
+            break;
+        }
+    }
+
+    if( pTransfer == nullptr )
+        return;
+
+    QNetworkReply::NetworkError eError = pTransfer->pReply->error();
+    int                         iStatus = status( pTransfer->pReply );
+    QByteArray                  contentRange = pTransfer->pReply->rawHeader( "Content-Range" );
+    bool                        bRetry;
+
+    // An empty 200 never went through transferReadyRead but it still replaces whatever the part had
+    if( (eError == QNetworkReply::NoError) && (iStatus == 200) && (!pTransfer->bWriting) )
+        restartPart( pTransfer );
+    // Nor did an empty 206 but it still has to be for the right place
+    else if( (eError == QNetworkReply::NoError) && (iStatus == 206) && (!pTransfer->bWriting) &&
+             (rangeStart( pTransfer->pReply ) != pTransfer->iResumeFrom) )
+        pTransfer->bBadRange = true;
+    if( pTransfer->bBadRange )
+        restartPart( pTransfer );
+
+    pTransfer->pReply->deleteLater();
+    pTransfer->pReply = nullptr;
+
+    if( (eError == QNetworkReply::NoError) && ((iStatus == 200) || (iStatus == 206)) && (!pTransfer->bBadRange) )
+    {
+        finishTransfer( pTransfer );
+        return;
+    }
+
+    // 416 means we asked for a range past the end, which is what happens when the part is already complete. The server
+    // says how long the file is ("bytes */<size>") and if that isn't what we have the part is no good.
+    if( iStatus == 416 )
+    {
+        qint64 iSize = contentRange.mid( contentRange.indexOf( '/' ) + 1 ).toLongLong();
+
+        if( (iSize > 0) && (iSize == pTransfer->iResumeFrom) )
+        {
+            pTransfer->iTotal = iSize;
+            finishTransfer( pTransfer );
+            return;
+        }
+        restartPart( pTransfer );
+    }
+
+    qDebug() << "Download failed" << pTransfer->job.url << eError << iStatus;
+
+    // Keep what we have and try again from there after a pause. Any network error counts, whatever status came before
+    // it: a link that drops partway through the body still leaves the 200 or 206 it started with. Only an abort isn't
+    // worth another go, unless it was ours over a bad range. A reply without an error (a redirect we don't follow) is
+    // going to say the same thing again.
+    bRetry = pTransfer->bBadRange ||
+             ((eError != QNetworkReply::NoError) && (eError != QNetworkReply::OperationCanceledError)) ||
+             (iStatus == 408) || (iStatus == 416) || (iStatus == 429) || (iStatus >= 500);
+    pTransfer->pFile->close();
+    delete pTransfer->pFile;
+    pTransfer->pFile = nullptr;
+    if( bRetry && (pTransfer->iRetries < g_iMaxRetries) )
+    {
+        retryTransfer( pTransfer );
+        return;
+    }
+
+    failTransfer( pTransfer );
+}
+
+
+// 2, 4 then 8 seconds
+void DownloadManager::retryTransfer( DownloadTransfer *pTransfer )
+{
+    int iTimer = startTimer( g_iRetryDelayMs << pTransfer->iRetries );
+
+    pTransfer->iRetries++;
+    m_retries.insert( iTimer, pTransfer );
+}
+
+
+void DownloadManager::timerEvent( QTimerEvent *pEvent )
+{
+    if( pEvent == nullptr )
+        return;
+
+    DownloadTransfer *pTransfer = m_retries.take( pEvent->timerId() );
+
+    killTimer( pEvent->timerId() );
+    if( pTransfer != nullptr )
+        startTransfer( pTransfer );
+}
+
+
+void DownloadManager::failTransfer( DownloadTransfer *pTransfer )
+{
+    m_bAllOK = false;
+    m_active.removeOne( pTransfer );
+    emit fileFinished( pTransfer->job.qsName, false );
+    delete pTransfer;
+    startNext();
+}
+
+
+// Throw away the part and note the validator of the copy that's coming (if any) so a resume later asks for the same one
+void DownloadManager::restartPart( DownloadTransfer *pTransfer )
+{
+    QFile      tag( pTransfer->job.qsFile + ".part.tag" );
+    QByteArray tagValue = (pTransfer->pReply != nullptr) ? validator( pTransfer->pReply ) : QByteArray();
+
+    pTransfer->pFile->resize( 0 );
+    pTransfer->iResumeFrom = 0;
+    pTransfer->iReceived = 0;
+    emit transferStarted( pTransfer->job.qsName, pTransfer->pFile->fileName(), 0 );
+
+    if( tagValue.isEmpty() )
+        tag.remove();
+    else if( tag.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        tag.write( tagValue );
+        tag.close();
+    }
+}
+
+
+void DownloadManager::finishTransfer( DownloadTransfer *pTransfer )
+{
+    QString qsPart = pTransfer->job.qsFile + ".part";
+    bool    bOK;
+
+    pTransfer->pFile->flush();
+    pTransfer->pFile->close();
+    delete pTransfer->pFile;
+    pTransfer->pFile = nullptr;
+
+    bOK = verify( pTransfer->job, pTransfer->iTotal );
+    // A bad checksum means the part is junk so resuming it would never succeed
+    if( !bOK )
+        QFile::remove( qsPart );
+    else
+        bOK = replace( qsPart, pTransfer->job.qsFile );
+    QFile::remove( qsPart + ".tag" );
+
+    if( !bOK )
+        m_bAllOK = false;
+
+    m_iDoneBytes += pTransfer->iResumeFrom + pTransfer->iReceived;
+    m_active.removeOne( pTransfer );
+    emit fileFinished( pTransfer->job.qsName, bOK );
+    delete pTransfer;
+
+    reportProgress();
+    startNext();
+}
+
+
+// Without a manifest entry the best we can do is the length the server told us about, when it told us
+bool DownloadManager::verify( const DownloadJob &job, qint64 iExpected )
+{
+    QFile part( job.qsFile + ".part" );
+
+    if( !part.open( QIODevice::ReadOnly ) )
+        return false;
+
+    if( !m_manifest.contains( job.qsName ) )
+    {
+        if( (iExpected > 0) && (part.size() != iExpected) )
+        {
+            qDebug() << job.qsName << "size mismatch" << part.size() << iExpected;
+            return false;
+        }
+        return part.size() > 0;
+    }
+
+    ManifestEntry      entry = m_manifest.value( job.qsName );
+    QCryptographicHash hash( QCryptographicHash::Sha256 );
+
+    if( part.size() != entry.iSize )
+    {
+        qDebug() << job.qsName << "size mismatch" << part.size() << entry.iSize;
+        return false;
+    }
+
+    hash.addData( &part );
+    if( hash.result().toHex() != entry.sha256 )
+    {
+        qDebug() << job.qsName << "checksum mismatch";
+        return false;
+    }
+
+    return true;
+}
+
+
+// rename() replaces the target in one step so a reader never sees a half written dataset
+bool DownloadManager::replace( const QString &qsPart, const QString &qsFile )
+{
+#if defined( Q_OS_WIN )
+    QFile::remove( qsFile );
+    return QFile::rename( qsPart, qsFile );
+#else
+    return ::rename( QFile::encodeName( qsPart ).constData(), QFile::encodeName( qsFile ).constData() ) == 0;
+#endif
+}
+
+
+int DownloadManager::status( QNetworkReply *pReply )
+{
+    return pReply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+}
+
+
+// First byte of a 206 body from its "bytes <first>-<last>/<size>" header, -1 if there isn't one
+qint64 DownloadManager::rangeStart( QNetworkReply *pReply )
+{
+    QByteArray contentRange = pReply->rawHeader( "Content-Range" ).trimmed();
+    int        iDash = contentRange.indexOf( '-' );
+    bool       bOK = false;
+    qint64     iStart;
+
+    if( (!contentRange.startsWith( "bytes " )) || (iDash < 0) )
+        return -1;
+
+    iStart = contentRange.mid( 6, iDash - 6 ).trimmed().toLongLong( &bOK );
+
+    return bOK ? iStart : -1;
+}
+
+
+// A weak ETag can't be used with If-Range so fall back on the modification time
+QByteArray DownloadManager::validator( QNetworkReply *pReply )
+{
+    QByteArray eTag = pReply->rawHeader( "ETag" );
+
+    if( (!eTag.isEmpty()) && (!eTag.startsWith( "W/" )) )
+        return eTag;
+
+    return pReply->rawHeader( "Last-Modified" );
+}
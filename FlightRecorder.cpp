@@ -0,0 +1,330 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined( Q_OS_UNIX )
+#include <unistd.h>
+#endif
+#if defined( Q_OS_LINUX )
+#include <fcntl.h>
+#endif
+
+#include "FlightRecorder.h"
+#include "SettingsStore.h"
+#include "Builder.h"
+
+
+extern SettingsStore *g_pSettings;
+
+
+static const int g_iTrackPollMs = 250;          // How often the writer wakes to drain the ring
+static const int g_iTrackSyncMs = 5000;         // and gets what it has onto the card at least this often
+static const int g_iTrackChunkSecs = 600;       // File space is reserved ten minutes at a time
+
+
+/*
+Track file, in the device's byte order:
+    TrackHeader
+    TrackPoint records back to back
+The space is reserved ahead of the records so the card isn't extending the file on every write. The count in the header
+only moves once a batch is written so anything past it is either unused or didn't make it; the file is trimmed to the
+count when recording stops.
+*/
+struct TrackHeader
+{
+    char   szMagic[8];      // "STRATTRK"
+    qint32 iVersion;
+    qint32 iRecordSize;
+    qint32 iHz;
+    qint32 iReserved;
+    qint64 iCount;
+};
+
+
+TrackWriter::TrackWriter( const QString &qsFile, int iHz )
+    : m_qsFile( qsFile ),
+      m_iHz( iHz ),
+      m_iCount( 0 ),
+      m_iCapacity( 0 ),
+      m_bFailed( false ),
+      m_iHead( 0 ),
+      m_iTail( 0 ),
+      m_iDropped( 0 ),
+      m_bStop( 0 )
+{
+}
+
+
+// GUI thread only; the slot is filled before the head moves past it so the writer never sees half a point
+bool TrackWriter::push( const TrackPoint &point )
+{
+    int iHead = m_iHead.load();
+    int iNext = (iHead + 1) % RingSize;
+
+    if( iNext == m_iTail.loadAcquire() )
+    {
+        m_iDropped.ref();
+        return false;
+    }
+
+    m_ring[iHead] = point;
+    m_iHead.storeRelease( iNext );
+
+    return true;
+}
+
+
+void TrackWriter::run()
+{
+    bool bStopping;
+
+    m_bFailed = (!begin());
+
+    // Whatever was pushed before the stop is still written out
+    forever
+    {
+        bStopping = (m_bStop.loadAcquire() != 0);
+        drain();
+        if( bStopping )
+            break;
+        msleep( g_iTrackPollMs );
+    }
+
+    end();
+}
+
+
+bool TrackWriter::begin()
+{
+    TrackHeader header;
+
+    QDir().mkpath( QFileInfo( m_qsFile ).path() );
+    m_file.setFileName( m_qsFile );
+    if( !m_file.open( QIODevice::ReadWrite | QIODevice::Truncate ) )
+    {
+        qDebug() << "Cannot write track" << m_qsFile;
+        return false;
+    }
+
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.szMagic, "STRATTRK", 8 );
+    header.iVersion = 1;
+    header.iRecordSize = static_cast<qint32>( sizeof( TrackPoint ) );
+    header.iHz = m_iHz;
+    header.iCount = 0;
+    if( m_file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) ) != static_cast<qint64>( sizeof( header ) ) )
+    {
+        qDebug() << "Cannot write track header" << m_qsFile;
+        return false;
+    }
+
+    m_sinceSync.start();
+
+    return true;
+}
+
+
+// Points are written straight out of the ring, in two runs when they wrap; the slots are only handed back afterwards.
+// A failed file still empties the ring so recording carries on dropping points instead of jamming.
+void TrackWriter::drain()
+{
+    int iHead = m_iHead.loadAcquire();
+    int iTail = m_iTail.load();
+    int iRun;
+
+    while( iTail != iHead )
+    {
+        iRun = (iHead > iTail) ? (iHead - iTail) : (RingSize - iTail);
+        if( !m_bFailed )
+        {
+            m_bFailed = (!write( &m_ring[iTail], iRun ));
+            if( m_bFailed )
+                qDebug() << "Track write failed" << m_qsFile << m_file.errorString();
+        }
+        iTail = (iTail + iRun) % RingSize;
+        m_iTail.storeRelease( iTail );
+    }
+
+    if( (!m_bFailed) && (m_sinceSync.elapsed() >= g_iTrackSyncMs) )
+    {
+#if defined( Q_OS_UNIX )
+        fsync( m_file.handle() );
+#endif
+        m_sinceSync.start();
+    }
+}
+
+
+bool TrackWriter::write( const TrackPoint *pPoints, int iCount )
+{
+    qint64 iRecordSize = static_cast<qint64>( sizeof( TrackPoint ) );
+    qint64 iBytes = iRecordSize * iCount;
+
+    if( (m_iCount + iCount) > m_iCapacity )
+    {
+        while( (m_iCount + iCount) > m_iCapacity )
+            m_iCapacity += static_cast<qint64>( m_iHz ) * g_iTrackChunkSecs;
+
+#if defined( Q_OS_LINUX )
+        // Actually allocates the blocks where a resize would only leave a hole
+        if( posix_fallocate( m_file.handle(), 0, static_cast<off_t>( sizeof( TrackHeader ) + (m_iCapacity * iRecordSize) ) ) != 0 )
+#endif
+        {
+            if( !m_file.resize( sizeof( TrackHeader ) + (m_iCapacity * iRecordSize) ) )
+                return false;
+        }
+    }
+
+    if( (!m_file.seek( sizeof( TrackHeader ) + (m_iCount * iRecordSize) )) ||
+        (m_file.write( reinterpret_cast<const char *>( pPoints ), iBytes ) != iBytes) )
+        return false;
+    m_iCount += iCount;
+
+    if( (!m_file.seek( offsetof( TrackHeader, iCount ) )) ||
+        (m_file.write( reinterpret_cast<const char *>( &m_iCount ), sizeof( m_iCount ) ) != static_cast<qint64>( sizeof( m_iCount ) )) )
+        return false;
+
+    return m_file.flush();
+}
+
+
+void TrackWriter::end()
+{
+    if( !m_file.isOpen() )
+        return;
+
+    if( !m_bFailed )
+        m_file.resize( sizeof( TrackHeader ) + (m_iCount * static_cast<qint64>( sizeof( TrackPoint ) )) );
+    m_file.flush();
+#if defined( Q_OS_UNIX )
+    fsync( m_file.handle() );
+#endif
+    m_file.close();
+}
+
+
+FlightRecorder::FlightRecorder()
+    : m_pWriter( nullptr )
+{
+    m_iHz = qBound( 1, g_pSettings->value( "RecordHz", 5 ).toInt(), 50 );
+    m_iIntervalMs = 1000 / m_iHz;
+    m_dStartKts = g_pSettings->value( "RecordStartKts", 40.0 ).toDouble();
+    m_dStopKts = g_pSettings->value( "RecordStopKts", 15.0 ).toDouble();
+    m_iStopMs = g_pSettings->value( "RecordStopSecs", 60 ).toInt() * 1000;
+}
+
+
+// Give the writers a moment to close their files; one stuck on a dead card is left behind rather than holding up the exit
+FlightRecorder::~FlightRecorder()
+{
+    TrackWriter *pWriter;
+
+    stop();
+    foreach( pWriter, m_finishing )
+    {
+        if( pWriter->wait( 3000 ) )
+            delete pWriter;
+    }
+}
+
+
+void FlightRecorder::start()
+{
+    if( m_pWriter != nullptr )
+        return;
+
+    m_pWriter = new TrackWriter( trackFile(), m_iHz );
+    m_pWriter->start( QThread::LowPriority );
+    m_sinceSample.invalidate();
+    m_sinceSlow.invalidate();
+}
+
+
+// Never waits on the writer; it finishes up in its own time and is cleaned up on a later update
+void FlightRecorder::stop()
+{
+    if( m_pWriter == nullptr )
+        return;
+
+    m_pWriter->finish();
+    m_finishing.append( m_pWriter );
+    m_pWriter = nullptr;
+}
+
+
+void FlightRecorder::situation( const StratuxSituation &s, bool bAutoRec )
+{
+    TrackPoint point;
+
+    if( !m_finishing.isEmpty() )
+        reap();
+
+    if( bAutoRec )
+    {
+        if( m_pWriter == nullptr )
+        {
+            if( s.dGPSGroundSpeed >= m_dStartKts )
+                start();
+        }
+        else if( s.dGPSGroundSpeed >= m_dStopKts )
+            m_sinceSlow.invalidate();
+        else if( !m_sinceSlow.isValid() )
+            m_sinceSlow.start();
+        else if( m_sinceSlow.elapsed() >= m_iStopMs )
+            stop();
+    }
+    else if( m_pWriter != nullptr )
+        stop();
+
+    if( (m_pWriter == nullptr) || (m_sinceSample.isValid() && (m_sinceSample.elapsed() < m_iIntervalMs)) )
+        return;
+    m_sinceSample.start();
+
+    point.iTimeMs = QDateTime::currentMSecsSinceEpoch();
+    point.dLat = s.dGPSlat;
+    point.dLong = s.dGPSlong;
+    point.dAlt = s.dGPSAltMSL;
+    point.dPitch = s.dAHRSpitch;
+    point.dRoll = s.dAHRSroll;
+    point.dHead = s.dAHRSGyroHeading;
+    point.dGroundSpeed = s.dGPSGroundSpeed;
+    point.dVertSpeed = s.dGPSVertSpeed;
+    m_pWriter->push( point );
+}
+
+
+void FlightRecorder::reap()
+{
+    int          i;
+    TrackWriter *pWriter;
+
+    for( i = m_finishing.count() - 1; i >= 0; i-- )
+    {
+        pWriter = m_finishing.at( i );
+        if( !pWriter->isFinished() )
+            continue;
+        if( pWriter->dropped() > 0 )
+            qDebug() << "Track recorder dropped" << pWriter->dropped() << "points";
+        delete pWriter;
+        m_finishing.removeAt( i );
+    }
+}
+
+
+QString FlightRecorder::trackFile()
+{
+    QString qsFile;
+
+    Builder::getStorage( &qsFile );
+
+    return qsFile + QString( "/data/space.skyfun.stratofier/tracks/%1.trk" ).arg( QDateTime::currentDateTimeUtc().toString( "yyyyMMdd-hhmmss" ) );
+}
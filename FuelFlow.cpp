@@ -0,0 +1,250 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+#include <QDateTime>
+
+#include <math.h>
+
+#if defined( Q_OS_UNIX )
+#include <unistd.h>
+#endif
+
+#include "FuelFlow.h"
+#include "Builder.h"
+
+
+static const int g_iJournalWriteMs = 1000;      // A state record at most this often
+static const int g_iJournalSyncMs = 10000;      // and on the disk at least this often
+
+
+/*
+Journal records, one per line:
+    T,leftCapacity,rightCapacity,cruise,climb,descent,taxi,switchMins,dual   Tank setup; always the first line
+    F,leftRemaining,rightRemaining,onLeft,lastSwitchMs                      State; the last complete one wins
+The file is deleted when fuel flow is stopped so one that's still there at startup is a flight that didn't end.
+*/
+
+
+FuelFlow::FuelFlow()
+    : m_pTanks( nullptr ),
+      m_ePhase( GroundPhase ),
+      m_iLastNs( 0 )
+{
+}
+
+
+FuelFlow::~FuelFlow()
+{
+    // Shutting down isn't stopping; whatever's left is still good for a resume
+    if( m_pTanks != nullptr )
+        writeState( true );
+}
+
+
+void FuelFlow::start( FuelTanks *pTanks )
+{
+    QString qsFile = journalFile();
+
+    m_pTanks = pTanks;
+    m_ePhase = GroundPhase;
+    m_clock.start();
+    m_iLastNs = 0;
+
+    m_journal.close();
+    QDir().mkpath( QFileInfo( qsFile ).path() );
+    m_journal.setFileName( qsFile );
+    if( !m_journal.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+        qDebug() << "Cannot write fuel journal" << qsFile;
+
+    append( QString( "T,%1,%2,%3,%4,%5,%6,%7,%8" ).arg( pTanks->dLeftCapacity )
+                                                  .arg( pTanks->dRightCapacity )
+                                                  .arg( pTanks->dFuelRateCruise )
+                                                  .arg( pTanks->dFuelRateClimb )
+                                                  .arg( pTanks->dFuelRateDescent )
+                                                  .arg( pTanks->dFuelRateTaxi )
+                                                  .arg( pTanks->iSwitchIntervalMins )
+                                                  .arg( pTanks->bDualTanks ? 1 : 0 ), false );
+    writeState( true );
+}
+
+
+void FuelFlow::stop()
+{
+    m_pTanks = nullptr;
+    m_journal.close();
+    QFile::remove( journalFile() );
+}
+
+
+// Reads back a journal left behind by a flight that was never stopped; a record cut off by a power loss just doesn't parse
+bool FuelFlow::resume( FuelTanks *pTanks )
+{
+    QFile       journal( journalFile() );
+    FuelTanks   tanks = *pTanks;
+    QStringList fields;
+    bool        bSetup = false, bState = false;
+
+    if( !journal.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        return false;
+
+    while( !journal.atEnd() )
+    {
+        fields = QString( journal.readLine() ).trimmed().split( ',' );
+
+        if( (fields.count() == 9) && (fields.first() == "T") )
+        {
+            tanks.dLeftCapacity = fields.at( 1 ).toDouble();
+            tanks.dRightCapacity = fields.at( 2 ).toDouble();
+            tanks.dFuelRateCruise = fields.at( 3 ).toDouble();
+            tanks.dFuelRateClimb = fields.at( 4 ).toDouble();
+            tanks.dFuelRateDescent = fields.at( 5 ).toDouble();
+            tanks.dFuelRateTaxi = fields.at( 6 ).toDouble();
+            tanks.iSwitchIntervalMins = fields.at( 7 ).toInt();
+            tanks.bDualTanks = (fields.at( 8 ).toInt() != 0);
+            bSetup = true;
+        }
+        else if( bSetup && (fields.count() == 5) && (fields.first() == "F") )
+        {
+            tanks.dLeftRemaining = fields.at( 1 ).toDouble();
+            tanks.dRightRemaining = fields.at( 2 ).toDouble();
+            tanks.bOnLeftTank = (fields.at( 3 ).toInt() != 0);
+            tanks.lastSwitch = QDateTime::fromMSecsSinceEpoch( fields.at( 4 ).toLongLong() );
+            bState = true;
+        }
+    }
+    journal.close();
+
+    if( !bState )
+        return false;
+
+    *pTanks = tanks;
+    m_pTanks = pTanks;
+    m_ePhase = GroundPhase;
+    m_clock.start();
+    m_iLastNs = 0;
+
+    m_journal.setFileName( journalFile() );
+    if( !m_journal.open( QIODevice::Append | QIODevice::Text ) )
+        qDebug() << "Cannot append to fuel journal" << journalFile();
+    m_sinceWrite.start();
+    m_sinceSync.start();
+
+    return true;
+}
+
+
+// What went by since the last update is burned at the rate for what the aircraft was doing then; if the stream drops
+// out for a while the engine was still running so the gap counts the same way
+void FuelFlow::situation( const StratuxSituation &s )
+{
+    if( m_pTanks == nullptr )
+        return;
+
+    qint64 iNowNs = m_clock.nsecsElapsed();
+    double dBurn = rate( *m_pTanks, m_ePhase ) * static_cast<double>( iNowNs - m_iLastNs ) / 3600.0e9;
+
+    m_iLastNs = iNowNs;
+    m_ePhase = phase( s );
+
+    if( dBurn <= 0.0 )
+        return;
+
+    if( m_pTanks->bOnLeftTank || (!m_pTanks->bDualTanks) )
+        m_pTanks->dLeftRemaining = qMax( 0.0, m_pTanks->dLeftRemaining - dBurn );
+    else
+        m_pTanks->dRightRemaining = qMax( 0.0, m_pTanks->dRightRemaining - dBurn );
+
+    if( m_sinceWrite.elapsed() >= g_iJournalWriteMs )
+        writeState( m_sinceSync.elapsed() >= g_iJournalSyncMs );
+}
+
+
+void FuelFlow::tanksSwitched()
+{
+    if( m_pTanks != nullptr )
+        writeState( true );
+}
+
+
+FuelFlow::Phase FuelFlow::phase( const StratuxSituation &s )
+{
+    // Moving slowly with virtually no vertical movement is taxiing
+    if( (s.dGPSGroundSpeed > 5.0) && (s.dGPSGroundSpeed < 20.0) && (fabs( s.dBaroVertSpeed ) < 5.0) )
+        return TaxiPhase;
+    // Faster than 35 knots and at least anemically climbing
+    if( (s.dGPSGroundSpeed > 35.0) && (s.dBaroVertSpeed > 50.0) )
+        return ClimbPhase;
+    // At least a slow descent; checked before cruise since that would take it otherwise
+    if( (s.dGPSGroundSpeed > 70.0) && (s.dBaroVertSpeed < -250.0) )
+        return DescentPhase;
+    // At least an anemic airspeed and reasonably acceptable altitude control
+    if( (s.dGPSGroundSpeed > 70.0) && (s.dBaroVertSpeed < 100.0) )
+        return CruisePhase;
+
+    return GroundPhase;
+}
+
+
+double FuelFlow::rate( const FuelTanks &tanks, Phase ePhase )
+{
+    switch( ePhase )
+    {
+        case TaxiPhase:
+            return tanks.dFuelRateTaxi;
+        case ClimbPhase:
+            return tanks.dFuelRateClimb;
+        case DescentPhase:
+            return tanks.dFuelRateDescent;
+        case CruisePhase:
+            return tanks.dFuelRateCruise;
+        default:
+            break;
+    }
+
+    return 0.0;
+}
+
+
+void FuelFlow::writeState( bool bSync )
+{
+    append( QString( "F,%1,%2,%3,%4" ).arg( m_pTanks->dLeftRemaining, 0, 'f', 4 )
+                                      .arg( m_pTanks->dRightRemaining, 0, 'f', 4 )
+                                      .arg( m_pTanks->bOnLeftTank ? 1 : 0 )
+                                      .arg( m_pTanks->lastSwitch.toMSecsSinceEpoch() ), bSync );
+    m_sinceWrite.start();
+}
+
+
+// Flushing only hands the line to the OS; it's the sync that gets it through a power cut
+void FuelFlow::append( const QString &qsRecord, bool bSync )
+{
+    if( !m_journal.isOpen() )
+        return;
+
+    m_journal.write( qsRecord.toLatin1() + '\n' );
+    m_journal.flush();
+
+    if( bSync )
+    {
+#if defined( Q_OS_UNIX )
+        fsync( m_journal.handle() );
+#endif
+        m_sinceSync.start();
+    }
+}
+
+
+QString FuelFlow::journalFile()
+{
+    QString qsFile;
+
+    Builder::getStorage( &qsFile );
+
+    return qsFile + "/data/space.skyfun.stratofier/fuel.journal";
+}
@@ -3,7 +3,6 @@ Stratofier Stratux AHRS Display
 (c) 2018 Allen K. Lair, Sky Fun
 */
 
-#include <QSettings>
 #include <QtDebug>
 
 #include "ui_FuelTanksDialog.h"
@@ -13,9 +12,10 @@ Stratofier Stratux AHRS Display
 #include "ClickLabel.h"
 #include "Keypad.h"
 #include "AHRSCanvas.h"
+#include "SettingsStore.h"
 
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 Ui::FuelTanksDialog          *uiP;
 Ui::FuelTanksDialogLandscape *uiL;
@@ -84,8 +84,7 @@ FuelTanksDialog::FuelTanksDialog( QWidget *pParent, AHRSCanvas *pAHRS, Canvas *p
         pCL->setCanvas( pCanvas );
     }
 
-    g_pSet->beginGroup( "FuelTanks" );
-    if( !g_pSet->value( "DualTanks" ).toBool() )
+    if( !g_pSettings->settings().bSwitchableTanks )
     {
         if( m_bPortrait )
         {
@@ -155,7 +154,6 @@ FuelTanksDialog::FuelTanksDialog( QWidget *pParent, AHRSCanvas *pAHRS, Canvas *p
             uiL->m_pSwitchIntUnitsLabel->show();
         }
     }
-    g_pSet->endGroup();
 }
 
 
@@ -170,20 +168,18 @@ FuelTanksDialog::~FuelTanksDialog()
 
 void FuelTanksDialog::loadSettings()
 {
-    g_pSet->beginGroup( "FuelTanks" );
-
     if( m_bPortrait )
     {
-        uiP->m_pLeftCapLabel->setText( QString::number( g_pSet->value( "LeftCapacity", 24.0 ).toDouble(), 'f', 2 ) );
-        uiP->m_pRightCapLabel->setText( QString::number( g_pSet->value( "RightCapacity", 24.0 ).toDouble(), 'f', 2 ) );
-        uiP->m_pLeftRemainLabel->setText( QString::number( g_pSet->value( "LeftRemaining", 24.0 ).toDouble(), 'f', 2 ) );
-        uiP->m_pRightRemainLabel->setText( QString::number( g_pSet->value( "RightRemaining", 24.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pLeftCapLabel->setText( QString::number( g_pSettings->value( "FuelTanks/LeftCapacity", 24.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pRightCapLabel->setText( QString::number( g_pSettings->value( "FuelTanks/RightCapacity", 24.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pLeftRemainLabel->setText( QString::number( g_pSettings->value( "FuelTanks/LeftRemaining", 24.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pRightRemainLabel->setText( QString::number( g_pSettings->value( "FuelTanks/RightRemaining", 24.0 ).toDouble(), 'f', 2 ) );
 
-        uiP->m_pCruiseRateLabel->setText( QString::number( g_pSet->value( "CruiseRate", 8.3 ).toDouble(), 'f', 2 ) );
-        uiP->m_pClimbRateLabel->setText( QString::number( g_pSet->value( "ClimbRate", 9.0 ).toDouble(), 'f', 2 ) );
-        uiP->m_pDescRateLabel->setText( QString::number( g_pSet->value( "DescentRate", 7.0 ).toDouble(), 'f', 2 ) );
-        uiP->m_pTaxiRateLabel->setText( QString::number( g_pSet->value( "TaxiRate", 4.0 ).toDouble(), 'f', 2 ) );
-        uiP->m_pSwitchIntLabel->setText( QString::number( g_pSet->value( "SwitchInterval", 15 ).toInt() ) );
+        uiP->m_pCruiseRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/CruiseRate", 8.3 ).toDouble(), 'f', 2 ) );
+        uiP->m_pClimbRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/ClimbRate", 9.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pDescRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/DescentRate", 7.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pTaxiRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/TaxiRate", 4.0 ).toDouble(), 'f', 2 ) );
+        uiP->m_pSwitchIntLabel->setText( QString::number( g_pSettings->value( "FuelTanks/SwitchInterval", 15 ).toInt() ) );
 
         uiP->m_pStartLeftButton->setText( "START" );
         uiP->m_pStartRightButton->hide();
@@ -201,16 +197,16 @@ void FuelTanksDialog::loadSettings()
     }
     else
     {
-        uiL->m_pLeftCapLabel->setText( QString::number( g_pSet->value( "LeftCapacity", 24.0 ).toDouble(), 'f', 2 ) );
-        uiL->m_pRightCapLabel->setText( QString::number( g_pSet->value( "RightCapacity", 24.0 ).toDouble(), 'f', 2 ) );
-        uiL->m_pLeftRemainLabel->setText( QString::number( g_pSet->value( "LeftRemaining", 24.0 ).toDouble(), 'f', 2 ) );
-        uiL->m_pRightRemainLabel->setText( QString::number( g_pSet->value( "RightRemaining", 24.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pLeftCapLabel->setText( QString::number( g_pSettings->value( "FuelTanks/LeftCapacity", 24.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pRightCapLabel->setText( QString::number( g_pSettings->value( "FuelTanks/RightCapacity", 24.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pLeftRemainLabel->setText( QString::number( g_pSettings->value( "FuelTanks/LeftRemaining", 24.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pRightRemainLabel->setText( QString::number( g_pSettings->value( "FuelTanks/RightRemaining", 24.0 ).toDouble(), 'f', 2 ) );
 
-        uiL->m_pCruiseRateLabel->setText( QString::number( g_pSet->value( "CruiseRate", 8.3 ).toDouble(), 'f', 2 ) );
-        uiL->m_pClimbRateLabel->setText( QString::number( g_pSet->value( "ClimbRate", 9.0 ).toDouble(), 'f', 2 ) );
-        uiL->m_pDescRateLabel->setText( QString::number( g_pSet->value( "DescentRate", 7.0 ).toDouble(), 'f', 2 ) );
-        uiL->m_pTaxiRateLabel->setText( QString::number( g_pSet->value( "TaxiRate", 4.0 ).toDouble(), 'f', 2 ) );
-        uiL->m_pSwitchIntLabel->setText( QString::number( g_pSet->value( "SwitchInterval", 15 ).toInt() ) );
+        uiL->m_pCruiseRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/CruiseRate", 8.3 ).toDouble(), 'f', 2 ) );
+        uiL->m_pClimbRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/ClimbRate", 9.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pDescRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/DescentRate", 7.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pTaxiRateLabel->setText( QString::number( g_pSettings->value( "FuelTanks/TaxiRate", 4.0 ).toDouble(), 'f', 2 ) );
+        uiL->m_pSwitchIntLabel->setText( QString::number( g_pSettings->value( "FuelTanks/SwitchInterval", 15 ).toInt() ) );
 
         uiL->m_pStartLeftButton->setText( "START" );
         uiL->m_pStartRightButton->hide();
@@ -227,9 +223,7 @@ void FuelTanksDialog::loadSettings()
         uiL->m_pSwitchIntUnitsLabel->hide();
     }
 
-    m_tanks.bDualTanks = g_pSet->value( "DualTanks", true ).toBool();
-
-    g_pSet->endGroup();
+    m_tanks.bDualTanks = g_pSettings->settings().bSwitchableTanks;
 }
 
 
@@ -260,18 +254,15 @@ void FuelTanksDialog::saveSettings()
         m_tanks.iSwitchIntervalMins = static_cast<int>( uiL->m_pSwitchIntLabel->text().toDouble() );
     }
 
-    g_pSet->beginGroup( "FuelTanks" );
-    g_pSet->setValue( "LeftCapacity", m_tanks.dLeftCapacity );
-    g_pSet->setValue( "RightCapacity", m_tanks.dRightCapacity );
-    g_pSet->setValue( "LeftRemaining", m_tanks.dLeftRemaining );
-    g_pSet->setValue( "RightRemaining", m_tanks.dRightRemaining );
-    g_pSet->setValue( "CruiseRate", m_tanks.dFuelRateCruise );
-    g_pSet->setValue( "ClimbRate", m_tanks.dFuelRateClimb );
-    g_pSet->setValue( "DescentRate", m_tanks.dFuelRateDescent );
-    g_pSet->setValue( "TaxiRate", m_tanks.dFuelRateTaxi );
-    g_pSet->setValue( "SwitchInterval", m_tanks.iSwitchIntervalMins );
-    g_pSet->endGroup();
-    g_pSet->sync();
+    g_pSettings->setValue( "FuelTanks/LeftCapacity", m_tanks.dLeftCapacity );
+    g_pSettings->setValue( "FuelTanks/RightCapacity", m_tanks.dRightCapacity );
+    g_pSettings->setValue( "FuelTanks/LeftRemaining", m_tanks.dLeftRemaining );
+    g_pSettings->setValue( "FuelTanks/RightRemaining", m_tanks.dRightRemaining );
+    g_pSettings->setValue( "FuelTanks/CruiseRate", m_tanks.dFuelRateCruise );
+    g_pSettings->setValue( "FuelTanks/ClimbRate", m_tanks.dFuelRateClimb );
+    g_pSettings->setValue( "FuelTanks/DescentRate", m_tanks.dFuelRateDescent );
+    g_pSettings->setValue( "FuelTanks/TaxiRate", m_tanks.dFuelRateTaxi );
+    g_pSettings->setValue( "FuelTanks/SwitchInterval", m_tanks.iSwitchIntervalMins );
 
     m_tanks.bOnLeftTank = (sender()->objectName() == "m_pStartLeftButton");
     m_tanks.lastSwitch = QDateTime::currentDateTime();
@@ -315,10 +306,7 @@ void FuelTanksDialog::resetFuel()
         uiL->m_pRightRemainLabel->setText( QString::number( iGalR ) );
     }
 
-    g_pSet->beginGroup( "FuelTanks" );
-    g_pSet->setValue( "LeftRemaining", iGalL );
-    g_pSet->setValue( "RightRemaining", iGalR );
-    g_pSet->endGroup();
-    g_pSet->sync();
+    g_pSettings->setValue( "FuelTanks/LeftRemaining", iGalL );
+    g_pSettings->setValue( "FuelTanks/RightRemaining", iGalR );
 }
 
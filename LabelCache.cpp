@@ -0,0 +1,90 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QPainter>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+#include <QCache>
+#include <QMutex>
+
+#include "LabelCache.h"
+#include "Builder.h"
+
+
+// Cost is in pixels; a few hundred airport IDs and traffic tags fit comfortably
+static QCache<QString, CachedLabel> g_labelCache( 1024 * 1024 );
+static QCache<QString, QImage>      g_runwayCache( 512 * 1024 );
+static QMutex                       g_labelMutex;
+
+
+// Text is drawn at the origin and the shadow at the offset from it, same as drawing the shadow then the text
+CachedLabel LabelCache::label( const QString &qsText, const QFont &font, const QColor &color, const QColor &shadow, const QPoint &shadowOffset )
+{
+    QString      qsKey = QString( "%1|%2|%3|%4|%5|%6|%7" ).arg( qsText )
+                                                           .arg( font.key() )
+                                                           .arg( font.letterSpacing() )
+                                                           .arg( color.rgba() )
+                                                           .arg( shadow.rgba() )
+                                                           .arg( shadowOffset.x() )
+                                                           .arg( shadowOffset.y() );
+    QMutexLocker lock( &g_labelMutex );
+    CachedLabel *pCached = g_labelCache.object( qsKey );
+
+    if( pCached != nullptr )
+        return *pCached;
+
+    QFontMetrics metrics( font );
+    QRect        textRect = metrics.boundingRect( qsText );
+    QRect        bounds = textRect.united( textRect.translated( shadowOffset ) ).adjusted( -1, -1, 1, 1 );
+    CachedLabel  label;
+
+    label.image = QImage( bounds.size(), QImage::Format_ARGB32_Premultiplied );
+    label.image.fill( Qt::transparent );
+    label.origin = -bounds.topLeft();
+    label.textSize = textRect.size();
+
+    QPainter labelPainter( &label.image );
+
+    labelPainter.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+    labelPainter.setFont( font );
+    labelPainter.setPen( shadow );
+    labelPainter.drawText( label.origin + shadowOffset, qsText );
+    labelPainter.setPen( color );
+    labelPainter.drawText( label.origin, qsText );
+    labelPainter.end();
+
+    // The cache owns (and may immediately drop) its copy so hand back our own
+    g_labelCache.insert( qsKey, new CachedLabel( label ), label.image.width() * label.image.height() );
+
+    return label;
+}
+
+
+// Put the label's text baseline where drawText would have put it
+void LabelCache::draw( QPainter *pPainter, const QPointF &baseline, const CachedLabel &label )
+{
+    pPainter->drawImage( baseline - label.origin, label.image );
+}
+
+
+// Runway numbers are built from the number glyphs and scaled down, which is much too slow to repeat every frame
+QImage LabelCache::runway( CanvasConstants *c, int iRunway, int iWidth )
+{
+    QString      qsKey = QString( "%1|%2|%3|%4" ).arg( iRunway ).arg( iWidth ).arg( c->dWNum ).arg( c->dHNum );
+    QMutexLocker lock( &g_labelMutex );
+    QImage      *pCached = g_runwayCache.object( qsKey );
+
+    if( pCached != nullptr )
+        return *pCached;
+
+    QImage num( 128, 84, QImage::Format_ARGB32_Premultiplied );
+
+    Builder::buildNumber( &num, c, iRunway, 2 );
+    num = num.scaledToWidth( iWidth, Qt::SmoothTransformation );
+    g_runwayCache.insert( qsKey, new QImage( num ), num.width() * num.height() );
+
+    return num;
+}
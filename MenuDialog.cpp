@@ -3,7 +3,6 @@ Stratofier Stratux AHRS Display
 (c) 2018 Allen K. Lair, Sky Fun
 */
 
-#include <QSettings>
 #include <QPushButton>
 #include <QDesktopServices>
 
@@ -14,12 +13,13 @@ Stratofier Stratux AHRS Display
 #include "FuelTanksDialog.h"
 #include "SettingsDialog.h"
 #include "StreamReader.h"
+#include "SettingsStore.h"
 
 #include "ui_MenuDialog.h"
 
 
-extern QSettings    *g_pSet;
-extern Canvas::Units g_eUnitsAirspeed;
+extern SettingsStore *g_pSettings;
+extern Canvas::Units  g_eUnitsAirspeed;
 
 
 MenuDialog::MenuDialog( QWidget *pParent, bool bPortrait )
@@ -59,7 +59,7 @@ MenuDialog::MenuDialog( QWidget *pParent, bool bPortrait )
 MenuDialog::~MenuDialog()
 {
     static_cast<AHRSMainWin *>( parent() )->disp()->dark( false );
-    emit magDev( g_pSet->value( "MagDev", 0 ).toInt() );
+    emit magDev( g_pSettings->settings().iMagDev );
 }
 
 
@@ -88,9 +88,10 @@ void MenuDialog::fuel()
 
 void MenuDialog::settings()
 {
-    CanvasConstants c = static_cast<AHRSMainWin *>( parent() )->disp()->canvas()->constants();
-    QString         qsCurrIP = g_pSet->value( "StratuxIP", "192.168.10.1" ).toString();
-    SettingsDialog  dlg( this, static_cast<AHRSMainWin *>( parent() )->disp()->canvas(), &c );
+    CanvasConstants    c = static_cast<AHRSMainWin *>( parent() )->disp()->canvas()->constants();
+    QString            qsCurrIP = g_pSettings->settings().qsStratuxIP;
+    SettingsDialog     dlg( this, static_cast<AHRSMainWin *>( parent() )->disp()->canvas(), &c );
+    StratofierSettings newSettings;
 
     // Scale the menu dialog according to screen resolution
     dlg.setMinimumWidth( static_cast<int>( c.dW ) );
@@ -98,16 +99,17 @@ void MenuDialog::settings()
     dlg.setGeometry( 0, 0, static_cast<int>( c.dW ), static_cast<int>( c.dH ) );
 
     dlg.exec();
+    newSettings = g_pSettings->settings();
 
-    if( g_pSet->value( "StratuxIP" ).toString() != qsCurrIP )
+    if( newSettings.qsStratuxIP != qsCurrIP )
     {
         static_cast<AHRSMainWin *>( parent() )->streamReader()->disconnectStreams();
         static_cast<AHRSMainWin *>( parent() )->streamReader()->connectStreams();
     }
 
-    static_cast<AHRSMainWin *>( parent() )->streamReader()->setAirspeedCal( g_pSet->value( "AirspeedCal", 1.0 ).toDouble() );
-    emit magDev( g_pSet->value( "MagDev", 0 ).toInt() );
-    emit setSwitchableTanks( g_pSet->value( "DualTanks", true ).toBool() );
-    emit halfMode( g_pSet->value( "HalfMode" ).toBool() );
+    static_cast<AHRSMainWin *>( parent() )->streamReader()->setAirspeedCal( newSettings.dAirspeedCal );
+    emit magDev( newSettings.iMagDev );
+    emit setSwitchableTanks( newSettings.bSwitchableTanks );
+    emit halfMode( newSettings.bHalfMode );
     emit settingsClosed();
 }
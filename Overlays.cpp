@@ -5,13 +5,13 @@ Stratofier Stratux AHRS Display
 
 #include <QKeyEvent>
 #include <QTimer>
-#include <QSettings>
 #include <QDebug>
 
 #include "Overlays.h"
+#include "SettingsStore.h"
 
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 
 Overlays::Overlays( QWidget *pParent )
@@ -53,13 +53,12 @@ Overlays::Overlays( QWidget *pParent )
 
 Overlays::~Overlays()
 {
-    g_pSet->setValue( "ShowAllTraffic", m_settings.bShowAllTraffic );
-    g_pSet->setValue( "ShowAirports", static_cast<int>( m_settings.eShowAirports ) );
-    g_pSet->setValue( "ShowRunways", m_settings.bShowRunways );
-    g_pSet->setValue( "ShowAirspaces", m_settings.bShowAirspaces );
-    g_pSet->setValue( "ShowAltitudes", m_settings.bShowAltitudes );
-    g_pSet->setValue( "ShowPrivate", m_settings.bShowPrivate );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAllTraffic", m_settings.bShowAllTraffic );
+    g_pSettings->setValue( "ShowAirports", static_cast<int>( m_settings.eShowAirports ) );
+    g_pSettings->setValue( "ShowRunways", m_settings.bShowRunways );
+    g_pSettings->setValue( "ShowAirspaces", m_settings.bShowAirspaces );
+    g_pSettings->setValue( "ShowAltitudes", m_settings.bShowAltitudes );
+    g_pSettings->setValue( "ShowPrivate", m_settings.bShowPrivate );
 }
 
 
@@ -123,8 +122,7 @@ void Overlays::privateAirports()
 {
     m_settings.bShowPrivate = (!m_settings.bShowPrivate);
 
-    g_pSet->setValue( "ShowPrivate", m_settings.bShowPrivate );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowPrivate", m_settings.bShowPrivate );
 
     m_pShowPrivateButton->setIcon( m_settings.bShowPrivate ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
 
@@ -137,8 +135,7 @@ void Overlays::runways()
 {
     m_settings.bShowRunways = (!m_settings.bShowRunways);
 
-    g_pSet->setValue( "ShowRunways", m_settings.bShowRunways );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowRunways", m_settings.bShowRunways );
 
     m_pShowRunwaysButton->setIcon( m_settings.bShowRunways ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
 
@@ -150,8 +147,7 @@ void Overlays::airspaces()
 {
     m_settings.bShowAirspaces = (!m_settings.bShowAirspaces);
 
-    g_pSet->setValue( "ShowAirspaces", m_settings.bShowAirspaces );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAirspaces", m_settings.bShowAirspaces );
 
     m_pShowAirspacesButton->setIcon( m_settings.bShowAirspaces ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
 
@@ -163,8 +159,7 @@ void Overlays::altitudes()
 {
     m_settings.bShowAltitudes = (!m_settings.bShowAltitudes);
 
-    g_pSet->setValue( "ShowAltitudes", m_settings.bShowAltitudes );
-    g_pSet->sync();
+    g_pSettings->setValue( "ShowAltitudes", m_settings.bShowAltitudes );
 
     m_pShowAltButton->setIcon( m_settings.bShowAltitudes ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
 
@@ -175,12 +170,5 @@ void Overlays::altitudes()
 void Overlays::loadSettings()
 {
     // Persistent settings
-    m_settings.bShowAllTraffic = g_pSet->value( "ShowAllTraffic", true ).toBool();
-    m_settings.eShowAirports = static_cast<Canvas::ShowAirports>( g_pSet->value( "ShowAirports", static_cast<int>( Canvas::ShowPavedAirports ) ).toInt() );
-    m_settings.bShowRunways = g_pSet->value( "ShowRunways", true ).toBool();
-    m_settings.bShowAirspaces = g_pSet->value( "ShowAirspaces", true ).toBool();
-    m_settings.bShowAltitudes = g_pSet->value( "ShowAltitudes" ).toBool();
-    m_settings.bShowPrivate = g_pSet->value( "ShowPrivate", false ).toBool();
+    m_settings = g_pSettings->settings();
 }
-
-
@@ -0,0 +1,219 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QMutex>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+
+static const int g_iProfileRing = 1024;     // Per stage; a bit over 30 s of frames at the full rate
+
+
+struct ProfileSample
+{
+    qint64 iStartNs;    // Since the profiler clock started
+    qint64 iNs;
+};
+
+
+struct ProfileRing
+{
+    ProfileSample samples[g_iProfileRing];
+    int           iNext;
+    int           iCount;
+};
+
+
+// Started once before main() and never touched again so any thread can read it without a lock; a new session only
+// moves the start it's measured from
+struct ProfileClock
+{
+    ProfileClock() { timer.start(); }
+
+    QElapsedTimer timer;
+};
+
+
+static ProfileRing            g_profileRings[Profiler::StageCount];
+static QMutex                 g_profileMutex;
+static QAtomicInt             g_bProfiling( 0 );
+static QAtomicInt             g_iProfileSession( 0 );   // Bumped each time the clock restarts
+static QAtomicInteger<qint64> g_iProfileStartNs( 0 );   // Where on the base clock the current session started
+static ProfileClock           g_profileClock;
+
+
+// Monotonic; the rings are cleared so a new session doesn't mix with an old one, and anything still timing against the
+// old clock is left out when it finishes
+void Profiler::setEnabled( bool bEnabled )
+{
+    QMutexLocker lock( &g_profileMutex );
+    int          iStage;
+
+    if( bEnabled && (g_bProfiling.load() == 0) )
+    {
+        for( iStage = 0; iStage < StageCount; iStage++ )
+        {
+            g_profileRings[iStage].iNext = 0;
+            g_profileRings[iStage].iCount = 0;
+        }
+        g_iProfileStartNs.store( g_profileClock.timer.nsecsElapsed() );
+        g_iProfileSession.ref();
+    }
+
+    g_bProfiling.store( bEnabled ? 1 : 0 );
+}
+
+
+bool Profiler::enabled()
+{
+    return g_bProfiling.load() != 0;
+}
+
+
+qint64 Profiler::now()
+{
+    return g_profileClock.timer.nsecsElapsed() - g_iProfileStartNs.load();
+}
+
+
+int Profiler::session()
+{
+    return g_iProfileSession.load();
+}
+
+
+// The map layers record from their worker threads so this does have to lock, but it's never held for more than a store.
+// The session is checked under the same lock setEnabled() restarts the clock under so a stale start can't slip in.
+void Profiler::record( Stage eStage, int iSession, qint64 iStartNs, qint64 iEndNs )
+{
+    QMutexLocker lock( &g_profileMutex );
+    ProfileRing *pRing = &g_profileRings[eStage];
+
+    if( (iSession != g_iProfileSession.load()) || (g_bProfiling.load() == 0) )
+        return;
+
+    pRing->samples[pRing->iNext].iStartNs = iStartNs;
+    pRing->samples[pRing->iNext].iNs = iEndNs - iStartNs;
+    pRing->iNext = (pRing->iNext + 1) % g_iProfileRing;
+    if( pRing->iCount < g_iProfileRing )
+        pRing->iCount++;
+}
+
+
+QString Profiler::stageName( Stage eStage )
+{
+    switch( eStage )
+    {
+        case FrameStage:
+            return "Frame";
+        case AirspacesStage:
+            return "Airspaces";
+        case AirportsStage:
+            return "Airports";
+        case TrafficStage:
+            return "Traffic";
+        case DirectToStage:
+            return "DirectTo";
+        case InfoStage:
+            return "Info";
+        case SituationStream:
+            return "Situation";
+        case TrafficStream:
+            return "TrafficMsg";
+        case StatusStream:
+            return "Status";
+        default:
+            break;
+    }
+
+    return "?";
+}
+
+
+// One line per stage for the overlay: the drawing stages get p50/p99 in ms, the streams messages per second, and the
+// frame stage both
+QStringList Profiler::summary()
+{
+    QMutexLocker    lock( &g_profileMutex );
+    QStringList     lines;
+    QVector<qint64> times;
+    qint64          iNow = now();
+    int             iStage, i, iPerSec;
+
+    for( iStage = 0; iStage < StageCount; iStage++ )
+    {
+        ProfileRing *pRing = &g_profileRings[iStage];
+
+        times.clear();
+        iPerSec = 0;
+        for( i = 0; i < pRing->iCount; i++ )
+        {
+            times.append( pRing->samples[i].iNs );
+            if( (iNow - pRing->samples[i].iStartNs) <= Q_INT64_C( 1000000000 ) )
+                iPerSec++;
+        }
+
+        if( times.isEmpty() )
+        {
+            lines.append( QString( "%1  --" ).arg( stageName( static_cast<Stage>( iStage ) ) ) );
+            continue;
+        }
+
+        std::sort( times.begin(), times.end() );
+
+        double dP50 = static_cast<double>( times.at( times.count() / 2 ) ) / 1000000.0;
+        double dP99 = static_cast<double>( times.at( (times.count() * 99) / 100 ) ) / 1000000.0;
+
+        if( iStage >= SituationStream )
+            lines.append( QString( "%1  %2/s  p50 %3  p99 %4 ms" ).arg( stageName( static_cast<Stage>( iStage ) ) ).arg( iPerSec ).arg( dP50, 0, 'f', 2 ).arg( dP99, 0, 'f', 2 ) );
+        else if( iStage == FrameStage )
+            lines.append( QString( "%1  %2 fps  p50 %3  p99 %4 ms" ).arg( stageName( static_cast<Stage>( iStage ) ) ).arg( iPerSec ).arg( dP50, 0, 'f', 2 ).arg( dP99, 0, 'f', 2 ) );
+        else
+            lines.append( QString( "%1  p50 %2  p99 %3 ms" ).arg( stageName( static_cast<Stage>( iStage ) ) ).arg( dP50, 0, 'f', 2 ).arg( dP99, 0, 'f', 2 ) );
+    }
+
+    return lines;
+}
+
+
+// Oldest first per stage: stage,start_ns,duration_ns
+bool Profiler::dump( const QString &qsFile )
+{
+    QFile csv( qsFile );
+
+    if( !csv.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+    {
+        qDebug() << "Cannot write profile" << qsFile;
+        return false;
+    }
+
+    QMutexLocker lock( &g_profileMutex );
+    QTextStream  out( &csv );
+    int          iStage, i;
+
+    out << "stage,start_ns,duration_ns\n";
+    for( iStage = 0; iStage < StageCount; iStage++ )
+    {
+        ProfileRing *pRing = &g_profileRings[iStage];
+        int          iFirst = (pRing->iCount < g_iProfileRing) ? 0 : pRing->iNext;
+
+        for( i = 0; i < pRing->iCount; i++ )
+        {
+            const ProfileSample &sample = pRing->samples[(iFirst + i) % g_iProfileRing];
+
+            out << stageName( static_cast<Stage>( iStage ) ) << ',' << sample.iStartNs << ',' << sample.iNs << '\n';
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,510 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QImage>
+#include <QRegion>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QDir>
+#include <QFont>
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "RenderBench.h"
+#include "AHRSCanvas.h"
+#include "StreamReader.h"
+#include "StratofierDefs.h"
+
+
+extern StratuxSituation      g_situation;
+extern QList<StratuxTraffic> g_trafficList;
+extern Canvas::Units         g_eUnitsAirspeed;
+
+extern QFont itsy;
+extern QFont wee;
+extern QFont tiny;
+extern QFont med;
+extern QFont large;
+
+
+// Same order as AHRSCanvas::InstrumentRegion
+static const char *g_pStageNames[] = { "attitude", "speed", "altitude", "vspeed", "map", "info" };
+
+
+// Every size is run in landscape as given and in portrait with the sides swapped; returns the exit code for main
+int RenderBench::run( int iFrames, int iTraffic, int iAirports, int iAirspaces, const QList<QSize> &sizes, const QString &qsReplay )
+{
+    QList<StratuxSituation> replay;
+    AHRSCanvas              canvas;
+    QSize                   size;
+    int                     iOrient, iFrame;
+    QElapsedTimer           frameTimer;
+
+    if( sizes.isEmpty() || (iFrames < 1) )
+        return 1;
+
+    if( (!qsReplay.isEmpty()) && (!loadReplay( qsReplay, &replay )) )
+    {
+        qWarning() << "Cannot read replay" << qsReplay;
+        return 1;
+    }
+
+    printf( "Stratofier render benchmark: %d frames, %d traffic, %d airports, %d airspaces, %s\n",
+            iFrames, iTraffic, iAirports, iAirspaces, replay.isEmpty() ? "synthetic situation" : qPrintable( QString( "replay of %1 (%2 frames)" ).arg( qsReplay ).arg( replay.count() ) ) );
+
+    startup( &canvas, sizes.first() );
+
+    foreach( size, sizes )
+    {
+        for( iOrient = 0; iOrient < 2; iOrient++ )
+        {
+            bool            bPortrait = (iOrient == 1);
+            QSize           frameSize = bPortrait ? size.transposed() : size;
+            QImage          frame( frameSize, QImage::Format_ARGB32_Premultiplied );
+            QRegion         all( frame.rect() );
+            QVector<qint64> frameNs( iFrames );
+            qint64          stageNs[AHRSCanvas::RegionCount];
+            qint64          iColdNs;
+
+            prepare( &canvas, frameSize, bPortrait );
+            populate( &canvas, iTraffic, iAirports, iAirspaces );
+
+            // The first frame builds the cached instrument layers so it's reported on its own
+            synthesize( 0, g_situation );
+            frame.fill( Qt::black );
+            frameTimer.start();
+            canvas.paintFrame( &frame, all );
+            iColdNs = frameTimer.nsecsElapsed();
+
+            memset( stageNs, 0, sizeof( stageNs ) );
+            canvas.m_pStageNs = stageNs;
+            for( iFrame = 0; iFrame < iFrames; iFrame++ )
+            {
+                if( replay.isEmpty() )
+                    synthesize( iFrame + 1, g_situation );
+                else
+                    g_situation = replay.at( iFrame % replay.count() );
+
+                frame.fill( Qt::black );
+                frameTimer.start();
+                canvas.paintFrame( &frame, all );
+                frameNs[iFrame] = frameTimer.nsecsElapsed();
+            }
+            canvas.m_pStageNs = nullptr;
+
+            report( QString( "%1x%2 %3" ).arg( frameSize.width() ).arg( frameSize.height() ).arg( bPortrait ? "portrait" : "landscape" ),
+                    iColdNs, frameNs, stageNs );
+        }
+    }
+
+    return 0;
+}
+
+
+// Record writes <name>.png for every scenario into the directory; compare renders them again and fails any scene with a
+// pixel channel off by more than the tolerance, leaving <name>.actual.png and <name>.diff.png next to the reference.
+// Text goes through the system fonts so references only hold for the machine (or image) they were recorded on.
+int RenderBench::golden( const QString &qsDir, bool bRecord, int iTolerance )
+{
+    QList<RenderScenario> scenes = scenarios();
+    RenderScenario        scene;
+    AHRSCanvas            canvas;
+    QDir                  dir( qsDir );
+    int                   iFailed = 0;
+
+    if( bRecord && (!dir.mkpath( "." )) )
+    {
+        qWarning() << "Cannot create" << qsDir;
+        return 1;
+    }
+
+    startup( &canvas, scenes.first().size );
+
+    foreach( scene, scenes )
+    {
+        QImage  frame( scene.size, QImage::Format_ARGB32_Premultiplied );
+        QString qsRef = dir.filePath( scene.qsName + ".png" );
+
+        // Anything that comes from config.ini is pinned so the references don't depend on who recorded them
+        prepare( &canvas, scene.size, scene.bPortrait );
+        canvas.m_dZoomNM = 10.0;
+        canvas.m_iMagDev = 0;
+        canvas.m_settings.eUnits = Canvas::Knots;
+        canvas.m_settings.iMagDev = 0;
+        canvas.m_settings.bShowAltitudes = true;
+        canvas.m_settings.bMapRasterCache = false;
+        canvas.m_settings.bHalfMode = false;
+        canvas.m_settings.bAutoRec = false;
+        canvas.m_settings.bSwitchableTanks = true;
+        canvas.m_settings.qsOwnshipID.clear();
+        canvas.m_settings.dAirspeedCal = 1.0;
+        g_eUnitsAirspeed = Canvas::Knots;
+        canvas.m_tanks = { 24.0, 24.0, 18.0, 12.0, 8.3, 9.0, 7.0, 4.0, 15, true, true, QDateTime( QDate( 2019, 1, 1 ) ) };
+        canvas.m_bDark = scene.bDark;
+        populate( &canvas, scene.iTraffic, scene.iAirports, scene.iAirspaces );
+
+        synthesize( 0, g_situation );
+        g_situation.dAHRSpitch = scene.dPitch;
+        g_situation.dAHRSroll = scene.dRoll;
+        g_situation.dAHRSGyroHeading = scene.dHeading;
+        g_situation.dAHRSMagHeading = scene.dHeading;
+
+        frame.fill( Qt::black );
+        canvas.paintFrame( &frame, QRegion( frame.rect() ) );
+
+        if( bRecord )
+        {
+            if( !frame.save( qsRef ) )
+            {
+                qWarning() << "Cannot write" << qsRef;
+                iFailed++;
+            }
+            else
+                printf( "%-28s recorded\n", qPrintable( scene.qsName ) );
+            continue;
+        }
+
+        QImage reference( qsRef );
+
+        if( reference.isNull() )
+        {
+            printf( "%-28s FAIL no reference %s\n", qPrintable( scene.qsName ), qPrintable( qsRef ) );
+            iFailed++;
+            continue;
+        }
+
+        QImage diff;
+        int    iBad = compare( reference, frame, iTolerance, &diff );
+
+        if( iBad == 0 )
+        {
+            printf( "%-28s ok\n", qPrintable( scene.qsName ) );
+            continue;
+        }
+
+        printf( "%-28s FAIL %d pixels differ\n", qPrintable( scene.qsName ), iBad );
+        frame.save( dir.filePath( scene.qsName + ".actual.png" ) );
+        diff.save( dir.filePath( scene.qsName + ".diff.png" ) );
+        iFailed++;
+    }
+
+    printf( "%d of %d scenarios %s\n", scenes.count() - iFailed, scenes.count(), bRecord ? "recorded" : "match" );
+    fflush( stdout );
+
+    return (iFailed > 0) ? 1 : 0;
+}
+
+
+// Comma separated WxH list, e.g. 800x480,1280x800,1920x1080
+QList<QSize> RenderBench::parseSizes( const QString &qsSizes )
+{
+    QList<QSize> sizes;
+    QString      qsSize;
+
+    foreach( qsSize, qsSizes.split( ',', QString::SkipEmptyParts ) )
+    {
+        QStringList qsl = qsSize.trimmed().toLower().split( 'x' );
+
+        if( qsl.count() != 2 )
+            continue;
+
+        QSize size( qsl.first().toInt(), qsl.last().toInt() );
+
+        if( (size.width() > 0) && (size.height() > 0) )
+            sizes.append( size );
+    }
+
+    return sizes;
+}
+
+
+// The widget init kicks off the airport and airspace caching; let that finish so it doesn't skew anything
+void RenderBench::startup( AHRSCanvas *pCanvas, const QSize &size )
+{
+    // Same spacing the main window sets up at startup
+    itsy.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
+    wee.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
+    tiny.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
+    med.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
+    large.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
+
+    pCanvas->resize( size );
+    pCanvas->setPortrait( size.height() > size.width() );
+    pCanvas->init();
+    QThreadPool::globalInstance()->waitForDone();
+    pCanvas->assetsReady();     // There's no event loop to deliver it
+}
+
+
+// Same path as an orientation change on the device
+void RenderBench::prepare( AHRSCanvas *pCanvas, const QSize &frameSize, bool bPortrait )
+{
+    pCanvas->resize( frameSize );
+    pCanvas->setPortrait( bPortrait );
+    pCanvas->orient2();
+    pCanvas->m_assetWatcher.waitForFinished();
+    pCanvas->assetsReady();
+}
+
+
+// Fixed seed so every run (and every resolution) draws the same scene
+void RenderBench::populate( AHRSCanvas *pCanvas, int iTraffic, int iAirports, int iAirspaces )
+{
+    double dZoom = pCanvas->m_dZoomNM;
+    int    i, iPt;
+
+    qsrand( 1 );
+
+    pCanvas->m_settings.eShowAirports = Canvas::ShowAllAirports;
+    pCanvas->m_settings.bShowPrivate = true;
+    pCanvas->m_settings.bShowRunways = true;
+    pCanvas->m_settings.bShowAirspaces = true;
+    pCanvas->m_settings.bShowAllTraffic = true;
+
+    pCanvas->m_airports.clear();
+    for( i = 0; i < iAirports; i++ )
+    {
+        Airport ap;
+
+        ap.qsID = QString( "K%1" ).arg( i, 3, 10, QChar( '0' ) );
+        ap.qsName = QString( "Bench Field %1" ).arg( i );
+        ap.dLat = 0.0;
+        ap.dLong = 0.0;
+        ap.dElev = 0.0;
+        ap.bGrass = ((i % 4) == 3);
+        ap.bd.dBearing = static_cast<double>( qrand() % 360 );
+        ap.bd.dDistance = dZoom * static_cast<double>( qrand() % 1000 ) / 1000.0;
+        ap.runways.append( (qrand() % 36) * 10 );
+        ap.runways.append( (ap.runways.first() + 180) % 360 );
+        pCanvas->m_airports.append( ap );
+    }
+
+    // Rough circles around a random point; the vertices are kept as bearing and distance from ownship like the real ones
+    pCanvas->m_airspaces.clear();
+    for( i = 0; i < iAirspaces; i++ )
+    {
+        Airspace as;
+        double   dCX = dZoom * static_cast<double>( (qrand() % 2000) - 1000 ) / 1000.0;
+        double   dCY = dZoom * static_cast<double>( (qrand() % 2000) - 1000 ) / 1000.0;
+        double   dRadius = dZoom * (0.1 + (static_cast<double>( qrand() % 400 ) / 1000.0));
+        int      iPoints = 12 + (qrand() % 36);
+
+        as.eType = static_cast<Canvas::AirspaceType>( i % (Canvas::Airspace_Danger + 1) );
+        as.qsName = QString( "BENCH %1" ).arg( i );
+        as.iAltTop = 10000;
+        as.iAltBottom = 0;
+        for( iPt = 0; iPt < iPoints; iPt++ )
+        {
+            double      dAng = static_cast<double>( iPt ) * TwoPi / static_cast<double>( iPoints );
+            double      dX = dCX + (dRadius * cos( dAng ));
+            double      dY = dCY + (dRadius * sin( dAng ));
+            BearingDist bd;
+
+            bd.dBearing = atan2( dX, dY ) * ToDeg;
+            if( bd.dBearing < 0.0 )
+                bd.dBearing += 360.0;
+            bd.dDistance = sqrt( (dX * dX) + (dY * dY) );
+            as.shapeHav.append( bd );
+        }
+        as.labelHav.dBearing = atan2( dCX, dCY ) * ToDeg;
+        if( as.labelHav.dBearing < 0.0 )
+            as.labelHav.dBearing += 360.0;
+        as.labelHav.dDistance = sqrt( (dCX * dCX) + (dCY * dCY) );
+        pCanvas->m_airspaces.append( as );
+    }
+
+    g_trafficList.clear();
+    for( i = 0; i < iTraffic; i++ )
+    {
+        StratuxTraffic t;
+
+        StreamReader::initTraffic( t );
+        t.qsTail = QString( "N%1BN" ).arg( i );
+        t.qsReg = t.qsTail;
+        t.bHasADSB = true;
+        t.bPosValid = true;
+        t.dBearing = static_cast<double>( qrand() % 360 );
+        t.dDist = dZoom * static_cast<double>( qrand() % 1000 ) / 1000.0;
+        t.dAlt = 1500.0 + static_cast<double>( qrand() % 6000 );
+        t.dTrack = static_cast<double>( qrand() % 360 );
+        t.dSpeed = 80.0 + static_cast<double>( qrand() % 200 );
+        t.dAge = 1.0;
+        t.lastActualReport = QDateTime::currentDateTime();
+        g_trafficList.append( t );
+    }
+}
+
+
+// One frame per line: pitch, roll, slip/skid, heading, ground speed, baro altitude, vertical speed, G load.
+// Blank lines and lines starting with # are skipped.
+bool RenderBench::loadReplay( const QString &qsReplay, QList<StratuxSituation> *pFrames )
+{
+    QFile file( qsReplay );
+
+    if( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        return false;
+
+    QTextStream stream( &file );
+    QString     qsLine;
+
+    while( !stream.atEnd() )
+    {
+        qsLine = stream.readLine().trimmed();
+        if( qsLine.isEmpty() || qsLine.startsWith( '#' ) )
+            continue;
+
+        QStringList      qsl = qsLine.split( ',' );
+        StratuxSituation s;
+
+        if( qsl.count() < 8 )
+            continue;
+
+        StreamReader::initSituation( s );
+        s.dAHRSpitch = qsl.at( 0 ).toDouble();
+        s.dAHRSroll = qsl.at( 1 ).toDouble();
+        s.dAHRSSlipSkid = qsl.at( 2 ).toDouble();
+        s.dAHRSGyroHeading = qsl.at( 3 ).toDouble();
+        s.dAHRSMagHeading = s.dAHRSGyroHeading;
+        s.dGPSGroundSpeed = qsl.at( 4 ).toDouble();
+        s.dBaroPressAlt = qsl.at( 5 ).toDouble();
+        s.dGPSVertSpeed = qsl.at( 6 ).toDouble();
+        s.dAHRSGLoad = qsl.at( 7 ).toDouble();
+        pFrames->append( s );
+    }
+
+    return !pFrames->isEmpty();
+}
+
+
+// Gentle maneuvering so every instrument moves each frame
+void RenderBench::synthesize( int iFrame, StratuxSituation &situation )
+{
+    double dT = static_cast<double>( iFrame );
+
+    StreamReader::initSituation( situation );
+    situation.dAHRSpitch = 10.0 * sin( dT * 0.05 );
+    situation.dAHRSroll = 30.0 * sin( dT * 0.031 );
+    situation.dAHRSSlipSkid = 5.0 * sin( dT * 0.07 );
+    situation.dAHRSGyroHeading = fmod( dT * 0.7, 360.0 );
+    situation.dAHRSMagHeading = situation.dAHRSGyroHeading;
+    situation.dGPSGroundSpeed = 110.0 + (20.0 * sin( dT * 0.013 ));
+    situation.dBaroPressAlt = 4500.0 + (500.0 * sin( dT * 0.01 ));
+    situation.dGPSVertSpeed = 1000.0 * sin( dT * 0.02 );
+    situation.dAHRSGLoad = 1.0 + (0.3 * sin( dT * 0.05 ));
+}
+
+
+// Attitude extremes, crowded maps and dark mode in both orientations; sizes are kept small so the references stay small
+QList<RenderScenario> RenderBench::scenarios()
+{
+    QList<RenderScenario> scenes;
+    QSize                 landscape( 800, 480 );
+    QSize                 portrait( 480, 800 );
+
+    // Name, size, portrait, dark, traffic, airports, airspaces, pitch, roll, heading
+    scenes.append( { "level_portrait",             portrait,  true,  false, 10,  20, 10,     0.0,    0.0,    0.0 } );
+    scenes.append( { "level_landscape",            landscape, false, false, 10,  20, 10,     0.0,    0.0,    0.0 } );
+    scenes.append( { "climb_steep_bank_portrait",  portrait,  true,  false, 10,  20, 10,    30.0,   60.0,   45.0 } );
+    scenes.append( { "climb_steep_bank_landscape", landscape, false, false, 10,  20, 10,    30.0,   60.0,   45.0 } );
+    scenes.append( { "dive_inverted_portrait",     portrait,  true,  false, 10,  20, 10,   -45.0,  179.0,  270.0 } );
+    scenes.append( { "dive_inverted_landscape",    landscape, false, false, 10,  20, 10,   -45.0, -179.0,  270.0 } );
+    scenes.append( { "dense_traffic_portrait",     portrait,  true,  false, 200, 20, 10,     2.0,  -10.0,  123.0 } );
+    scenes.append( { "dense_traffic_landscape",    landscape, false, false, 200, 20, 10,     2.0,  -10.0,  123.0 } );
+    scenes.append( { "many_airspaces_portrait",    portrait,  true,  false, 10,  50, 200,    0.0,    5.0,  300.0 } );
+    scenes.append( { "many_airspaces_landscape",   landscape, false, false, 10,  50, 200,    0.0,    5.0,  300.0 } );
+    scenes.append( { "dark_portrait",              portrait,  true,  true,  10,  20, 10,     5.0,   15.0,  180.0 } );
+    scenes.append( { "dark_landscape",             landscape, false, true,  10,  20, 10,     5.0,   15.0,  180.0 } );
+
+    return scenes;
+}
+
+
+// Counts pixels where any channel is off by more than the tolerance; the diff is the reference dimmed with those in red
+int RenderBench::compare( const QImage &reference, const QImage &frame, int iTolerance, QImage *pDiff )
+{
+    QImage ref = reference.convertToFormat( QImage::Format_ARGB32 );
+    QImage img = frame.convertToFormat( QImage::Format_ARGB32 );
+    int    iBad = 0;
+    int    x, y;
+
+    if( ref.size() != img.size() )
+    {
+        *pDiff = img;
+        return img.width() * img.height();
+    }
+
+    *pDiff = QImage( img.size(), QImage::Format_ARGB32 );
+    for( y = 0; y < img.height(); y++ )
+    {
+        const QRgb *pRef = reinterpret_cast<const QRgb *>( ref.constScanLine( y ) );
+        const QRgb *pImg = reinterpret_cast<const QRgb *>( img.constScanLine( y ) );
+        QRgb       *pOut = reinterpret_cast<QRgb *>( pDiff->scanLine( y ) );
+
+        for( x = 0; x < img.width(); x++ )
+        {
+            QRgb a = pRef[x];
+            QRgb b = pImg[x];
+
+            if( (abs( qRed( a ) - qRed( b ) ) > iTolerance) || (abs( qGreen( a ) - qGreen( b ) ) > iTolerance) ||
+                (abs( qBlue( a ) - qBlue( b ) ) > iTolerance) || (abs( qAlpha( a ) - qAlpha( b ) ) > iTolerance) )
+            {
+                pOut[x] = qRgb( 255, 0, 0 );
+                iBad++;
+            }
+            else
+            {
+                int iGray = qGray( a ) / 4;
+
+                pOut[x] = qRgb( iGray, iGray, iGray );
+            }
+        }
+    }
+
+    return iBad;
+}
+
+
+void RenderBench::report( const QString &qsLabel, qint64 iColdNs, QVector<qint64> frameNs, qint64 *pStageNs )
+{
+    int    iFrames = frameNs.count();
+    qint64 iTotal = 0;
+    qint64 iStaged = 0;
+    qint64 iNs;
+    int    i;
+
+    if( iFrames == 0 )
+        return;
+
+    foreach( iNs, frameNs )
+        iTotal += iNs;
+    std::sort( frameNs.begin(), frameNs.end() );
+
+    printf( "%-22s cold %7.2f ms  mean %6.2f  p50 %6.2f  p99 %6.2f  max %6.2f\n",
+            qPrintable( qsLabel ),
+            static_cast<double>( iColdNs ) / 1.0e6,
+            static_cast<double>( iTotal ) / static_cast<double>( iFrames ) / 1.0e6,
+            static_cast<double>( frameNs.at( (iFrames - 1) / 2 ) ) / 1.0e6,
+            static_cast<double>( frameNs.at( qMin( iFrames - 1, static_cast<int>( ceil( iFrames * 0.99 ) ) - 1 ) ) ) / 1.0e6,
+            static_cast<double>( frameNs.last() ) / 1.0e6 );
+
+    // Mean per frame for each instrument; whatever isn't inside an instrument (alerts, timer, painter setup) is "other"
+    printf( "%-22s", "" );
+    for( i = 0; i < AHRSCanvas::RegionCount; i++ )
+    {
+        printf( " %s %.2f", g_pStageNames[i], static_cast<double>( pStageNs[i] ) / static_cast<double>( iFrames ) / 1.0e6 );
+        iStaged += pStageNs[i];
+    }
+    printf( " other %.2f\n", static_cast<double>( iTotal - iStaged ) / static_cast<double>( iFrames ) / 1.0e6 );
+    fflush( stdout );
+}
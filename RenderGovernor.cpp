@@ -0,0 +1,237 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QTimerEvent>
+#include <QFile>
+#include <QStringList>
+
+#include <math.h>
+
+#include "RenderGovernor.h"
+#include "SettingsStore.h"
+#include "StratofierDefs.h"
+
+
+extern SettingsStore *g_pSettings;
+
+
+// Rates of change that count as fully manoeuvring; anything steadier scales down from there
+static const double g_dFullRollRate = 10.0;     // deg/sec
+static const double g_dFullPitchRate = 5.0;     // deg/sec
+static const double g_dFullTurnRate = 3.0;      // deg/sec (standard rate)
+static const double g_dFullSpeedRate = 2.0;     // kts/sec
+static const double g_dFullClimbRate = 10.0;    // ft/sec
+static const double g_dFullGLoadRate = 0.5;     // G/sec
+static const double g_dFullTrafficRate = 0.05;  // Map radii/sec a target moves across the map
+static const double g_dFullClosureRate = 0.05;  // NM/sec (180 kts) closing
+static const double g_dSettleSecs = 1.5;        // Time constant for easing back down to the idle rate
+
+
+RenderGovernor::RenderGovernor( QObject *pParent )
+    : QObject( pParent ),
+      m_dActivity( 1.0 ),
+      m_iFrameTimer( 0 ),
+      m_iStatsTimer( 0 ),
+      m_iFrames( 0 ),
+      m_dFPS( 0.0 ),
+      m_dFrameMs( 0.0 ),
+      m_iCpuBusy( 0 ),
+      m_iCpuTotal( 0 ),
+      m_iCpuPercent( -1 ),
+      m_dCpuTemp( -1.0 ),
+      m_iCpuMHz( -1 ),
+      m_bThrottled( false )
+{
+    m_bEnabled = g_pSettings->value( "RenderGovernor", true ).toBool();
+    m_iIdleMs = 1000 / qMax( 1, g_pSettings->value( "GovernorIdleHz", 5 ).toInt() );
+    m_iBusyMs = 1000 / qMax( 1, g_pSettings->value( "GovernorMaxHz", 30 ).toInt() );
+    if( m_iBusyMs > m_iIdleMs )
+        m_iBusyMs = m_iIdleMs;
+
+    m_sinceFrame.start();
+    m_sinceSample.start();
+    m_fpsClock.start();
+}
+
+
+RenderGovernor::~RenderGovernor()
+{
+}
+
+
+// How long to hold repaints for right now
+int RenderGovernor::interval()
+{
+    return m_iBusyMs + static_cast<int>( (1.0 - m_dActivity) * static_cast<double>( m_iIdleMs - m_iBusyMs ) );
+}
+
+
+// Any movement jumps straight to its level; steady flight decays from there so a short pause mid-turn doesn't drop the rate
+void RenderGovernor::situation( const StratuxSituation &prev, const StratuxSituation &curr )
+{
+    double dSecs = static_cast<double>( m_sinceSample.restart() ) / 1000.0;
+    double dTurn = fabs( curr.dAHRSGyroHeading - prev.dAHRSGyroHeading );
+    double dActivity;
+
+    if( dSecs <= 0.0 )
+        return;
+
+    if( dTurn > 180.0 )
+        dTurn = 360.0 - dTurn;
+
+    dActivity = fabs( curr.dAHRSroll - prev.dAHRSroll ) / dSecs / g_dFullRollRate;
+    dActivity = qMax( dActivity, fabs( curr.dAHRSpitch - prev.dAHRSpitch ) / dSecs / g_dFullPitchRate );
+    dActivity = qMax( dActivity, dTurn / dSecs / g_dFullTurnRate );
+    dActivity = qMax( dActivity, fabs( curr.dGPSGroundSpeed - prev.dGPSGroundSpeed ) / dSecs / g_dFullSpeedRate );
+    dActivity = qMax( dActivity, fabs( curr.dBaroPressAlt - prev.dBaroPressAlt ) / dSecs / g_dFullClimbRate );
+    dActivity = qMax( dActivity, fabs( curr.dAHRSGLoad - prev.dAHRSGLoad ) / dSecs / g_dFullGLoadRate );
+
+    m_dActivity = qMin( 1.0, qMax( dActivity, m_dActivity * exp( -dSecs / g_dSettleSecs ) ) );
+}
+
+
+// Traffic reports come one aircraft at a time so each one can only raise the level; the situation updates ease it back
+// down. Only targets on the map count and the movement is measured where it shows, relative to the zoom.
+void RenderGovernor::traffic( const StratuxTraffic &prev, const StratuxTraffic &curr, double dZoomNM )
+{
+    double dSecs = static_cast<double>( prev.lastActualReport.msecsTo( curr.lastActualReport ) ) / 1000.0;
+    double dPrevX, dPrevY, dCurrX, dCurrY, dMove;
+    double dActivity;
+
+    if( (dSecs <= 0.0) || (dZoomNM <= 0.0) || (!prev.bPosValid) || (!curr.bPosValid) ||
+        ((prev.dDist > dZoomNM) && (curr.dDist > dZoomNM)) )
+        return;
+
+    dPrevX = prev.dDist * sin( prev.dBearing * ToRad );
+    dPrevY = prev.dDist * cos( prev.dBearing * ToRad );
+    dCurrX = curr.dDist * sin( curr.dBearing * ToRad );
+    dCurrY = curr.dDist * cos( curr.dBearing * ToRad );
+
+    dMove = sqrt( ((dCurrX - dPrevX) * (dCurrX - dPrevX)) + ((dCurrY - dPrevY) * (dCurrY - dPrevY)) );
+
+    dActivity = dMove / dZoomNM / dSecs / g_dFullTrafficRate;
+    dActivity = qMax( dActivity, (prev.dDist - curr.dDist) / dSecs / g_dFullClosureRate );
+
+    m_dActivity = qMin( 1.0, qMax( dActivity, m_dActivity ) );
+}
+
+
+// Something on screen changed; the frame goes out now if it's been long enough (or it can't wait), otherwise once the
+// current interval is up. Requests in between just ride along with that one.
+void RenderGovernor::request( bool bUrgent )
+{
+    if( bUrgent || (!m_bEnabled) || (m_sinceFrame.elapsed() >= interval()) )
+    {
+        due();
+        return;
+    }
+
+    if( m_iFrameTimer == 0 )
+        m_iFrameTimer = startTimer( qMax( 1, interval() - static_cast<int>( m_sinceFrame.elapsed() ) ), Qt::PreciseTimer );
+}
+
+
+void RenderGovernor::due()
+{
+    if( m_iFrameTimer != 0 )
+    {
+        killTimer( m_iFrameTimer );
+        m_iFrameTimer = 0;
+    }
+
+    m_sinceFrame.restart();
+    emit frameDue();
+}
+
+
+void RenderGovernor::frameDone( qint64 iFrameNs )
+{
+    double dMs = static_cast<double>( iFrameNs ) / 1000000.0;
+
+    m_dFrameMs = (m_dFrameMs == 0.0) ? dMs : ((m_dFrameMs * 0.9) + (dMs * 0.1));
+    m_iFrames++;
+}
+
+
+void RenderGovernor::showStats( bool bShow )
+{
+    if( bShow && (m_iStatsTimer == 0) )
+    {
+        m_iFrames = 0;
+        m_fpsClock.restart();
+        readStats();
+        m_iStatsTimer = startTimer( 1000 );
+    }
+    else if( (!bShow) && (m_iStatsTimer != 0) )
+    {
+        killTimer( m_iStatsTimer );
+        m_iStatsTimer = 0;
+    }
+}
+
+
+void RenderGovernor::timerEvent( QTimerEvent *pEvent )
+{
+    if( pEvent == nullptr )
+        return;
+
+    if( pEvent->timerId() == m_iFrameTimer )
+        due();
+    else if( pEvent->timerId() == m_iStatsTimer )
+    {
+        m_dFPS = static_cast<double>( m_iFrames ) * 1000.0 / static_cast<double>( qMax( Q_INT64_C( 1 ), m_fpsClock.restart() ) );
+        m_iFrames = 0;
+        readStats();
+        emit statsChanged();
+    }
+}
+
+
+// Linux (so the Pi and mostly Android) keeps these in /proc and /sys; anything that can't be read is left as unknown
+void RenderGovernor::readStats()
+{
+    QFile stat( "/proc/stat" );
+
+    if( stat.open( QIODevice::ReadOnly ) )
+    {
+        QStringList fields = QString( stat.readLine() ).simplified().split( ' ' );
+
+        // cpu user nice system idle iowait irq softirq ...
+        if( (fields.count() > 5) && (fields.first() == "cpu") )
+        {
+            qint64 iTotal = 0;
+            qint64 iIdle = fields.at( 4 ).toLongLong() + fields.at( 5 ).toLongLong();
+            int    i;
+
+            for( i = 1; i < fields.count(); i++ )
+                iTotal += fields.at( i ).toLongLong();
+
+            if( (m_iCpuTotal > 0) && (iTotal > m_iCpuTotal) )
+                m_iCpuPercent = static_cast<int>( ((iTotal - iIdle) - m_iCpuBusy) * 100 / (iTotal - m_iCpuTotal) );
+            m_iCpuBusy = iTotal - iIdle;
+            m_iCpuTotal = iTotal;
+        }
+    }
+
+    QFile temp( "/sys/class/thermal/thermal_zone0/temp" );
+
+    if( temp.open( QIODevice::ReadOnly ) )
+        m_dCpuTemp = temp.readAll().trimmed().toDouble() / 1000.0;
+
+    QFile freq( "/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq" );
+
+    if( freq.open( QIODevice::ReadOnly ) )
+        m_iCpuMHz = freq.readAll().trimmed().toInt() / 1000;
+
+    // The Pi firmware reports under-voltage and thermal capping directly (bits 0-3 are what's happening now); elsewhere
+    // go by the usual soft limit temperature
+    QFile throttled( "/sys/devices/platform/soc/soc:firmware/get_throttled" );
+
+    if( throttled.open( QIODevice::ReadOnly ) )
+        m_bThrottled = (throttled.readAll().trimmed().toInt( nullptr, 16 ) & 0xF) != 0;
+    else
+        m_bThrottled = m_dCpuTemp >= 80.0;
+}
@@ -3,14 +3,12 @@ Stratofier Stratux AHRS Display
 (c) 2018 Allen K. Lair, Sky Fun
 */
 
-#include <QSettings>
 #include <QtDebug>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QFile>
 #include <QDir>
 #include <QString>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include "SettingsDialog.h"
 #include "Builder.h"
@@ -18,17 +16,19 @@ Stratofier Stratux AHRS Display
 #include "CountryDialog.h"
 #include "ClickLabel.h"
 #include "Canvas.h"
+#include "DownloadManager.h"
+#include "AipParser.h"
+#include "SettingsStore.h"
 
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 
 SettingsDialog::SettingsDialog( QWidget *pParent, Canvas *pCanvas, CanvasConstants *pC )
     : QDialog( pParent, Qt::Dialog | Qt::FramelessWindowHint ),
-      m_iTally( 0 ),
       m_pC( pC ),
-      m_mapItAirports( m_mapUrlsAirports ),
-      m_mapItAirspaces( m_mapUrlsAirspaces )
+      m_bRecacheAirports( false ),
+      m_bRecacheAirspaces( false )
 {
     setupUi( this );
 
@@ -52,11 +52,19 @@ SettingsDialog::SettingsDialog( QWidget *pParent, Canvas *pCanvas, CanvasConstan
     m_pMagDevLabel->setText( QString::number( m_settings.iMagDev ) );
 
     connect( m_pSwitchableButton, SIGNAL( clicked() ), this, SLOT( switchable() ) );
+    connect( m_pMapCacheButton, SIGNAL( clicked() ), this, SLOT( mapCache() ) );
 
     connect( m_pMagDevLessButton, SIGNAL( clicked() ), this, SLOT( magDevChange() ) );
     connect( m_pMagDevMoreButton, SIGNAL( clicked() ), this, SLOT( magDevChange() ) );
 
-    connect( m_pGetButton, SIGNAL( clicked() ), this, SLOT( getMapDataAirports() ) );
+    m_pDownloads = new DownloadManager( this );
+    connect( m_pDownloads, SIGNAL( transferStarted( const QString&, const QString&, qint64 ) ), this, SLOT( downloadStarted( const QString&, const QString&, qint64 ) ) );
+    connect( m_pDownloads, SIGNAL( transferData( const QString&, const QByteArray& ) ), this, SLOT( downloadData( const QString&, const QByteArray& ) ) );
+    connect( m_pDownloads, SIGNAL( progress( qint64, qint64 ) ), this, SLOT( downloadProgress( qint64, qint64 ) ) );
+    connect( m_pDownloads, SIGNAL( fileFinished( const QString&, bool ) ), this, SLOT( downloadFileFinished( const QString&, bool ) ) );
+    connect( m_pDownloads, SIGNAL( finished( bool ) ), this, SLOT( downloadsFinished( bool ) ) );
+
+    connect( m_pGetButton, SIGNAL( clicked() ), this, SLOT( getMapData() ) );
 
     connect( m_pSelCountriesButton, SIGNAL( clicked() ), this, SLOT( selCountries() ) );
 
@@ -68,6 +76,7 @@ SettingsDialog::SettingsDialog( QWidget *pParent, Canvas *pCanvas, CanvasConstan
 
 SettingsDialog::~SettingsDialog()
 {
+    qDeleteAll( m_parsers );
     saveSettings();
 }
 
@@ -78,32 +87,27 @@ void SettingsDialog::init()
     QSize iconSize( static_cast<int>( static_cast<double>( iBtnHeight ) / 2.0 * 2.3 ), iBtnHeight / 2 );
 
     m_pSwitchableButton->setIconSize( iconSize );
+    m_pMapCacheButton->setIconSize( iconSize );
 }
 
 
 void SettingsDialog::loadSettings()
 {
-    QVariantList countries;
-    QVariant     country;
+    StratofierSettings settings = g_pSettings->settings();
 
     // Persistent settings
-    m_settings.iCurrDataSet = g_pSet->value( "CurrDataSet", 0 ).toInt();
-    m_settings.qsStratuxIP = g_pSet->value( "StratuxIP", "192.168.10.1" ).toString();
-    m_settings.qsOwnshipID = g_pSet->value( "OwnshipID", QString() ).toString();
-    m_settings.iMagDev = g_pSet->value( "MagDev", 0 ).toInt();
-    m_settings.dAirspeedCal = g_pSet->value( "AirspeedCal", 1.0 ).toDouble();
-    countries = g_pSet->value( "CountryAirports", countries ).toList();
-    m_settings.listAirports.clear();
-    foreach( country, countries )
-        m_settings.listAirports.append( static_cast<Canvas::CountryCodeAirports>( country.toInt() ) );
-    countries = g_pSet->value( "CountryAirspaces", countries ).toList();
-    m_settings.listAirspaces.clear();
-    foreach( country, countries )
-        m_settings.listAirspaces.append( static_cast<Canvas::CountryCodeAirspace>( country.toInt() ) );
-    g_pSet->beginGroup( "FuelTanks" );
-    m_settings.bSwitchableTanks = (!g_pSet->value( "DualTanks" ).toBool());
-    g_pSet->endGroup();
+    m_settings.iCurrDataSet = settings.iCurrDataSet;
+    m_settings.qsStratuxIP = settings.qsStratuxIP;
+    m_settings.qsOwnshipID = settings.qsOwnshipID;
+    m_settings.iMagDev = settings.iMagDev;
+    m_settings.dAirspeedCal = settings.dAirspeedCal;
+    m_settings.listAirports = settings.listAirports;
+    m_settings.listAirspaces = settings.listAirspaces;
+    m_settings.bSwitchableTanks = (!settings.bSwitchableTanks);
     switchable();
+    // Only shown here; it's saved when it's tapped
+    m_settings.bMapRasterCache = settings.bMapRasterCache;
+    m_pMapCacheButton->setIcon( m_settings.bMapRasterCache ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
     m_pIPClickLabel->setText( m_settings.qsStratuxIP );
     m_pOwnshipClickLabel->setText( m_settings.qsOwnshipID );
 
@@ -134,88 +138,39 @@ void SettingsDialog::magDevChange()
 }
 
 
-void SettingsDialog::getMapDataAirports()
+// Queue every selected country's airports and airspace and let the download manager run a few at a time. While that's
+// going the button shows the cancel icon and pressing it again stops the lot; the parts stay for the next try.
+void SettingsDialog::getMapData()
 {
-    if( m_settings.listAirports.count() == 0 )
-        return;
-
-    QString qsUrl, qsFile, qsValue;
-
-    m_pManager = new QNetworkAccessManager( this );
-
-    m_mapItAirports = m_mapUrlsAirports;
-    if( !nextCountryAirport() )
-        return;
-
-    qsUrl = "http://skyfun.space/stratofier/openaip_" + m_mapItAirports.value() + ".aip";
-    qsValue = m_mapItAirports.value();
-    m_pDataProgress->setFormat( QString( "%p% %1 AP" ).arg( qsValue.right( 2 ).toUpper() ) );
-
-    qsFile = settingsRoot() + "/space.skyfun.stratofier/" + m_mapItAirports.value() + ".aip";
-    m_url = qsUrl;
-    m_pFile = new QFile( qsFile );
-    m_iTally = 0;
-
-    m_pDataProgress->setMaximum( 100 );
-    m_pDataProgress->setValue( 0 );
-
-    // Something is wrong with the file path or permissions
-    if( !m_pFile->open( QIODevice::WriteOnly) )
-    {
-        delete m_pFile;
-        m_pFile = nullptr;
-        m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
-    }
-    else
+    if( m_pDownloads->isRunning() )
     {
-        m_pDataProgress->show();
-        startRequestAirports( m_url );
-    }
-}
-
-
-void SettingsDialog::getMapDataAirspace()
-{
-    QObject *pSender = sender();
-
-    if( pSender == nullptr )
+        m_pDownloads->cancel();
+        qDeleteAll( m_parsers );
+        m_parsers.clear();
+        downloadsFinished( false );
         return;
+    }
 
-    if( m_settings.listAirspaces.count() == 0 )
-        return;
-
-    QString qsUrl, qsFile, qsValue;
-
-    m_pManager = new QNetworkAccessManager( this );
-
-    m_mapItAirspaces = m_mapUrlsAirspaces;
-    if( !nextCountryAirspace() )
+    if( (m_settings.listAirports.count() == 0) && (m_settings.listAirspaces.count() == 0) )
         return;
 
-    qsUrl = "http://skyfun.space/stratofier/openaip_" + m_mapItAirspaces.value() + ".aip";
-    qsValue = m_mapItAirspaces.value();
-    m_pDataProgress->setFormat( QString( "%p% %1 AS" ).arg( qsValue.right( 2 ).toUpper() ) );
+    Canvas::CountryCodeAirports countryAirport;
+    Canvas::CountryCodeAirspace countryAirspace;
+    QString                     qsFileRoot = settingsRoot() + "/space.skyfun.stratofier/";
 
-    qsFile = settingsRoot() + "/space.skyfun.stratofier/" + m_mapItAirspaces.value() + ".aip";
-    m_url = qsUrl;
-    m_pFile = new QFile( qsFile );
-    m_iTally = 0;
+    m_pDownloads->setBaseUrl( DownloadManager::defaultBaseUrl() );
+    foreach( countryAirport, m_settings.listAirports )
+        m_pDownloads->enqueue( m_mapUrlsAirports[countryAirport], qsFileRoot + m_mapUrlsAirports[countryAirport] + ".aip" );
+    foreach( countryAirspace, m_settings.listAirspaces )
+        m_pDownloads->enqueue( m_mapUrlsAirspaces[countryAirspace], qsFileRoot + m_mapUrlsAirspaces[countryAirspace] + ".aip" );
 
+    m_pDataProgress->setFormat( "%p%" );
     m_pDataProgress->setMaximum( 100 );
     m_pDataProgress->setValue( 0 );
+    m_pDataProgress->show();
+    m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
 
-    // Something is wrong with the file path or permissions
-    if( !m_pFile->open( QIODevice::WriteOnly) )
-    {
-        delete m_pFile;
-        m_pFile = nullptr;
-        m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
-    }
-    else
-    {
-        m_pDataProgress->show();
-        startRequestAirspace( m_url );
-    }
+    m_pDownloads->start();
 }
 
 
@@ -265,173 +220,103 @@ void SettingsDialog::storage()
 }
 
 
-void SettingsDialog::httpReadyRead()
+// Scaled down to percent since the combined byte count of several countries overflows the progress bar's int
+void SettingsDialog::downloadProgress( qint64 iReceived, qint64 iTotal )
 {
-    if( m_pFile != nullptr )
-        m_pFile->write( m_pReply->readAll() );
-}
-
+    if( iTotal <= 0 )
+        return;
 
-void SettingsDialog::updateDownloadProgressAirports( qint64 bytesRead, qint64 totalBytes )
-{
-    m_pDataProgress->setMaximum( static_cast<int>( totalBytes ) );
-    m_pDataProgress->setValue( static_cast<int>( bytesRead ) );
+    m_pDataProgress->setValue( static_cast<int>( iReceived * 100 / iTotal ) );
 }
 
 
-void SettingsDialog::updateDownloadProgressAirspace( qint64 bytesRead, qint64 totalBytes )
+// Each dataset gets its own parser that's fed as the bytes come in. A resumed transfer replays what's already in the
+// part file first so the parser always sees the document from the top.
+void SettingsDialog::downloadStarted( const QString &qsName, const QString &qsPart, qint64 iResumeFrom )
 {
-    m_pDataProgress->setMaximum( static_cast<int>( totalBytes ) );
-    m_pDataProgress->setValue( static_cast<int>( bytesRead ) );
-}
-
+    AipParser *pParser = m_parsers.value( qsName, nullptr );
 
-// When download finished or canceled, this will be called
-void SettingsDialog::httpDownloadFinishedAirports()
-{
-    QString qsRoot( "http://skyfun.space/stratofier/" );
-    QString qsFileRoot = settingsRoot() + "/space.skyfun.stratofier/";
-    QString qsUrl;
-    QString qsFile;
-    QString qsValue;
-
-    m_pFile->flush();
-    m_pFile->close();
-
-    m_pReply->deleteLater();
-    m_pReply = nullptr;
-    delete m_pFile;
-    m_pFile = nullptr;
-    m_iTally++;
-
-    if( !m_mapItAirports.hasNext() )
+    if( pParser == nullptr )
     {
-        m_pDataProgress->setFormat( "%p%" );
-        if( m_iTally >= m_settings.listAirports.count() )
-        {
-            m_iTally = 0;
-            QTimer::singleShot( 100, this, SLOT( getMapDataAirspace() ) );
-        }
-        m_pManager = nullptr;
+        pParser = new AipParser;
+        m_parsers.insert( qsName, pParser );
     }
-    else
+    pParser->reset();
+
+    if( iResumeFrom <= 0 )
+        return;
+
+    QFile  part( qsPart );
+    qint64 iLeft = iResumeFrom;
+
+    if( !part.open( QIODevice::ReadOnly ) )
+        return;
+
+    while( (iLeft > 0) && (!part.atEnd()) )
     {
-        if( !nextCountryAirport() )
-        {
-            if( m_iTally >= m_settings.listAirports.count() )
-            {
-                m_iTally = 0;
-                QTimer::singleShot( 100, this, SLOT( getMapDataAirspace() ) );
-            }
-            m_pManager = nullptr;
-            return;
-        }
-        m_pDataProgress->setValue( 0 );
-        qsValue = m_mapItAirports.value();
-        m_pDataProgress->setFormat( QString( "%p% %1 AP" ).arg( qsValue.right( 2 ).toUpper() ) );
-        qsUrl = qsRoot + "openaip_" + m_mapItAirports.value() + ".aip";
-        qsFile = qsFileRoot + m_mapItAirports.value() + ".aip";
-        m_url = qsUrl;
-        m_pFile = new QFile( qsFile );
-
-        // Something is wrong with the file path or permissions
-        if( !m_pFile->open( QIODevice::WriteOnly) )
-        {
-            delete m_pFile;
-            m_pFile = nullptr;
-            m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
-        }
-        else
-            startRequestAirports( m_url );
+        QByteArray data = part.read( qMin( iLeft, static_cast<qint64>( 65536 ) ) );
+
+        pParser->addData( data );
+        iLeft -= data.size();
     }
+    part.close();
 }
 
 
-// When download finished or canceled, this will be called
-void SettingsDialog::httpDownloadFinishedAirspace()
+void SettingsDialog::downloadData( const QString &qsName, const QByteArray &data )
 {
-    QString qsRoot( "http://skyfun.space/stratofier/" );
-    QString qsFileRoot = settingsRoot() + "/space.skyfun.stratofier/";
-    QString qsUrl;
-    QString qsFile;
-    QString qsValue;
+    AipParser *pParser = m_parsers.value( qsName, nullptr );
 
-    m_pFile->flush();
-    m_pFile->close();
+    if( pParser != nullptr )
+        pParser->addData( data );
+}
 
-    m_pReply->deleteLater();
-    m_pReply = nullptr;
-    delete m_pFile;
-    m_pFile = nullptr;
-    m_iTally++;
 
-    m_pDataProgress->setValue( m_iTally );
+// The records are already parsed by the time the file is verified so they go straight into the index and the live caches
+void SettingsDialog::downloadFileFinished( const QString &qsName, bool bOK )
+{
+    AipParser *pParser = m_parsers.take( qsName );
 
-    if( !m_mapItAirspaces.hasNext() )
-    {
-        if( m_iTally >= m_settings.listAirspaces.count() )
-        {
-            m_pDataProgress->hide();
-            m_pGetButton->setIcon( QIcon( ":/icons/resources/OK.png" ) );
-        }
-        m_pManager = nullptr;
-    }
-    else
+    if( !bOK )
+        qDebug() << "Dataset download failed" << qsName;
+
+    if( pParser == nullptr )
+        return;
+
+    // If the stream didn't parse cleanly the file gets a full parse the next time the caches load
+    if( bOK && pParser->isComplete() && (!pParser->hasError()) )
     {
-        if( !nextCountryAirspace() )
-        {
-            if( m_iTally >= m_settings.listAirspaces.count() )
-            {
-                m_pDataProgress->hide();
-                m_pGetButton->setIcon( QIcon( ":/icons/resources/OK.png" ) );
-            }
-            m_pManager = nullptr;
-            return;
-        }
-        m_pDataProgress->setValue( 0 );
-        qsValue = m_mapItAirspaces.value();
-        m_pDataProgress->setFormat( QString( "%p% %1 AS" ).arg( qsValue.right( 2 ).toUpper() ) );
-        qsUrl = qsRoot + "openaip_" + m_mapItAirspaces.value() + ".aip";
-        qsFile = qsFileRoot + m_mapItAirspaces.value() + ".aip";
-        m_url = qsUrl;
-        m_pFile = new QFile( qsFile );
-
-        // Something is wrong with the file path or permissions
-        if( !m_pFile->open( QIODevice::WriteOnly) )
+        QString         qsFile = settingsRoot() + "/space.skyfun.stratofier/" + qsName + ".aip";
+        QList<Airport>  airports = pParser->takeAirports();
+        QList<Airspace> airspaces = pParser->takeAirspaces();
+
+        AipParser::writeIndex( AipParser::indexPath( qsFile ), airports, airspaces );
+
+        if( qsName.startsWith( "airports" ) )
         {
-            delete m_pFile;
-            m_pFile = nullptr;
-            m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
+            if( !TrafficMath::mergeAirports( qsName, airports ) )
+                m_bRecacheAirports = true;
         }
-        else
-            startRequestAirspace( m_url );
+        else if( !TrafficMath::mergeAirspaces( qsName, airspaces ) )
+            m_bRecacheAirspaces = true;
     }
-}
-
-
-// This will be called when download button is clicked
-void SettingsDialog::startRequestAirports( QUrl url )
-{
-    m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
-
-    m_pReply = m_pManager->get( QNetworkRequest( url ) );
 
-    connect( m_pReply, SIGNAL( readyRead() ), this, SLOT( httpReadyRead() ) );
-    connect( m_pReply, SIGNAL( downloadProgress( qint64, qint64 ) ), this, SLOT( updateDownloadProgressAirports( qint64, qint64 ) ) );
-    connect( m_pReply, SIGNAL( finished() ), this, SLOT( httpDownloadFinishedAirports() ) );
+    delete pParser;
 }
 
 
-// This will be called when download button is clicked
-void SettingsDialog::startRequestAirspace( QUrl url )
+void SettingsDialog::downloadsFinished( bool bAllOK )
 {
-    m_pGetButton->setIcon( QIcon( ":/icons/resources/Cancel.png" ) );
-
-    m_pReply = m_pManager->get( QNetworkRequest( url ) );
-
-    connect( m_pReply, SIGNAL( readyRead() ), this, SLOT( httpReadyRead() ) );
-    connect( m_pReply, SIGNAL( downloadProgress( qint64, qint64 ) ), this, SLOT( updateDownloadProgressAirspace( qint64, qint64 ) ) );
-    connect( m_pReply, SIGNAL( finished() ), this, SLOT( httpDownloadFinishedAirspace() ) );
+    m_pDataProgress->hide();
+    m_pGetButton->setIcon( bAllOK ? QIcon( ":/icons/resources/OK.png" ) : QIcon( ":/icons/resources/Cancel.png" ) );
+
+    // Countries that were already loaded were replaced on disk so reload them from their new indexes
+    if( m_bRecacheAirports )
+        TrafficMath::cacheAirports();
+    if( m_bRecacheAirspaces )
+        TrafficMath::cacheAirspaces();
+    m_bRecacheAirports = false;
+    m_bRecacheAirspaces = false;
 }
 
 
@@ -454,15 +339,24 @@ void SettingsDialog::switchable()
 {
     m_settings.bSwitchableTanks = (!m_settings.bSwitchableTanks);
 
-    g_pSet->beginGroup( "FuelTanks" );
-    g_pSet->setValue( "DualTanks", m_settings.bSwitchableTanks );
-    g_pSet->endGroup();
-    g_pSet->sync();
+    g_pSettings->setValue( "FuelTanks/DualTanks", m_settings.bSwitchableTanks );
 
     m_pSwitchableButton->setIcon( m_settings.bSwitchableTanks ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
 }
 
 
+// Keep the airspace and airport layers as north-up rasters that are only turned with the heading; easier on slow devices
+// at the cost of the labels turning with the map
+void SettingsDialog::mapCache()
+{
+    m_settings.bMapRasterCache = (!m_settings.bMapRasterCache);
+
+    g_pSettings->setValue( "MapRasterCache", m_settings.bMapRasterCache );
+
+    m_pMapCacheButton->setIcon( m_settings.bMapRasterCache ? QIcon( ":/icons/resources/on.png" ) : QIcon( ":/icons/resources/off.png" ) );
+}
+
+
 void SettingsDialog::selCountries()
 {
     CountryDialog dlg( this, m_pC );
@@ -488,8 +382,11 @@ void SettingsDialog::selCountries()
         {
             qsFile = settingsRoot() + "/space.skyfun.stratofier/" + m_mapUrlsAirports[countryAirport] + ".aip";
             QFile::remove( qsFile );
+            QFile::remove( qsFile + ".part" );
+            QFile::remove( qsFile + ".part.tag" );
+            QFile::remove( AipParser::indexPath( qsFile ) );
         }
-        g_pSet->setValue( "CountryAirports", countries );
+        g_pSettings->setValue( "CountryAirports", countries );
         countries.clear();
         foreach( countryAirspace, m_settings.listAirspaces )
             countries.append( static_cast<int>( countryAirspace ) );
@@ -497,74 +394,21 @@ void SettingsDialog::selCountries()
         {
             qsFile = settingsRoot() + "/space.skyfun.stratofier/" + m_mapUrlsAirspaces[countryAirspace] + ".aip";
             QFile::remove( qsFile );
+            QFile::remove( qsFile + ".part" );
+            QFile::remove( qsFile + ".part.tag" );
+            QFile::remove( AipParser::indexPath( qsFile ) );
         }
-        g_pSet->setValue( "CountryAirspaces", countries );
-        g_pSet->sync();
+        g_pSettings->setValue( "CountryAirspaces", countries );
     }
 }
 
 
-bool SettingsDialog::nextCountryAirport()
-{
-    Canvas::CountryCodeAirports country;
-    bool                        bFound = false;
-
-    // Move the iterator to the next selected country
-    while( m_mapItAirports.hasNext() )
-    {
-        m_mapItAirports.next();
-        foreach( country, m_settings.listAirports )
-        {
-            if( m_mapItAirports.key() == country )
-            {
-                bFound = true;
-                break;
-            }
-        }
-        if( bFound )
-            break;
-    }
-
-    return bFound;
-}
-
-
-bool SettingsDialog::nextCountryAirspace()
-{
-    Canvas::CountryCodeAirspace country;
-    bool                        bFound = false;
-
-    // Move the iterator to the next selected country
-    while( m_mapItAirspaces.hasNext() )
-    {
-        m_mapItAirspaces.next();
-        foreach( country, m_settings.listAirspaces )
-        {
-            if( m_mapItAirspaces.key() == country )
-            {
-                bFound = true;
-                break;
-            }
-        }
-        if( bFound )
-            break;
-    }
-
-    return bFound;
-}
-
-
 void SettingsDialog::saveSettings()
 {
-    g_pSet->setValue( "CurrDataSet", m_settings.iCurrDataSet );
-
-    g_pSet->setValue( "StratuxIP", m_pIPClickLabel->text().simplified().remove( ' ' ) );
-    g_pSet->setValue( "OwnshipID", m_pOwnshipClickLabel->text().simplified().toUpper().remove( ' ' ) );
-    g_pSet->setValue( "MagDev", m_settings.iMagDev );
-
-    g_pSet->beginGroup( "FuelTanks" );
-    g_pSet->setValue( "DualTanks", m_settings.bSwitchableTanks );
-    g_pSet->endGroup();
+    g_pSettings->setValue( "CurrDataSet", m_settings.iCurrDataSet );
 
-    g_pSet->sync();
+    g_pSettings->setValue( "StratuxIP", m_pIPClickLabel->text().simplified().remove( ' ' ) );
+    g_pSettings->setValue( "OwnshipID", m_pOwnshipClickLabel->text().simplified().toUpper().remove( ' ' ) );
+    g_pSettings->setValue( "MagDev", m_settings.iMagDev );
+    g_pSettings->setValue( "FuelTanks/DualTanks", m_settings.bSwitchableTanks );
 }
@@ -0,0 +1,172 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QTimerEvent>
+#include <QSettings>
+
+#include "SettingsStore.h"
+
+
+extern QSettings *g_pSet;
+
+
+static const int g_iWriteDelayMs = 500;
+
+
+SettingsStore::SettingsStore( QObject *pParent )
+    : QObject( pParent ),
+      m_dZoomNM( 10.0 ),
+      m_iWriteTimer( 0 )
+{
+    QMutexLocker lock( &m_mutex );
+
+    read( "ZoomNM", 10.0 );
+    read( "ShowAllTraffic", true );
+    read( "ShowAirports", static_cast<int>( Canvas::ShowPavedAirports ) );
+    read( "ShowPrivate", false );
+    read( "ShowRunways", true );
+    read( "ShowAirspaces", true );
+    read( "ShowAltitudes", true );
+    read( "AutoRec", false );
+    read( "MapRasterCache", false );
+    read( "HalfMode", false );
+    read( "CurrDataSet", 0 );
+    read( "StratuxIP", "192.168.10.1" );
+    read( "OwnshipID", QString() );
+    read( "MagDev", 0 );
+    read( "AirspeedCal", 1.0 );
+    read( "UnitsAirspeed", static_cast<int>( Canvas::Knots ) );
+    read( "CountryAirports", QVariantList() );
+    read( "CountryAirspaces", QVariantList() );
+    read( "FuelTanks/DualTanks", true );
+    rebuild();
+}
+
+
+SettingsStore::~SettingsStore()
+{
+    flush();
+}
+
+
+StratofierSettings SettingsStore::settings()
+{
+    QMutexLocker lock( &m_mutex );
+
+    return m_settings;
+}
+
+
+double SettingsStore::zoomNM()
+{
+    QMutexLocker lock( &m_mutex );
+
+    return m_dZoomNM;
+}
+
+
+// Anything that isn't part of the snapshot is read through the first time it's asked for and kept from then on
+QVariant SettingsStore::value( const QString &qsKey, const QVariant &defaultValue )
+{
+    QMutexLocker lock( &m_mutex );
+
+    if( !m_values.contains( qsKey ) )
+        read( qsKey, defaultValue );
+
+    return m_values.value( qsKey );
+}
+
+
+void SettingsStore::setValue( const QString &qsKey, const QVariant &value )
+{
+    {
+        QMutexLocker lock( &m_mutex );
+
+        if( m_values.contains( qsKey ) && (m_values.value( qsKey ) == value) )
+            return;
+
+        m_values.insert( qsKey, value );
+        m_pending.insert( qsKey, value );
+        rebuild();
+    }
+
+    if( m_iWriteTimer != 0 )
+        killTimer( m_iWriteTimer );
+    m_iWriteTimer = startTimer( g_iWriteDelayMs );
+
+    emit settingsChanged( qsKey );
+}
+
+
+// Save anything outstanding now; on the way out and before anything else reads QSettings directly
+void SettingsStore::flush()
+{
+    QMutexLocker lock( &m_mutex );
+    QString      qsKey;
+
+    if( m_iWriteTimer != 0 )
+    {
+        killTimer( m_iWriteTimer );
+        m_iWriteTimer = 0;
+    }
+
+    if( m_pending.isEmpty() || (g_pSet == nullptr) )
+        return;
+
+    foreach( qsKey, m_pending.keys() )
+        g_pSet->setValue( qsKey, m_pending.value( qsKey ) );
+    m_pending.clear();
+    g_pSet->sync();
+}
+
+
+void SettingsStore::timerEvent( QTimerEvent *pEvent )
+{
+    if( pEvent == nullptr )
+        return;
+
+    if( pEvent->timerId() == m_iWriteTimer )
+        flush();
+}
+
+
+// Caller holds the lock
+void SettingsStore::read( const QString &qsKey, const QVariant &defaultValue )
+{
+    m_values.insert( qsKey, (g_pSet == nullptr) ? defaultValue : g_pSet->value( qsKey, defaultValue ) );
+}
+
+
+// Caller holds the lock
+void SettingsStore::rebuild()
+{
+    QVariant country;
+
+    m_dZoomNM = m_values.value( "ZoomNM" ).toDouble();
+    m_settings.bShowAllTraffic = m_values.value( "ShowAllTraffic" ).toBool();
+    m_settings.eShowAirports = static_cast<Canvas::ShowAirports>( m_values.value( "ShowAirports" ).toInt() );
+    m_settings.bShowPrivate = m_values.value( "ShowPrivate" ).toBool();
+    m_settings.bShowRunways = m_values.value( "ShowRunways" ).toBool();
+    m_settings.bShowAirspaces = m_values.value( "ShowAirspaces" ).toBool();
+    m_settings.bShowAltitudes = m_values.value( "ShowAltitudes" ).toBool();
+    m_settings.bAutoRec = m_values.value( "AutoRec" ).toBool();
+    m_settings.bMapRasterCache = m_values.value( "MapRasterCache" ).toBool();
+    m_settings.bHalfMode = m_values.value( "HalfMode" ).toBool();
+    m_settings.iCurrDataSet = m_values.value( "CurrDataSet" ).toInt();
+    m_settings.qsStratuxIP = m_values.value( "StratuxIP" ).toString();
+    m_settings.qsOwnshipID = m_values.value( "OwnshipID" ).toString();
+    m_settings.iMagDev = m_values.value( "MagDev" ).toInt();
+    m_settings.dAirspeedCal = m_values.value( "AirspeedCal" ).toDouble();
+    m_settings.eUnits = static_cast<Canvas::Units>( m_values.value( "UnitsAirspeed" ).toInt() );
+    m_settings.bSwitchableTanks = m_values.value( "FuelTanks/DualTanks" ).toBool();
+    m_settings.bWTScreenStayOn = false;
+
+    m_settings.listAirports.clear();
+    foreach( country, m_values.value( "CountryAirports" ).toList() )
+        m_settings.listAirports.append( static_cast<Canvas::CountryCodeAirports>( country.toInt() ) );
+    m_settings.listAirspaces.clear();
+    foreach( country, m_values.value( "CountryAirspaces" ).toList() )
+        m_settings.listAirspaces.append( static_cast<Canvas::CountryCodeAirspace>( country.toInt() ) );
+}
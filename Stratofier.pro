@@ -5,7 +5,7 @@
 #
 #-------------------------------------------------
 
-QT += core gui websockets widgets network concurrent xml
+QT += core gui websockets widgets network concurrent xml svg
 
 VPATH += ./include \
          ../include \
@@ -73,7 +73,19 @@ SOURCES += main.cpp \
            CountryDialog.cpp \
            DetailsDialog.cpp \
            Overlays.cpp \
-           Keyboard.cpp
+           Keyboard.cpp \
+           AirspaceAlert.cpp \
+           AirportCache.cpp \
+           DownloadManager.cpp \
+           AipParser.cpp \
+           RenderBench.cpp \
+           LabelCache.cpp \
+           RenderGovernor.cpp \
+           Profiler.cpp \
+           AssetCache.cpp \
+           FuelFlow.cpp \
+           SettingsStore.cpp \
+           FlightRecorder.cpp
 
 HEADERS += StratuxStreams.h \
            StreamReader.h \
@@ -96,7 +108,19 @@ HEADERS += StratuxStreams.h \
            CountryDialog.h \
            DetailsDialog.h \
            Overlays.h \
-           Keyboard.h
+           Keyboard.h \
+           AirspaceAlert.h \
+           AirportCache.h \
+           DownloadManager.h \
+           AipParser.h \
+           RenderBench.h \
+           LabelCache.h \
+           RenderGovernor.h \
+           Profiler.h \
+           AssetCache.h \
+           FuelFlow.h \
+           SettingsStore.h \
+           FlightRecorder.h
 
 FORMS += AHRSMainWin.ui \
          BugSelector.ui \
@@ -11,7 +11,6 @@ Stratofier Stratux AHRS Display
 #include <QPalette>
 #include <QNetworkInterface>
 #include <QTimer>
-#include <QSettings>
 #include <QNetworkDatagram>
 
 #include <math.h>
@@ -19,9 +18,11 @@ Stratofier Stratux AHRS Display
 #include "StreamReader.h"
 #include "TrafficMath.h"
 #include "StratofierDefs.h"
+#include "Profiler.h"
+#include "SettingsStore.h"
 
 
-extern QSettings *g_pSet;
+extern SettingsStore *g_pSettings;
 
 
 StreamReader::StreamReader( const QString &qsIP )
@@ -42,9 +43,9 @@ StreamReader::StreamReader( const QString &qsIP )
       m_dRawPitch( 0.0 ),
       m_dAirspeedCal( 1.0 )
 {
-    m_dPitchRef = g_pSet->value( "PitchRef", 0.0 ).toDouble();
-    m_dRollRef = g_pSet->value( "RollRef", 0.0 ).toDouble();
-    m_dAirspeedCal = g_pSet->value( "AirspeedCal", 1.0 ).toDouble();
+    m_dPitchRef = g_pSettings->value( "PitchRef", 0.0 ).toDouble();
+    m_dRollRef = g_pSettings->value( "RollRef", 0.0 ).toDouble();
+    m_dAirspeedCal = g_pSettings->settings().dAirspeedCal;
 
     // If one connects there's a 99.99% chance they all will so just use the status
     connect( &m_stratuxStatus, SIGNAL( connected() ), this, SLOT( stratuxConnected() ) );
@@ -108,6 +109,8 @@ void StreamReader::disconnectStreams()
 // String is received from stratux and the situation struct filled in
 void StreamReader::situationUpdate( const QString &qsMessage )
 {
+    ProfileScope scope( Profiler::SituationStream );
+
     QStringList      qslFields( qsMessage.split( ',' ) );
     QString          qsField;
     StratuxSituation situation;
@@ -238,6 +241,8 @@ void StreamReader::situationUpdate( const QString &qsMessage )
 // Updates from the traffic stream
 void StreamReader::trafficUpdate( const QString &qsMessage )
 {
+    ProfileScope scope( Profiler::TrafficStream );
+
     QStringList    qslFields( qsMessage.split( ',' ) );
     QString        qsField;
     StratuxTraffic traffic;
@@ -331,6 +336,8 @@ void StreamReader::trafficUpdate( const QString &qsMessage )
 // Updates from the status stream
 void StreamReader::statusUpdate( const QString &qsMessage )
 {
+    ProfileScope scope( Profiler::StatusStream );
+
     QStringList   qslFields( qsMessage.split( ',' ) );
     QString       qsField;
     QStringList   qslThisField;
@@ -496,7 +503,7 @@ void StreamReader::snapshotOrientation()
 {
     m_dRollRef = m_dRawRoll;
     m_dPitchRef = m_dRawPitch;
-    g_pSet->setValue( "PitchRef", m_dPitchRef );
-    g_pSet->setValue( "RollRef", m_dRollRef );
+    g_pSettings->setValue( "PitchRef", m_dPitchRef );
+    g_pSettings->setValue( "RollRef", m_dRollRef );
 }
 
@@ -5,27 +5,48 @@ Stratofier Stratux AHRS Display
 
 #include <QtDebug>
 #include <QFile>
-#include <QSettings>
-#include <QDomDocument>
-#include <QDomElement>
-#include <QDomNode>
+#include <QFuture>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+#include <QSet>
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QtConcurrent>
 
 #include <math.h>
+#include <algorithm>
+#include <queue>
+#include <vector>
 
 #include "StratofierDefs.h"
 #include "TrafficMath.h"
 #include "StratuxStreams.h"
 #include "Builder.h"
+#include "AirportCache.h"
+#include "AipParser.h"
+#include "SettingsStore.h"
 
 
 extern StratuxSituation g_situation;
-extern QSettings       *g_pSet;
-extern bool             g_bNoAirportsUpdate;
+extern SettingsStore    *g_pSettings;
+extern QFuture<void>    g_apt;
+extern QFuture<void>    g_asp;
 
 
 // This was implemented to cut down on the airport lookup by lat/long that takes long enough to be noticeable on the display (it's threaded but you can see it filling back in)
-QList<Airport>  g_airportCache;
+AirportCache    g_airportCache;
 QList<Airspace> g_airspaceCache;
+QAtomicInt      g_iAirspaceCacheGen;    // Bumped each time the airspace cache finishes loading so anything derived from it knows to rebuild
+// Sorted ID and name keys over the airport cache for search-as-you-type and name lookups
+QVector<AirportKey> g_airportIndex;
+// Which country datasets are in the caches so a new download can be merged in without reloading everything
+QStringList g_qslAirportDatasets;
+QStringList g_qslAirspaceDatasets;
+
+// Douglas-Peucker tolerances in NM for each simplified airspace outline level, finest first
+static const double g_dAirspaceLOD[] = { 0.05, 0.15, 0.4, 1.0 };
+static const int    g_iAirspaceLODCount = sizeof( g_dAirspaceLOD ) / sizeof( g_dAirspaceLOD[0] );
 
 
 // Find the distance and bearing from one lat/long to another
@@ -77,42 +98,62 @@ double TrafficMath::degHeading( double dAng )
 // Get every airport in the cache that's within twice the distance of the current heading indicator radius
 void TrafficMath::updateNearbyAirports( QList<Airport> *pAirports, Airport *pDirect, Airport *pFrom, Airport *pTo, double dDist )
 {
-    Airport ap;
+    Airport     ap;
+    BearingDist bd;
 
     pAirports->clear();
     dDist *= 2;
-    foreach( ap, g_airportCache )
+    // Only the airports that make the cut get expanded out of the compact cache
+    for( int i = 0; i < g_airportCache.count(); i++ )
     {
-        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+        AirportView view = g_airportCache.at( i );
+
+        bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, view.lat(), view.lon() );
 
-        if( (ap.bd.dDistance <= dDist) || (ap.qsID == pDirect->qsID) || (ap.qsID == pFrom->qsID) || (ap.qsID == pTo->qsID) )
+        if( (bd.dDistance <= dDist) || view.hasID( pDirect->qsID ) || view.hasID( pFrom->qsID ) || view.hasID( pTo->qsID ) )
+        {
+            ap = view.toAirport();
+            ap.bd = bd;
             pAirports->append( ap );
+        }
     }
+
+    // Keep the nearby list in ID order so findAirport can binary search it
+    std::sort( pAirports->begin(), pAirports->end(), []( const Airport &a, const Airport &b ) { return a.qsID < b.qsID; } );
 }
 
 
 Airport TrafficMath::getCurrentAirport()
 {
-    Airport ap;
+    Airport     ap;
+    BearingDist bd;
 
-    foreach( ap, g_airportCache )
+    for( int i = 0; i < g_airportCache.count(); i++ )
     {
-        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+        AirportView view = g_airportCache.at( i );
+
+        bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, view.lat(), view.lon() );
 
         // The first airport within 2 NM of ownship
-        if( ap.bd.dDistance <= 2 )
+        if( bd.dDistance <= 2 )
+        {
+            ap = view.toAirport();
+            ap.bd = bd;
             break;
+        }
     }
 
     return ap;
 }
 
 
-void TrafficMath::updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDist )
+// The level of detail is picked so the simplification tolerance stays under one pixel at the current zoom
+void TrafficMath::updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDist, double dNMPerPixel )
 {
     Airspace    as;
     BearingDist bd;
     QPointF     pt;
+    int         iLOD = airspaceLOD( dNMPerPixel );
 
     pAirspaces->clear();
     dDist *= 4.0;
@@ -126,344 +167,689 @@ void TrafficMath::updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDi
         as.shapeHav.clear();
         if( bd.dDistance <= dDist )
         {
-            foreach( pt, as.shape )
+            const QPolygonF &shape = ((iLOD >= 0) && (iLOD < as.shapeLOD.count())) ? as.shapeLOD.at( iLOD ) : as.shape;
+
+            foreach( pt, shape )
             {
                 bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, pt.y(), pt.x() );
                 as.shapeHav.append( bd );
             }
+            as.labelHav = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, as.labelPt.y(), as.labelPt.x() );
             pAirspaces->append( as );
         }
     }
 }
 
 
+// Coarsest level whose tolerance is still below one pixel; -1 means the full resolution shape
+int TrafficMath::airspaceLOD( double dNMPerPixel )
+{
+    int iLOD = -1;
+
+    for( int i = 0; i < g_iAirspaceLODCount; i++ )
+    {
+        if( g_dAirspaceLOD[i] < dNMPerPixel )
+            iLOD = i;
+    }
+
+    return iLOD;
+}
+
+
+// Distance from a point to a line segment in the same units as the points
+static double segmentDist( const QPointF &pt, const QPointF &a, const QPointF &b )
+{
+    double dX = b.x() - a.x();
+    double dY = b.y() - a.y();
+    double dLen2 = (dX * dX) + (dY * dY);
+    double dT = 0.0;
+
+    if( dLen2 > 0.0 )
+    {
+        dT = (((pt.x() - a.x()) * dX) + ((pt.y() - a.y()) * dY)) / dLen2;
+        if( dT < 0.0 )
+            dT = 0.0;
+        else if( dT > 1.0 )
+            dT = 1.0;
+    }
+
+    dX = pt.x() - (a.x() + (dT * dX));
+    dY = pt.y() - (a.y() + (dT * dY));
+
+    return sqrt( (dX * dX) + (dY * dY) );
+}
+
+
+// Douglas-Peucker simplification of a long/lat outline. The work is done in minutes of latitude (NM) with the
+// longitude scaled by the cosine of the latitude so the tolerance means roughly the same distance in any direction.
+QPolygonF TrafficMath::simplifyPolygon( const QPolygonF &shape, double dToleranceNM )
+{
+    int iCount = shape.count();
+
+    if( iCount < 5 )
+        return shape;
+
+    double                    dLongScale = cos( shape.boundingRect().center().y() * ToRad ) * 60.0;
+    QPolygonF                 flat;
+    QVector<bool>             keep( iCount, false );
+    QVector<QPair<int, int> > spans;
+    QPointF                   pt;
+    QPolygonF                 simple;
+    int                       i;
+
+    foreach( pt, shape )
+        flat.append( QPointF( pt.x() * dLongScale, pt.y() * 60.0 ) );
+
+    keep[0] = true;
+    keep[iCount - 1] = true;
+    spans.append( qMakePair( 0, iCount - 1 ) );
+
+    // Iterative rather than recursive since some of the arcs have thousands of points
+    while( !spans.isEmpty() )
+    {
+        QPair<int, int> span = spans.takeLast();
+        double          dMax = 0.0;
+        double          dDist;
+        int             iMax = -1;
+
+        for( i = span.first + 1; i < span.second; i++ )
+        {
+            dDist = segmentDist( flat.at( i ), flat.at( span.first ), flat.at( span.second ) );
+            if( dDist > dMax )
+            {
+                dMax = dDist;
+                iMax = i;
+            }
+        }
+
+        if( (iMax > 0) && (dMax > dToleranceNM) )
+        {
+            keep[iMax] = true;
+            spans.append( qMakePair( span.first, iMax ) );
+            spans.append( qMakePair( iMax, span.second ) );
+        }
+    }
+
+    for( i = 0; i < iCount; i++ )
+    {
+        if( keep.at( i ) )
+            simple.append( shape.at( i ) );
+    }
+
+    // Anything less than a closed triangle isn't worth drawing so fall back to the original
+    if( simple.count() < 4 )
+        return shape;
+
+    return simple;
+}
+
+
+// The list is sorted by ID in updateNearbyAirports; returns the list count if it isn't there
 int TrafficMath::findAirport( Airport *pAirport, QList<Airport> *apList )
 {
-    Airport ap;
-    int     iIndex = 0;
+    QList<Airport>::const_iterator it = std::lower_bound( apList->constBegin(), apList->constEnd(), pAirport->qsID,
+                                                          []( const Airport &ap, const QString &qsID ) { return ap.qsID < qsID; } );
+
+    if( (it == apList->constEnd()) || (it->qsID != pAirport->qsID) )
+        return apList->count();
+
+    return static_cast<int>( it - apList->constBegin() );
+}
+
+
+// Upper case with everything but letters, digits and single spaces stripped so "St. Louis" and "ST LOUIS" match
+QString TrafficMath::normalizeAirportKey( const QString &qsKey )
+{
+    QString qsNorm;
+    QChar   c;
 
-    foreach( ap, *apList )
+    foreach( c, qsKey.toUpper() )
     {
-        if( ap.qsID == pAirport->qsID )
-            break;
-        iIndex++;
+        if( c.isLetterOrNumber() )
+            qsNorm.append( c );
+        else if( c.isSpace() || (c == '-') || (c == '/') )
+            qsNorm.append( ' ' );
     }
 
-    return iIndex;
+    return qsNorm.simplified();
 }
 
 
-void TrafficMath::cacheAirports()
+// Binary search to the first key with the prefix then walk forward; results are cache indices in key order
+QList<int> TrafficMath::searchAirports( const QString &qsPrefix, int iMax )
 {
-    QString                                    qsInternal;
-    QFile                                      aipDatabase;
-    QMap<Canvas::CountryCodeAirports, QString> urlMap;
+    QList<int> results;
+    QSet<int>  seen;
+    QString    qsNorm = normalizeAirportKey( qsPrefix );
 
-    Builder::populateUrlMapAirports( &urlMap );
+    if( qsNorm.isEmpty() )
+        return results;
 
-    QVariantList countries = g_pSet->value( "CountryAirports", QVariantList() ).toList();
-    QVariant     country;
+    QVector<AirportKey>::const_iterator it = std::lower_bound( g_airportIndex.constBegin(), g_airportIndex.constEnd(), qsNorm,
+                                                               []( const AirportKey &key, const QString &qsKey ) { return key.qsKey < qsKey; } );
 
-    g_airportCache.clear();
-    foreach( country, countries )
+    while( (it != g_airportIndex.constEnd()) && it->qsKey.startsWith( qsNorm ) && (results.count() < iMax) )
     {
-        Builder::getStorage( &qsInternal );
-        qsInternal.append( QString( "/data/space.skyfun.stratofier/%1.aip" )
-                                .arg( urlMap[static_cast<Canvas::CountryCodeAirports>( country.toInt() )] ) );
+        if( !seen.contains( it->iAirport ) )
+        {
+            seen.insert( it->iAirport );
+            results.append( it->iAirport );
+        }
+        it++;
+    }
 
-        aipDatabase.setFileName( qsInternal );
+    return results;
+}
 
-        if( !aipDatabase.open( QIODevice::ReadOnly ) )
-            return;
 
-        QDomDocument aipDoc( "XML_OpenAIP" );
-        QDomElement  xRoot, xAirportElem, xChildElem, xSubChildElem, xWayPtElem;
-        QDomNode     xAirportNode, xChildNode, xSubChildNode, xWayPtNode;
-        QString      qsTemp, qsErrMsg;
-        Airport      ap;
-        int          iErrLine, iErrCol;
+// Exact name lookup through the index instead of scanning the whole cache
+bool TrafficMath::findAirportByName( const QString &qsName, Airport *pAirport )
+{
+    QString qsNorm = normalizeAirportKey( qsName );
+
+    if( qsNorm.isEmpty() )
+        return false;
 
-        if( !aipDoc.setContent( &aipDatabase, &qsErrMsg, &iErrLine, &iErrCol ) )
+    QVector<AirportKey>::const_iterator it = std::lower_bound( g_airportIndex.constBegin(), g_airportIndex.constEnd(), qsNorm,
+                                                               []( const AirportKey &key, const QString &qsKey ) { return key.qsKey < qsKey; } );
+
+    while( (it != g_airportIndex.constEnd()) && (it->qsKey == qsNorm) )
+    {
+        AirportView view = g_airportCache.at( it->iAirport );
+
+        if( view.name() == qsName )
         {
-            qDebug() << qsErrMsg << iErrLine << iErrCol;
-            aipDatabase.close();
-            return;
+            *pAirport = view.toAirport();
+            return true;
         }
-        aipDatabase.close();
+        it++;
+    }
 
-        xRoot = aipDoc.documentElement();
+    return false;
+}
+
+
+// One key for the ID, one for the whole name and one starting at each later word of the name
+static QVector<AirportKey> buildAirportIndex( const AirportCache &cache )
+{
+    QVector<AirportKey> index;
+    AirportKey          key;
+    QString             qsName;
+    int                 iWord;
 
-        // Don't proceed if this isn't an OpenAIP file
-        if( xRoot.tagName() != "OPENAIP" )
-            return;
+    index.reserve( cache.count() * 4 );
 
-        // Total test points in test results file
-        xWayPtNode = xRoot.firstChild();
+    for( int i = 0; i < cache.count(); i++ )
+    {
+        AirportView view = cache.at( i );
 
-        while( !xWayPtNode.isNull() )
+        key.iAirport = i;
+        if( !view.isPrivate() )
         {
-            xWayPtElem = xWayPtNode.toElement();
-            if( xWayPtElem.tagName() == "WAYPOINTS" )
-            {
-                xAirportNode = xWayPtNode.firstChild();
-                while( !xAirportNode.isNull() )
-                {
-                    xAirportElem = xAirportNode.toElement();
-                    if( (xAirportElem.tagName() == "AIRPORT") && (xAirportElem.attribute( "TYPE" ) != "HELI_CIVIL") )
-                    {
-                        ap.bd.dBearing = 0.0;
-                        ap.bd.dDistance = 0.0;
-                        ap.dLat = 0.0;
-                        ap.dLong = 0.0;
-                        ap.dElev = 0.0;
-                        ap.bGrass = false;
-                        ap.qsID.clear();
-                        ap.runways.clear();
-                        ap.frequencies.clear();
-
-                        xChildNode = xAirportNode.firstChild();
-                        while( !xChildNode.isNull() )
-                        {
-                            Frequency f;
-
-                            xChildElem = xChildNode.toElement();
-                            if( xChildElem.tagName() == "ICAO" )
-                                ap.qsID = xChildElem.text();
-                            else if( xChildElem.tagName() == "NAME" )
-                            {
-                                ap.qsName = xChildElem.text();
-                                // Clean up really long names
-                                ap.qsName.replace( "REGIONAL", "RGNL" );
-                                ap.qsName.replace( "EXECUTIVE", "EXEC" );
-                                ap.qsName.replace( "INTERNATIONAL", "INTL" );
-                                ap.qsName.replace( "AERODROME", "AERO" );
-                                ap.qsName.replace( "BALLOONPORT", "BALLOON" );
-                                ap.qsName.remove( "AIRPORT" );
-                                ap.qsName.remove( "FIELD" );
-                            }
-                            else if( xChildElem.tagName() == "GEOLOCATION" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "LAT" )
-                                        ap.dLat = xSubChildElem.text().toDouble();
-                                    else if( xSubChildElem.tagName() == "LON" )
-                                        ap.dLong = xSubChildElem.text().toDouble();
-                                    else if( xSubChildElem.tagName() == "ELEV" )
-                                    {
-                                        if( xSubChildElem.attribute( "UNIT" ).contains( "M", Qt::CaseInsensitive ) )
-                                            ap.dElev = xSubChildElem.text().toDouble() * MetersToFeet;
-                                        else
-                                            ap.dElev = xSubChildElem.text().toDouble();
-                                    }
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "RWY" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "SFC" )
-                                    {
-                                        if( xSubChildElem.text() == "GRAS" )
-                                            ap.bGrass = true;
-                                    }
-                                    else if( xSubChildElem.tagName() == "DIRECTION" )
-                                        ap.runways.append( xSubChildElem.attribute( "TC" ).toInt() );
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "RADIO" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "FREQUENCY" )
-                                    {
-                                        f.dFreq = xSubChildElem.text().toDouble();
-                                    }
-                                    else if( xSubChildElem.tagName() == "DESCRIPTION" )
-                                    {
-                                        f.qsDescription = xSubChildElem.text();
-                                    }
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                                ap.frequencies.append( f );
-                            }
-                            xChildNode = xChildNode.nextSibling();
-                        }
-                        if( ap.qsID.isEmpty() )
-                            ap.qsID = "R";
-                        g_airportCache.append( ap );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
-                    }
-                    xAirportNode = xAirportNode.nextSibling();
-                }
-            }
-            xWayPtNode = xWayPtNode.nextSibling();
+            key.qsKey = TrafficMath::normalizeAirportKey( view.id() );
+            index.append( key );
         }
+
+        qsName = TrafficMath::normalizeAirportKey( view.name() );
+        key.qsKey = qsName;
+        index.append( key );
+        iWord = qsName.indexOf( ' ' );
+        while( iWord >= 0 )
+        {
+            key.qsKey = qsName.mid( iWord + 1 );
+            index.append( key );
+            iWord = qsName.indexOf( ' ', iWord + 1 );
+        }
+    }
+
+    std::sort( index.begin(), index.end(), []( const AirportKey &a, const AirportKey &b ) { return a.qsKey < b.qsKey; } );
+
+    return index;
+}
+
+
+static CachePublisher *publisher()
+{
+    static CachePublisher *pPublisher = nullptr;
+
+    if( pPublisher == nullptr )
+        pPublisher = new CachePublisher( QCoreApplication::instance() );
+
+    return pPublisher;
+}
+
+
+void TrafficMath::cacheAirports()
+{
+    publisher()->loadAirports();
+}
+
+
+// Worker side; the cache and its index are built here and nothing global is touched until they're swapped in on the GUI
+// thread
+AirportSet TrafficMath::loadAirports()
+{
+    QString                                    qsInternal;
+    QMap<Canvas::CountryCodeAirports, QString> urlMap;
+    QList<Airport>                             airports;
+    Airport                                    ap;
+    AirportSet                                 loaded;
+
+    Builder::populateUrlMapAirports( &urlMap );
+
+    QVariantList countries = g_pSettings->value( "CountryAirports" ).toList();
+    QVariant     country;
+
+    foreach( country, countries )
+    {
+        QString qsName = urlMap[static_cast<Canvas::CountryCodeAirports>( country.toInt() )];
+
+        Builder::getStorage( &qsInternal );
+        qsInternal.append( QString( "/data/space.skyfun.stratofier/%1.aip" ).arg( qsName ) );
+
+        airports.clear();
+        if( !AipParser::load( qsInternal, &airports, nullptr ) )
+            continue;
+
+        foreach( ap, airports )
+            loaded.cache.append( ap );
+        loaded.datasets.append( qsName );
     }
+
+    loaded.cache.squeeze();
+    loaded.index = buildAirportIndex( loaded.cache );
+
+    return loaded;
 }
 
 
 void TrafficMath::cacheAirspaces()
+{
+    publisher()->loadAirspaces();
+}
+
+
+// Worker side; everything is built into the set and nothing global is touched
+AirspaceSet TrafficMath::loadAirspaces()
 {
     QString                                    qsInternal;
-    QFile                                      aipDatabase;
     QMap<Canvas::CountryCodeAirspace, QString> urlMap;
+    QList<Airspace>                            airspaces;
+    Airspace                                   as;
+    AirspaceSet                                loaded;
 
     Builder::populateUrlMapAirspaces( &urlMap );
 
-    QVariantList countries = g_pSet->value( "CountryAirspaces", QVariantList() ).toList();
+    QVariantList countries = g_pSettings->value( "CountryAirspaces" ).toList();
     QVariant     country;
 
-    g_airspaceCache.clear();
-    Builder::getStorage( &qsInternal );
-
     foreach( country, countries )
     {
-        Builder::getStorage( &qsInternal );
-        qsInternal.append( QString( "/data/space.skyfun.stratofier/%1.aip" ).arg( urlMap[static_cast<Canvas::CountryCodeAirspace>( country.toInt() )] ) );
+        QString qsName = urlMap[static_cast<Canvas::CountryCodeAirspace>( country.toInt() )];
 
-        aipDatabase.setFileName( qsInternal );
-
-        if( !aipDatabase.open( QIODevice::ReadOnly ) )
-            return;
+        Builder::getStorage( &qsInternal );
+        qsInternal.append( QString( "/data/space.skyfun.stratofier/%1.aip" ).arg( qsName ) );
 
-        QDomDocument aipDoc( "XML_OpenAIP" );
-        QDomElement  xRoot, xWayPtElem, xAirspaceElem, xChildElem, xSubChildElem;
-        QDomNode     xWayPtNode, xAirspaceNode, xChildNode, xSubChildNode;
-        QString      qsTemp, qsErrMsg;
-        Airspace     as;
-        int          iErrLine, iErrCol;
+        airspaces.clear();
+        if( !AipParser::load( qsInternal, nullptr, &airspaces ) )
+            continue;
 
-        if( !aipDoc.setContent( &aipDatabase, &qsErrMsg, &iErrLine, &iErrCol ) )
+        foreach( as, airspaces )
         {
-            qDebug() << qsErrMsg << iErrLine << iErrCol;
-            aipDatabase.close();
-            return;
+            buildAirspaceLOD( &as );
+            loaded.airspaces.append( as );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
         }
-        aipDatabase.close();
+        loaded.datasets.append( qsName );
+    }
+
+    return loaded;
+}
 
-        xRoot = aipDoc.documentElement();
 
-        // Don't proceed if this isn't an OpenAIP file
-        if( xRoot.tagName() != "OPENAIP" )
-            return;
+// Precompute the simplified outlines so the zoomed out views don't project every vertex of every arc, and where the
+// altitude label goes so that doesn't have to be searched for every frame either
+void TrafficMath::buildAirspaceLOD( Airspace *pAirspace )
+{
+    pAirspace->shapeLOD.clear();
+    for( int iLOD = 0; iLOD < g_iAirspaceLODCount; iLOD++ )
+        pAirspace->shapeLOD.append( simplifyPolygon( pAirspace->shape, g_dAirspaceLOD[iLOD] ) );
+    pAirspace->labelPt = labelAnchor( pAirspace->shape, 0.1 );
+}
 
-        // Total test points in test results file
-        xWayPtNode = xRoot.firstChild();
 
-        while( !xWayPtNode.isNull() )
+// Square of the label anchor search; dMax is the best distance anything inside it could have
+struct LabelCell
+{
+    QPointF center;
+    double  dHalf;
+    double  dDist;
+    double  dMax;
+
+    bool operator<( const LabelCell &other ) const { return dMax < other.dMax; }
+};
+
+
+// Distance to the nearest edge, negative outside the shape
+static double edgeDist( const QPointF &pt, const QPolygonF &shape )
+{
+    double dMin = -1.0;
+    double dSeg;
+    int    i;
+
+    for( i = 0; i < shape.count(); i++ )
+    {
+        dSeg = segmentDist( pt, shape.at( i ), shape.at( (i + 1) % shape.count() ) );
+        if( (dMin < 0.0) || (dSeg < dMin) )
+            dMin = dSeg;
+    }
+
+    return shape.containsPoint( pt, Qt::OddEvenFill ) ? dMin : -dMin;
+}
+
+
+static LabelCell labelCell( const QPointF &center, double dHalf, const QPolygonF &shape )
+{
+    LabelCell cell;
+
+    cell.center = center;
+    cell.dHalf = dHalf;
+    cell.dDist = edgeDist( center, shape );
+    cell.dMax = cell.dDist + (dHalf * sqrt( 2.0 ));
+
+    return cell;
+}
+
+
+// Pole of inaccessibility (the inside point furthest from any edge) by the same quadtree search as Mapbox polylabel.
+// Unlike the bounding box center it's always inside, even for rings and L shapes. Worked in NM like simplifyPolygon.
+QPointF TrafficMath::labelAnchor( const QPolygonF &shape, double dPrecisionNM )
+{
+    if( shape.count() < 3 )
+        return shape.boundingRect().center();
+
+    double                                                  dLongScale = cos( shape.boundingRect().center().y() * ToRad ) * 60.0;
+    QPolygonF                                               flat;
+    QPointF                                                 pt;
+    QRectF                                                  bounds;
+    double                                                  dCell, dX, dY;
+    std::priority_queue<LabelCell, std::vector<LabelCell> > cells;
+    LabelCell                                               cell, best;
+
+    foreach( pt, shape )
+        flat.append( QPointF( pt.x() * dLongScale, pt.y() * 60.0 ) );
+
+    bounds = flat.boundingRect();
+    dCell = qMin( bounds.width(), bounds.height() );
+    if( dCell <= 0.0 )
+        return shape.boundingRect().center();
+
+    for( dX = bounds.left(); dX < bounds.right(); dX += dCell )
+    {
+        for( dY = bounds.top(); dY < bounds.bottom(); dY += dCell )
+            cells.push( labelCell( QPointF( dX + (dCell / 2.0), dY + (dCell / 2.0) ), dCell / 2.0, flat ) );
+    }
+
+    best = labelCell( bounds.center(), 0.0, flat );
+    while( !cells.empty() )
+    {
+        cell = cells.top();
+        cells.pop();
+
+        if( cell.dDist > best.dDist )
+            best = cell;
+
+        // Nothing in here can beat the best by more than the precision so don't split it
+        if( (cell.dMax - best.dDist) <= dPrecisionNM )
+            continue;
+
+        cell.dHalf /= 2.0;
+        cells.push( labelCell( cell.center + QPointF( -cell.dHalf, -cell.dHalf ), cell.dHalf, flat ) );
+        cells.push( labelCell( cell.center + QPointF( cell.dHalf, -cell.dHalf ), cell.dHalf, flat ) );
+        cells.push( labelCell( cell.center + QPointF( -cell.dHalf, cell.dHalf ), cell.dHalf, flat ) );
+        cells.push( labelCell( cell.center + QPointF( cell.dHalf, cell.dHalf ), cell.dHalf, flat ) );
+    }
+
+    return QPointF( best.center.x() / dLongScale, best.center.y() / 60.0 );
+}
+
+
+// Add a freshly downloaded country to the live caches. A country that's already loaded can't be patched in place so
+// the caller gets false back and should recache from disk instead.
+bool TrafficMath::mergeAirports( const QString &qsDataset, const QList<Airport> &airports )
+{
+    return publisher()->mergeAirports( qsDataset, airports );
+}
+
+
+bool TrafficMath::mergeAirspaces( const QString &qsDataset, const QList<Airspace> &airspaces )
+{
+    return publisher()->mergeAirspaces( qsDataset, airspaces );
+}
+
+
+// Worker side of a merge; the set is a copy of the one being replaced so appending to it leaves the live one alone
+AirportSet TrafficMath::extendAirports( AirportSet loaded, const QList<AirportMerge> &merges )
+{
+    AirportMerge merge;
+    Airport      ap;
+
+    foreach( merge, merges )
+    {
+        if( loaded.datasets.contains( merge.qsDataset ) )
+            continue;
+
+        foreach( ap, merge.airports )
+            loaded.cache.append( ap );
+        loaded.datasets.append( merge.qsDataset );
+    }
+
+    loaded.cache.squeeze();
+    loaded.index = buildAirportIndex( loaded.cache );
+
+    return loaded;
+}
+
+
+AirspaceSet TrafficMath::extendAirspaces( AirspaceSet loaded, const QList<AirspaceMerge> &merges )
+{
+    AirspaceMerge merge;
+    Airspace      as;
+
+    foreach( merge, merges )
+    {
+        if( loaded.datasets.contains( merge.qsDataset ) )
+            continue;
+
+        foreach( as, merge.airspaces )
         {
-            xWayPtElem = xWayPtNode.toElement();
-            if( xWayPtElem.tagName() == "AIRSPACES" )
-            {
-                xAirspaceNode = xWayPtNode.firstChild();
-                while( !xAirspaceNode.isNull() )
-                {
-                    xAirspaceElem = xAirspaceNode.toElement();
-                    if( xAirspaceElem.tagName() == "ASP" )
-                    {
-                        as.qsName.clear();
-                        as.eType = Canvas::Airspace_Class_G;
-                        as.iAltTop = 0;
-                        as.iAltBottom = 0;
-                        as.shape.clear();
-
-                        QString qsTemp = xAirspaceElem.attribute( "CATEGORY" );
-
-                        if( qsTemp == "G" )
-                            as.eType = Canvas::Airspace_Class_G;
-                        else if( qsTemp == "E" )
-                            as.eType = Canvas::Airspace_Class_E;
-                        else if( qsTemp == "D" )
-                            as.eType = Canvas::Airspace_Class_D;
-                        else if( qsTemp == "C" )
-                            as.eType = Canvas::Airspace_Class_C;
-                        // The AIP database doesn't distinguish between MOA, TFR and SFRA types; most can be resolved by the name but those that can't will
-                        // remain assigned to this unofficial type and should probably be colored the same as Restricted or Prohibited
-                        else if( qsTemp == "DANGER" )
-                            as.eType = Canvas::Airspace_Danger;
-                        else if( qsTemp == "PROHIBITED" )
-                            as.eType = Canvas::Airspace_Prohibited;
-                        else if( qsTemp == "RESTRICTED" )
-                            as.eType = Canvas::Airspace_Restricted;
-
-                        xChildNode = xAirspaceNode.firstChild();
-                        while( !xChildNode.isNull() )
-                        {
-                            xChildElem = xChildNode.toElement();
-                            if( xChildElem.tagName() == "NAME" )
-                            {
-                                as.qsName = xChildElem.text();
-                                // Try to resolve the ambiguous "DANGER" category to what it really is
-                                if( as.qsName.contains( "MOA" ) || as.qsName.contains( "BY NOTAM" ) )
-                                    as.eType = Canvas::Airspace_MOA;
-                                else if( as.qsName.contains( "TFR" ) )
-                                    as.eType = Canvas::Airspace_TFR;
-                                else if( as.qsName.contains( "SFRA" ) )
-                                    as.eType = Canvas::Airspace_SFRA;
-                            }
-                            else if( xChildElem.tagName() == "ALTLIMIT_TOP" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "ALT" )
-                                        as.iAltTop = xSubChildElem.text().toInt();  // Assume feet
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "ALTLIMIT_BOTTOM" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "ALT" )
-                                        as.iAltBottom = xSubChildElem.text().toInt();  // Assume feet
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "GEOMETRY" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "POLYGON" )
-                                    {
-                                        qsTemp = xSubChildElem.text();
-
-                                        QStringList qslPolyCoords = qsTemp.split( ',' );
-                                        QString     qsCoordPair;
-
-                                        foreach( qsCoordPair, qslPolyCoords )
-                                        {
-                                            qsCoordPair = qsCoordPair.trimmed();
-
-                                            QStringList qslCoords = qsCoordPair.split( ' ' );
-                                            if( qslCoords.count() == 2 )
-                                                as.shape.append( QPointF( qslCoords.first().toDouble(), qslCoords.last().toDouble() ) );
-                                        }
-                                    }
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            xChildNode = xChildNode.nextSibling();
-                        }
-                        g_airspaceCache.append( as );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
-                    }
-                    xAirspaceNode = xAirspaceNode.nextSibling();
-                }
-            }
-            xWayPtNode = xWayPtNode.nextSibling();
+            buildAirspaceLOD( &as );
+            loaded.airspaces.append( as );
         }
+        loaded.datasets.append( merge.qsDataset );
+    }
+
+    return loaded;
+}
+
+
+CachePublisher::CachePublisher( QObject *pParent )
+    : QObject( pParent ),
+      m_bAirportsQueued( false ),
+      m_bAirportsReady( false ),
+      m_bAirspacesQueued( false ),
+      m_bAirspacesReady( false )
+{
+    connect( &m_airportLoad, SIGNAL( finished() ), this, SLOT( airportsLoaded() ) );
+    connect( &m_airspaceLoad, SIGNAL( finished() ), this, SLOT( airspacesLoaded() ) );
+    connect( &m_nearby, SIGNAL( finished() ), this, SLOT( publish() ) );
+}
+
+
+void CachePublisher::loadAirports()
+{
+    if( m_airportLoad.isRunning() )
+    {
+        m_bAirportsQueued = true;
+        return;
+    }
+
+    m_airportLoad.setFuture( QtConcurrent::run( TrafficMath::loadAirports ) );
+}
+
+
+void CachePublisher::loadAirspaces()
+{
+    if( m_airspaceLoad.isRunning() )
+    {
+        m_bAirspacesQueued = true;
+        return;
+    }
+
+    m_airspaceLoad.setFuture( QtConcurrent::run( TrafficMath::loadAirspaces ) );
+}
+
+
+// Queued behind whatever load is running so the merge is built on top of its result rather than raced against it
+bool CachePublisher::mergeAirports( const QString &qsDataset, const QList<Airport> &airports )
+{
+    AirportMerge merge;
+
+    if( g_qslAirportDatasets.contains( qsDataset ) )
+        return false;
+
+    merge.qsDataset = qsDataset;
+    merge.airports = airports;
+    m_airportMerges.append( merge );
+    if( !m_airportLoad.isRunning() )
+        extendAirports();
+
+    return true;
+}
+
+
+bool CachePublisher::mergeAirspaces( const QString &qsDataset, const QList<Airspace> &airspaces )
+{
+    AirspaceMerge merge;
+
+    if( g_qslAirspaceDatasets.contains( qsDataset ) )
+        return false;
+
+    merge.qsDataset = qsDataset;
+    merge.airspaces = airspaces;
+    m_airspaceMerges.append( merge );
+    if( !m_airspaceLoad.isRunning() )
+        extendAirspaces();
+
+    return true;
+}
+
+
+// Start from the newest set there is, which is the one waiting to be published if there is one. The copies are cheap
+// since everything in them is shared until the worker appends.
+void CachePublisher::extendAirports()
+{
+    AirportSet base;
+
+    if( m_bAirportsReady )
+        base = m_airports;
+    else
+    {
+        base.cache = g_airportCache;
+        base.index = g_airportIndex;
+        base.datasets = g_qslAirportDatasets;
+    }
+
+    m_airportLoad.setFuture( QtConcurrent::run( TrafficMath::extendAirports, base, m_airportMerges ) );
+    m_airportMerges.clear();
+}
+
+
+void CachePublisher::extendAirspaces()
+{
+    AirspaceSet base;
+
+    if( m_bAirspacesReady )
+        base = m_airspaces;
+    else
+    {
+        base.airspaces = g_airspaceCache;
+        base.datasets = g_qslAirspaceDatasets;
+    }
+
+    m_airspaceLoad.setFuture( QtConcurrent::run( TrafficMath::extendAirspaces, base, m_airspaceMerges ) );
+    m_airspaceMerges.clear();
+}
+
+
+// A reload asked for in the meantime reads everything from disk, downloads included, so it takes care of any merges too
+void CachePublisher::airportsLoaded()
+{
+    m_airports = m_airportLoad.result();
+    m_bAirportsReady = true;
+    publish();
+
+    if( m_bAirportsQueued )
+    {
+        m_bAirportsQueued = false;
+        m_airportMerges.clear();
+        loadAirports();
+    }
+    else if( !m_airportMerges.isEmpty() )
+        extendAirports();
+}
+
+
+void CachePublisher::airspacesLoaded()
+{
+    m_airspaces = m_airspaceLoad.result();
+    m_bAirspacesReady = true;
+    publish();
+
+    // The settings changed again while that one was loading
+    if( m_bAirspacesQueued )
+    {
+        m_bAirspacesQueued = false;
+        m_airspaceMerges.clear();
+        loadAirspaces();
+    }
+    else if( !m_airspaceMerges.isEmpty() )
+        extendAirspaces();
+}
+
+
+// The nearby list threads are only ever started from the GUI thread so once they're both done nothing can be reading
+// the caches until this returns; if one is still going this comes back around when it finishes
+void CachePublisher::publish()
+{
+    if( (!m_bAirportsReady) && (!m_bAirspacesReady) )
+        return;
+
+    if( !g_apt.isFinished() )
+    {
+        m_nearby.setFuture( g_apt );
+        return;
+    }
+    if( !g_asp.isFinished() )
+    {
+        m_nearby.setFuture( g_asp );
+        return;
+    }
+
+    if( m_bAirportsReady )
+    {
+        g_airportCache = m_airports.cache;
+        g_airportIndex = m_airports.index;
+        g_qslAirportDatasets = m_airports.datasets;
+        m_airports = AirportSet();
+        m_bAirportsReady = false;
+    }
+
+    if( m_bAirspacesReady )
+    {
+        g_airspaceCache = m_airspaces.airspaces;
+        g_qslAirspaceDatasets = m_airspaces.datasets;
+        m_airspaces = AirspaceSet();
+        m_bAirspacesReady = false;
+        g_iAirspaceCacheGen.ref();
     }
 }
@@ -11,22 +11,67 @@ Stratofier Stratux AHRS Display
 #include <QMap>
 #include <QList>
 #include <QDateTime>
+#include <QPainterPath>
+#include <QRegion>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QFuture>
+#include <QFutureWatcher>
 
 #include "StratuxStreams.h"
 #include "Canvas.h"
 #include "TrafficMath.h"
+#include "AirspaceAlert.h"
+#include "AHRSDraw.h"
+#include "RenderGovernor.h"
+#include "FuelFlow.h"
+#include "FlightRecorder.h"
+
+
+class QPainter;
+class QPaintDevice;
+class QResizeEvent;
+
+
+// Static instrument artwork rendered once per screen geometry; origin is the top left in widget coordinates
+struct CanvasLayer
+{
+    QPixmap pixmap;
+    QPoint  origin;
+};
+
+
+// Artwork scaled for one screen geometry; it's scaled off the GUI thread (or loaded from the asset cache) and only
+// turned into pixmaps once it's back
+struct CanvasAssets
+{
+    QImage headIcon;
+    QImage windIcon;
+    QImage vertSpeedTape;
+    QImage headIndicator;
+    QImage headIndicatorOverlay;
+    QImage rollIndicator;
+    QImage altTape;
+    QImage speedTape;
+    QImage fuel;
+    bool   bComplete;
+};
 
 
 class AHRSCanvas : public QWidget
 {
     Q_OBJECT
 
+    friend class RenderBench;
+
 public:
     explicit AHRSCanvas( QWidget *parent = 0 );
     ~AHRSCanvas();
 
     void    setPortrait( bool bPortrait ) { m_bPortrait = bPortrait; }
     void    setFuelTanks( FuelTanks tanks ) { m_tanks = tanks; }
+    void    startFuelFlow();
+    void    stopFuelFlow();
     void    timerReminder( int iMinutes, int iSeconds );
     Canvas *canvas() { return m_pCanvas; }
     void    orient( bool bPortrait );
@@ -34,6 +79,7 @@ public:
     void    setMagDev( int iMagDev );
     void    setSwitchableTanks( bool bSwitchable );
     void    dark( bool bDark );
+    void    invalidateLayers();
 
     bool m_bFuelFlowStarted;
 
@@ -55,30 +101,85 @@ protected:
     void mousePressEvent( QMouseEvent *pEvent );
     void mouseMoveEvent( QMouseEvent *pEvent );
     void timerEvent( QTimerEvent *pEvent );
+    void resizeEvent( QResizeEvent *pEvent );
 
 private:
+    enum CanvasLayerId
+    {
+        PitchLadderLayer = 0,
+        AttitudeMarksLayer,
+        RollScaleLayer,
+        HeadingDialLayer,
+        HeadingOverlayLayer,
+        AltTapeBackLayer,
+        SpeedTapeBackLayer,
+        VertSpeedScaleLayer,
+        GForceScaleLayer,
+        LayerCount
+    };
+
+    enum InstrumentRegion
+    {
+        AttitudeRegion = 0,
+        SpeedRegion,
+        AltitudeRegion,
+        VertSpeedRegion,
+        MapRegion,
+        InfoRegion,
+        RegionCount
+    };
+
     void cullTrafficMap();
+    void startNearby();
     void zoomIn();
     void zoomOut();
     void handleScreenPress( const QPoint &pressPt );
-    void paintPortrait();
-    void paintLandscape();
+    void paintFrame( QPaintDevice *pDevice, const QRegion &dirty );
+    void paintPortrait( QPaintDevice *pDevice, const QRegion &dirty );
+    void paintLandscape( QPaintDevice *pDevice, const QRegion &dirty );
     void loadSettings();
     void swipeLeft();
     void swipeRight();
     void swipeUp();
     void swipeDown();
     const QString speedUnits();
+    void buildLayers( CanvasConstants &c );
+    void startLayer( QPainter *pPainter, CanvasLayerId eLayer, const QRectF &bounds );
+    void drawLayer( QPainter *pAhrs, CanvasLayerId eLayer );
+    bool layersValid( CanvasConstants &c );
+    void buildRegions( CanvasConstants &c );
+    void markDirty( InstrumentRegion eRegion, bool bUrgent = false );
+    QRect governorRect();
+    void paintGovernorStats();
+    QRect profileRect();
+    void paintProfile();
+    void dumpProfile();
+    void startMapLayers( CanvasConstants &c );
+    void finishMapLayers( QPainter *pAhrs );
+    bool mapRasterValid( MapLayerJob *pJob, const QRect &rect, const QPointF &center );
+    void buildTrafficAtlas( CanvasConstants &c );
+    void startAssets( CanvasConstants &c );
+    void applyAssets( const CanvasAssets &assets );
+    bool geometryChanged();
+    static CanvasAssets loadAssets( CanvasConstants c, bool bPortrait, bool bScale );
+    void stageStart();
+    void stageDone( InstrumentRegion eRegion );
 
     Canvas   *m_pCanvas;
 
     bool      m_bDark;
     bool      m_bInitialized;
+    bool      m_bLayersValid;
+    double    m_dLayerW;
+    double    m_dLayerH;
+    bool      m_bLayerPortrait;
     QPixmap   m_planeIcon;
     QPixmap   m_headIcon;
     QPixmap   m_windIcon;
     QPixmap   m_directIcon;
-    QPixmap   m_trafficRed, m_trafficYellow, m_trafficGreen, m_trafficCyan, m_trafficOrange;
+    QImage    m_trafficRed, m_trafficYellow, m_trafficGreen, m_trafficCyan, m_trafficOrange;
+    QImage    m_trafficAtlas;
+    double    m_dTrafficSprite;     // Chevron size the atlas was built for
     int       m_iHeadBugAngle;
     int       m_iWindBugAngle;
     int       m_iWindBugSpeed;
@@ -114,17 +215,43 @@ private:
     QPixmap m_AltBug;
     QPixmap m_FromTo;
 
+    CanvasLayer  m_layers[LayerCount];
+    QRegion      m_regions[RegionCount];
+    QRegion      m_attitudeUnderMap;    // Attitude showing between the dial and the edge of the map region
+
+    MapLayerJob   m_mapJobs[AHRSDraw::MapLayerCount];
+    QFuture<void> m_mapFutures[AHRSDraw::MapLayerCount];
+
+    qint64       *m_pStageNs;   // Per-instrument paint time accumulated here when the render benchmark is running
+    QElapsedTimer m_stageTimer;
+
     StratofierSettings m_settings;
     QList<Airport>     m_airports;
     QList<Airspace>    m_airspaces;
     FuelTanks          m_tanks;
+    FuelFlow           m_fuelFlow;
+    FlightRecorder     m_recorder;
 
     double m_dBaroPress;
 
     QDateTime m_lastTrafficUpdate;
 
+    AirspaceAlert m_airspaceAlert;
+
+    RenderGovernor m_governor;
+    QRegion        m_pendingRegion;     // Instruments waiting on the governor for their next frame
+    bool           m_bShowProfile;
+
+    QFutureWatcher<CanvasAssets> m_assetWatcher;
+    bool                         m_bAssetsPending;
+
 private slots:
     void orient2();
+    void airspaceAlertsChanged();
+    void flushDirty();
+    void governorStatsChanged();
+    void assetsReady();
+    void settingsChanged();
 };
 
 #endif // __AHRSCANVAS_H__
@@ -6,10 +6,13 @@ Stratofier Stratux AHRS Display
 #ifndef __AHRSDRAW_H__
 #define __AHRSDRAW_H__
 
-#include <QWidget>
 #include <QPixmap>
+#include <QImage>
+#include <QRect>
+#include <QPointF>
 #include <QMap>
 #include <QList>
+#include <QStringList>
 #include <QDateTime>
 
 #include "StratuxStreams.h"
@@ -17,11 +20,66 @@ Stratofier Stratux AHRS Display
 #include "TrafficMath.h"
 
 
-class AHRSDraw : public QWidget
+class QPainter;
+class AirspaceAlert;
+
+
+// One of the moving map layers drawn off the GUI thread. The nearby lists, traffic, ownship and alerted airspaces are
+// copied in (they're shared until someone writes so the copies are cheap) and the drawing reads only those, so the GUI
+// thread can keep painting the attitude and tapes in the meantime. The canvas and traffic atlas are only read and are
+// only replaced once the workers are done with them.
+struct MapLayerJob
 {
-    Q_OBJECT
+    int                    iLayer;      // AHRSDraw::MapLayer
+    bool                   bActive;
+    bool                   bNorthUp;    // Image is a north-up raster rotated into place when it's drawn
+    bool                   bValid;      // North-up raster can be reused as is
+    QRect                  rect;        // Widget area the image covers
+    QPointF                center;      // Heading indicator center the north-up raster turns around
+    double                 dHeading;    // Map heading the layer is projected for
+    QImage                 image;
+    CanvasConstants        c;
+    Canvas                *pCanvas;
+    Airport                directAP;
+    Airport                fromAP;
+    Airport                toAP;
+    QList<Airport>         airports;
+    QList<Airspace>        airspaces;
+    double                 dZoomNM;
+    StratofierSettings     settings;
+    int                    iMagDev;
+    QImage                *pTrafficAtlas;
+    QList<StratuxTraffic>  traffic;
+    StratuxSituation       ownship;
+    QStringList            alerted;     // Names of the airspaces that get the red outline
+};
 
+
+class AHRSDraw
+{
 public:
+    // Bottom to top
+    enum MapLayer
+    {
+        AirspaceMapLayer = 0,
+        AirportMapLayer,
+        TrafficMapLayer,
+        MapLayerCount
+    };
+
+    // Rows of the traffic sprite atlas, one per threat colour; the columns step through the track
+    enum TrafficSprite
+    {
+        TrafficRedSprite = 0,
+        TrafficOrangeSprite,
+        TrafficYellowSprite,
+        TrafficGreenSprite,
+        TrafficCyanSprite,
+        TrafficSpriteCount
+    };
+
+    static const int TrafficSpriteSteps = 72;
+
     explicit AHRSDraw( QPainter *pAHRS,
                        CanvasConstants *c,
                        Canvas *pCanvas,
@@ -33,11 +91,7 @@ public:
                        double dZoomNM,
                        StratofierSettings *pSettings,
                        int iMagDev,
-                       QPixmap *trafficRed,
-                       QPixmap *trafficYellow,
-                       QPixmap *trafficGreen,
-                       QPixmap *trafficCyan,
-                       QPixmap *trafficOrange );
+                       QImage *pTrafficAtlas );
     ~AHRSDraw();
 
     void drawDirectOrFromTo();
@@ -47,29 +101,39 @@ public:
     void updateAirports();
     void updateAirspaces();
     void updateTraffic();
+    void drawZoom();
     void paintSwitchNotice( FuelTanks *pTanks );
     void paintInfo();
     void paintTimer( int iTimerMin, int iTimerSec );
+    void paintAirspaceAlert();
+    void setAirspaceAlert( AirspaceAlert *pAlert ) { m_pAlert = pAlert; }
+    void setHeading( double dHeading ) { m_dHeading = dHeading; }
+    void setTraffic( const QList<StratuxTraffic> *pTraffic, const StratuxSituation *pOwnship ) { m_pTraffic = pTraffic; m_pOwnship = pOwnship; }
+    void setAlerted( const QStringList *pAlerted ) { m_pAlerted = pAlerted; }
+
+    static void renderMapLayer( MapLayerJob *pJob );
 
 private:
-    void maskHeading();
-
-    QPainter           *m_pAHRS;
-    CanvasConstants    *m_pC;
-    Canvas             *m_pCanvas;
-    Airport            *m_pDirectAP;
-    Airport            *m_pFromAP;
-    Airport            *m_pToAP;
-    QList<Airport>     *m_pAirports;
-    QList<Airspace>    *m_pAirspaces;
-    double              m_dZoomNM;
-    StratofierSettings *m_pSettings;
-    int                 m_iMagDev;
-    QPixmap            *m_trafficRed;
-    QPixmap            *m_trafficYellow;
-    QPixmap            *m_trafficGreen;
-    QPixmap            *m_trafficCyan;
-    QPixmap            *m_trafficOrange;
+    void    maskHeading();
+    QPointF project( const BearingDist &bd, double dPxPerNM );
+
+    QPainter                    *m_pAHRS;
+    CanvasConstants             *m_pC;
+    Canvas                      *m_pCanvas;
+    Airport                     *m_pDirectAP;
+    Airport                     *m_pFromAP;
+    Airport                     *m_pToAP;
+    QList<Airport>              *m_pAirports;
+    QList<Airspace>             *m_pAirspaces;
+    double                       m_dZoomNM;
+    StratofierSettings          *m_pSettings;
+    int                          m_iMagDev;
+    QImage                      *m_pTrafficAtlas;
+    AirspaceAlert               *m_pAlert;
+    const QList<StratuxTraffic> *m_pTraffic;
+    const StratuxSituation      *m_pOwnship;
+    const QStringList           *m_pAlerted;
+    double                       m_dHeading;
 };
 
 #endif // __AHRSDRAW_H__
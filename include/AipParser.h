@@ -0,0 +1,57 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AIPPARSER_H__
+#define __AIPPARSER_H__
+
+#include <QXmlStreamReader>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+
+#include "Canvas.h"
+
+
+// Incremental OpenAIP reader; the same parser is fed from a file on disk or straight from a download as the bytes arrive.
+// Finished records pile up until they're taken so a caller can drain them whenever it suits.
+class AipParser
+{
+public:
+    AipParser();
+
+    void reset();
+    void addData( const QByteArray &data );
+    bool isComplete() { return m_bComplete; }
+    bool hasError() { return m_bError; }
+
+    QList<Airport>  takeAirports();
+    QList<Airspace> takeAirspaces();
+
+    static bool    load( const QString &qsAip, QList<Airport> *pAirports, QList<Airspace> *pAirspaces );
+    static bool    readIndex( const QString &qsIndex, QList<Airport> *pAirports, QList<Airspace> *pAirspaces );
+    static bool    writeIndex( const QString &qsIndex, const QList<Airport> &airports, const QList<Airspace> &airspaces );
+    static QString indexPath( const QString &qsAip );
+
+private:
+    void parse();
+    void startElement();
+    void endElement();
+
+    QXmlStreamReader m_xml;
+    QStringList      m_path;        // Open element names, innermost last
+    QString          m_qsText;
+    bool             m_bComplete;
+    bool             m_bError;
+    bool             m_bInAirport;
+    bool             m_bInAirspace;
+    bool             m_bElevMeters;
+    Airport          m_ap;
+    Airspace         m_as;
+    Frequency        m_freq;
+    QList<Airport>   m_airports;
+    QList<Airspace>  m_airspaces;
+};
+
+#endif // __AIPPARSER_H__
@@ -0,0 +1,98 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AIRPORTCACHE_H__
+#define __AIRPORTCACHE_H__
+
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+#include "Canvas.h"
+
+
+class AirportCache;
+
+
+// Fixed size record for one airport; the strings, runways and frequencies live in the cache's shared arrays
+struct AirportRecord
+{
+    double  dLat;
+    double  dLong;
+    float   fElev;
+    quint32 uiID;           // Offset into the string pool
+    quint32 uiName;         // Offset into the string pool
+    quint32 uiRunway;       // First entry in the runway array
+    quint32 uiFrequency;    // First entry in the frequency array
+    quint8  ucIDLen;
+    quint8  ucNameLen;
+    quint8  ucRunwayCount;
+    quint8  ucFrequencyCount;
+    bool    bGrass;
+};
+
+
+struct FrequencyRecord
+{
+    double  dFreq;
+    quint32 uiDescription;  // Offset into the string pool
+    quint8  ucDescriptionLen;
+};
+
+
+// Lightweight read-only handle to one cached airport; cheap to copy and nothing is allocated until a QString is asked for
+class AirportView
+{
+public:
+    AirportView( const AirportCache *pCache, int iIndex ) : m_pCache( pCache ), m_iIndex( iIndex ) {}
+
+    double  lat() const;
+    double  lon() const;
+    double  elev() const;
+    bool    grass() const;
+    bool    isPrivate() const;
+    bool    hasID( const QString &qsID ) const;
+    QString id() const;
+    QString name() const;
+    int     runwayCount() const;
+    int     runway( int iRunway ) const;
+    int     frequencyCount() const;
+    Airport toAirport() const;
+
+private:
+    const AirportRecord &record() const;
+
+    const AirportCache *m_pCache;
+    int                 m_iIndex;
+};
+
+
+// Compact store for the whole airport database so the full US set doesn't cost a QString per field per airport
+class AirportCache
+{
+public:
+    AirportCache();
+
+    void        clear();
+    void        append( const Airport &ap );
+    void        squeeze();
+    int         count() const { return m_records.count(); }
+    AirportView at( int iIndex ) const { return AirportView( this, iIndex ); }
+
+private:
+    quint32 addString( const QString &qs, quint8 *pLen );
+    QString string( quint32 uiOffset, quint8 ucLen ) const;
+
+    QVector<AirportRecord>     m_records;
+    QVector<qint16>            m_runways;
+    QVector<FrequencyRecord>   m_frequencies;
+    QByteArray                 m_pool;      // UTF-8 strings back to back, no terminators; each distinct one only once
+    QHash<QByteArray, quint32> m_strings;   // Pool offset of each string added since the last squeeze()
+
+    friend class AirportView;
+};
+
+#endif // __AIRPORTCACHE_H__
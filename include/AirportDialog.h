@@ -24,6 +24,7 @@ public:
 
 private:
     void updateAirports();
+    void addAirportRow( const Airport &ap, int iRowHeight );
     void toggle( QObject *pObj );
 
     CanvasConstants *m_pC;
@@ -35,6 +36,7 @@ private slots:
     void within();
     void airportsType();
     void airportSelected( QTableWidgetItem *pItem );
+    void search( const QString &qsSearch );
 };
 
 #endif // __AIRPORTDIALOG_H__
@@ -0,0 +1,72 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AIRSPACEALERT_H__
+#define __AIRSPACEALERT_H__
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QPolygonF>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+
+#include "Canvas.h"
+
+
+// One alertable airspace with its outline bucketed into latitude bands so a point test only
+// has to look at the handful of edges that cross the band the point falls in.
+struct AlertZone
+{
+    Canvas::AirspaceType   eType;
+    QString                qsName;
+    int                    iAltTop;
+    int                    iAltBottom;
+    QPolygonF              shape;       // Long/lat
+    QRectF                 bounds;
+    double                 dBandHeight;
+    QVector<QVector<int> > bands;       // Edge indices (edge i runs from point i to point i + 1) crossing each band
+};
+
+
+struct AirspaceAlertState
+{
+    QString              qsName;
+    Canvas::AirspaceType eType;
+    int                  iMinutes;      // 0 means we're in it now, otherwise how far ahead on the current track
+};
+
+
+class AirspaceAlert : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AirspaceAlert( QObject *pParent = nullptr );
+    ~AirspaceAlert();
+
+    QList<AirspaceAlertState> alerts() { return m_alerts; }
+    QStringList               alertedNames();
+
+    static bool contains( const AlertZone &zone, const QPointF &pt );
+
+protected:
+    void timerEvent( QTimerEvent *pEvent );
+
+private:
+    void   rebuild();
+    void   evaluate();
+    double knots( double dSpeed );
+
+    QList<AlertZone>          m_zones;
+    QList<AirspaceAlertState> m_alerts;
+    int                       m_iCacheGen;
+
+signals:
+    void alertsChanged();
+};
+
+#endif // __AIRSPACEALERT_H__
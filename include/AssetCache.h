@@ -0,0 +1,35 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __ASSETCACHE_H__
+#define __ASSETCACHE_H__
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+
+// Instrument artwork scaled to the screen geometry. Smooth scaling the big tapes and dials takes most of a second on a
+// Pi so each scaled copy is kept in memory and saved under the data directory as well; the next launch or rotation at
+// a size that's been seen before just loads it. Entries are keyed by the size and a hash of the source resource so new
+// artwork in an update never picks up an old copy. Anything with an SVG version is rendered from that rather than
+// scaled, so it comes out sharp at any resolution.
+class AssetCache
+{
+public:
+    static QImage  scaled( const QString &qsResource, const QSize &size, bool bScale = true );   // Height 0 keeps the aspect ratio; without bScale anything not cached comes back null
+    static QImage  lookup( const QString &qsKey );
+    static void    store( const QString &qsKey, const QImage &image );
+    static QString resourceHash( const QString &qsResource );
+    static QString resourceHash( const QStringList &resources );    // For something built from several resources
+
+private:
+    static QString vectorResource( const QString &qsResource );
+    static QImage  render( const QString &qsVector, const QSize &size );
+    static QString cacheFile( const QString &qsKey );
+};
+
+#endif // __ASSETCACHE_H__
@@ -12,6 +12,8 @@ Stratofier Stratux AHRS Display
 
 
 class QPixmap;
+class QImage;
+class QPaintDevice;
 
 
 class Builder
@@ -22,11 +24,18 @@ public:
     static void buildNumber( QPixmap *pNumber, CanvasConstants *c, int iNum, int iFieldWidth );
     static void buildNumber( QPixmap *pNumber, CanvasConstants *c, const QString &qsNum );
     static void buildNumber( QPixmap *pNumber, CanvasConstants *c, double dNum, int iPrec );
+    static void buildNumber( QImage *pNumber, CanvasConstants *c, int iNum, int iFieldWidth );
+    static void buildGlyphAtlas( CanvasConstants *c );
 
     static void getStorage( QString *pInternal );
 
     static void populateUrlMapAirports( QMap<Canvas::CountryCodeAirports, QString> *pMapAP );
     static void populateUrlMapAirspaces( QMap<Canvas::CountryCodeAirspace, QString> *pMapAS );
+
+private:
+    static QImage glyphAtlas( CanvasConstants *c );
+    static void   buildGlyphAtlasLocked( CanvasConstants *c );
+    static void   paintNumber( QPaintDevice *pNumber, CanvasConstants *c, const QString &qsNum );
 };
 
 #endif // __BUILDER_H__
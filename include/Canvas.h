@@ -10,6 +10,8 @@ Stratofier Stratux AHRS Display
 #include <QDataStream>
 #include <QDateTime>
 #include <QPolygonF>
+#include <QRectF>
+#include <QPainterPath>
 
 
 class Keypad;
@@ -69,6 +71,24 @@ struct CanvasConstants
 };
 
 
+// Fixed instrument geometry for one screen size and orientation. It's all worked out in Canvas::init() so painting only
+// reads it; anything that moves with the situation (the pitch gradients, the tape offsets) is still placed per frame.
+struct CanvasLayout
+{
+    QPointF      headCenter;        // Heading indicator center
+    QRectF       headRect;          // Heading indicator bounds
+    QPainterPath headClip;          // Inside the heading indicator
+    QPainterPath headMask;          // Everything but the heading indicator; portrait only since that's where the tapes run beside it
+    QRect        mapRect;           // Widget area the moving map layers cover
+    QRectF       attitudeClip;
+    QRectF       speedTapeClip;
+    QPolygonF    headArrow;         // Heading pointer above the dial
+    QPolygonF    headCenterArrow;   // Landscape also marks the heading just above the dial center
+    QPolygonF    vertSpeedArrow;    // Drawn translated to the current vertical speed
+    QPolygonF    gForceArrow;       // Drawn translated to the current G load
+};
+
+
 struct BearingDist
 {
     double dBearing;
@@ -76,15 +96,18 @@ struct BearingDist
 };
 
 
+// Plain data so it can go straight from the recorder's ring to the track file; see FlightRecorder
 struct TrackPoint
 {
-    QDateTime timestamp;
-    double    dLat;
-    double    dLong;
-    double    dAlt;
-    double    dPitch;
-    double    dRoll;
-    double    dHead;
+    qint64 iTimeMs;         // Since the epoch, UTC
+    double dLat;
+    double dLong;
+    double dAlt;            // GPS MSL
+    double dPitch;
+    double dRoll;
+    double dHead;
+    double dGroundSpeed;
+    double dVertSpeed;
 };
 
 
@@ -110,6 +133,14 @@ struct Airport
 };
 
 
+// One entry in the sorted airport search index; each airport has one for its ID and one per word of its name
+struct AirportKey
+{
+    QString qsKey;      // Normalized (upper case, letters, digits and spaces only)
+    int     iAirport;   // Index into g_airportCache
+};
+
+
 struct FuelTanks
 {
     double    dLeftCapacity;
@@ -207,6 +238,7 @@ public:
     void init( double dWidth, double dHeight, bool bPortrait );
 
     CanvasConstants constants();
+    const CanvasLayout &layout();
     double          scaledH( double d );    // Simplify scalars for constants used for known 480x800/800x480 screen size
     double          scaledV( double d );    // Same for vertical
     int             largeWidth( const QString &qsText );
@@ -215,7 +247,10 @@ public:
     void setKeypadGeometry( Keypad *pKeypad );
 
 private:
+    void initLayout();
+
     CanvasConstants m_preCalc;
+    CanvasLayout    m_layout;
 };
 
 
@@ -227,6 +262,7 @@ struct StratofierSettings
     int                        iCurrDataSet;
     bool                       bSwitchableTanks;
     bool                       bAutoRec;
+    bool                       bMapRasterCache;
     bool                       bHalfMode;
     QString                    qsStratuxIP;
     bool                       bShowRunways;
@@ -249,7 +285,10 @@ struct Airspace
     int                  iAltTop;
     int                  iAltBottom;
     QPolygonF            shape;
+    QList<QPolygonF>     shapeLOD;  // Simplified copies of the shape, coarsest last; see TrafficMath::airspaceLOD()
     QList<BearingDist>   shapeHav;
+    QPointF              labelPt;   // Long/lat the altitude label goes at; see TrafficMath::labelAnchor()
+    BearingDist          labelHav;
 };
 
 #endif // __CANVAS_H__
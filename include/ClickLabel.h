@@ -41,6 +41,9 @@ private slots:
     void key( const QString &qsKey );
     void keyboardComplete();
     void keyboardComplete2();
+
+signals:
+    void textEdited( const QString& );
 };
 
 #endif // __CLICKLABEL_H__
@@ -0,0 +1,118 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __DOWNLOADMANAGER_H__
+#define __DOWNLOADMANAGER_H__
+
+#include <QObject>
+#include <QUrl>
+#include <QList>
+#include <QMap>
+#include <QByteArray>
+#include <QString>
+
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QFile;
+
+
+// Expected size and SHA-256 for one dataset as listed in the server manifest
+struct ManifestEntry
+{
+    qint64     iSize;
+    QByteArray sha256;      // Hex
+};
+
+
+struct DownloadJob
+{
+    QString qsName;         // Dataset name, e.g. airports_united_states_us
+    QUrl    url;
+    QString qsFile;         // Final path; the transfer goes to qsFile + ".part" until it's verified, with the server's
+                            // ETag or Last-Modified for it in qsFile + ".part.tag"
+};
+
+
+struct DownloadTransfer
+{
+    DownloadJob    job;
+    QNetworkReply *pReply;
+    QFile         *pFile;
+    qint64         iResumeFrom;
+    qint64         iReceived;
+    qint64         iTotal;
+    int            iRetries;
+    bool           bWriting;    // The reply is a 200 or 206 whose body belongs in the part
+    bool           bBadRange;   // The reply was a 206 for somewhere other than the end of the part and was dropped
+};
+
+
+// Runs a queue of dataset downloads a few at a time. Partial files are kept on failure and resumed with an HTTP Range
+// request guarded by If-Range so a changed file on the server comes back whole, failed transfers are retried after a
+// growing delay, and each finished file is checked against the manifest (if the server has one) and then renamed over
+// the old copy.
+class DownloadManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadManager( QObject *pParent, int iMaxTransfers = 3 );
+    ~DownloadManager();
+
+    void setBaseUrl( const QString &qsBaseUrl ) { m_qsBaseUrl = qsBaseUrl; }
+    void enqueue( const QString &qsName, const QString &qsFile );
+    void start();
+    void cancel();
+    bool isRunning() { return m_bRunning; }
+
+    static QString defaultBaseUrl();
+
+protected:
+    void timerEvent( QTimerEvent *pEvent );
+
+private:
+    void startNext();
+    void startTransfer( DownloadTransfer *pTransfer );
+    void retryTransfer( DownloadTransfer *pTransfer );
+    void failTransfer( DownloadTransfer *pTransfer );
+    void finishTransfer( DownloadTransfer *pTransfer );
+    void restartPart( DownloadTransfer *pTransfer );
+    bool verify( const DownloadJob &job, qint64 iExpected );
+    bool replace( const QString &qsPart, const QString &qsFile );
+    void parseManifest( const QByteArray &manifest );
+    void reportProgress();
+
+    static QByteArray validator( QNetworkReply *pReply );
+    static int        status( QNetworkReply *pReply );
+    static qint64     rangeStart( QNetworkReply *pReply );
+
+    QNetworkAccessManager        *m_pManager;
+    QNetworkReply                *m_pManifestReply;
+    QString                       m_qsBaseUrl;
+    int                           m_iMaxTransfers;
+    bool                          m_bRunning;
+    bool                          m_bAllOK;
+    QList<DownloadJob>            m_queue;
+    QList<DownloadTransfer *>     m_active;
+    QMap<QString, ManifestEntry>  m_manifest;
+    QMap<int, DownloadTransfer *> m_retries;     // Backoff timer to the transfer waiting on it
+    qint64                        m_iDoneBytes;
+
+private slots:
+    void manifestFinished();
+    void transferReadyRead();
+    void transferProgress( qint64 iReceived, qint64 iTotal );
+    void transferFinished();
+
+signals:
+    void transferStarted( const QString &qsName, const QString &qsPart, qint64 iResumeFrom );
+    void transferData( const QString &qsName, const QByteArray &data );
+    void progress( qint64 iReceived, qint64 iTotal );
+    void fileFinished( const QString &qsName, bool bOK );
+    void finished( bool bAllOK );
+};
+
+#endif // __DOWNLOADMANAGER_H__
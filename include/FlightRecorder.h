@@ -0,0 +1,91 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __FLIGHTRECORDER_H__
+#define __FLIGHTRECORDER_H__
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include "Canvas.h"
+#include "StratuxStreams.h"
+
+
+// Drains one recording's ring into its track file. The GUI thread is the only producer and this thread the only
+// consumer so the two indices are all the synchronisation there is; when the card stalls the ring fills up and new
+// points are dropped rather than anyone waiting.
+class TrackWriter : public QThread
+{
+public:
+    enum { RingSize = 1024 };  // Over a minute and a half at 10 Hz
+
+    TrackWriter( const QString &qsFile, int iHz );
+
+    bool push( const TrackPoint &point );
+    void finish() { m_bStop.storeRelease( 1 ); }
+    int  dropped() { return m_iDropped.load(); }
+
+protected:
+    void run();
+
+private:
+    bool begin();
+    void drain();
+    bool write( const TrackPoint *pPoints, int iCount );
+    void end();
+
+    QString       m_qsFile;
+    int           m_iHz;
+    QFile         m_file;
+    qint64        m_iCount;
+    qint64        m_iCapacity;
+    bool          m_bFailed;
+    QElapsedTimer m_sinceSync;
+
+    TrackPoint    m_ring[RingSize];
+    QAtomicInt    m_iHead;      // Next slot the GUI thread fills
+    QAtomicInt    m_iTail;      // Next slot the writer empties
+    QAtomicInt    m_iDropped;
+    QAtomicInt    m_bStop;
+};
+
+
+// Samples the situation stream into fixed-size track points at RecordHz and hands them to a TrackWriter; the cost on
+// the GUI thread is a clock read per update and a copy per sample. With AutoRec on it starts by itself once the ground
+// speed passes RecordStartKts and stops after it has stayed under RecordStopKts for RecordStopSecs, or as soon as AutoRec
+// is switched off.
+//   RecordHz                                        Samples per second (5)
+//   RecordStartKts, RecordStopKts, RecordStopSecs   (40, 15, 60)
+class FlightRecorder
+{
+public:
+    FlightRecorder();
+    ~FlightRecorder();
+
+    void start();
+    void stop();
+    bool recording() { return m_pWriter != nullptr; }
+    void situation( const StratuxSituation &s, bool bAutoRec );
+
+private:
+    void    reap();
+    QString trackFile();
+
+    TrackWriter          *m_pWriter;
+    QList<TrackWriter *>  m_finishing;      // Stopped but still writing out what they have
+    int                   m_iHz;
+    int                   m_iIntervalMs;
+    double                m_dStartKts;
+    double                m_dStopKts;
+    int                   m_iStopMs;
+    QElapsedTimer         m_sinceSample;
+    QElapsedTimer         m_sinceSlow;      // Running while under the stop speed
+};
+
+#endif // __FLIGHTRECORDER_H__
@@ -0,0 +1,59 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __FUELFLOW_H__
+#define __FUELFLOW_H__
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+#include "Canvas.h"
+#include "StratuxStreams.h"
+
+
+// Fuel burned between situation updates over the time that actually went by, at the rate for the phase of flight the
+// earlier update showed. What's left is written to an append-only journal as it goes and synced every few seconds, so
+// a restart or a power cut mid-flight picks up close to where it left off without hammering the settings file.
+class FuelFlow
+{
+public:
+    enum Phase
+    {
+        GroundPhase = 0,    // Stopped or doing something unrecognisable; nothing is burned
+        TaxiPhase,
+        ClimbPhase,
+        DescentPhase,
+        CruisePhase
+    };
+
+    FuelFlow();
+    ~FuelFlow();
+
+    void start( FuelTanks *pTanks );
+    void stop();
+    bool resume( FuelTanks *pTanks );
+    bool running() { return m_pTanks != nullptr; }
+    void situation( const StratuxSituation &s );
+    void tanksSwitched();
+
+    static Phase  phase( const StratuxSituation &s );
+    static double rate( const FuelTanks &tanks, Phase ePhase );     // Per hour
+
+private:
+    void    writeState( bool bSync );
+    void    append( const QString &qsRecord, bool bSync );
+    QString journalFile();
+
+    FuelTanks    *m_pTanks;
+    Phase         m_ePhase;
+    QElapsedTimer m_clock;
+    qint64        m_iLastNs;
+    QFile         m_journal;
+    QElapsedTimer m_sinceWrite;
+    QElapsedTimer m_sinceSync;
+};
+
+#endif // __FUELFLOW_H__
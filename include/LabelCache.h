@@ -0,0 +1,41 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __LABELCACHE_H__
+#define __LABELCACHE_H__
+
+#include <QImage>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+
+#include "Canvas.h"
+
+
+class QPainter;
+class QFont;
+class QColor;
+
+
+// A label with its shadow already drawn in
+struct CachedLabel
+{
+    QImage image;
+    QPoint origin;      // Where the text baseline starts inside the image
+    QSize  textSize;    // Font metrics bounding rect of the text alone, for placing it like drawText would
+};
+
+
+// Map labels (airport IDs, traffic tags, runway numbers) come out the same every frame so they're rendered once and
+// kept in a least recently used cache. They're images so the map layer workers can use them too.
+class LabelCache
+{
+public:
+    static CachedLabel label( const QString &qsText, const QFont &font, const QColor &color, const QColor &shadow, const QPoint &shadowOffset );
+    static void        draw( QPainter *pPainter, const QPointF &baseline, const CachedLabel &label );
+    static QImage      runway( CanvasConstants *c, int iRunway, int iWidth );
+};
+
+#endif // __LABELCACHE_H__
@@ -0,0 +1,70 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+
+
+// Frame and ingest timing for the profiler overlay. Each stage keeps its most recent samples in a fixed ring so
+// recording costs two clock reads and a store into the ring under one global mutex (the map layer workers record too),
+// which is uncontended almost all the time; nothing is recorded at all unless the profiler is switched on.
+// Switching it on restarts the clock and begins a new session, and a scope that was opened in an earlier session is
+// dropped when it closes rather than measured against the new clock.
+class Profiler
+{
+public:
+    enum Stage
+    {
+        FrameStage = 0,
+        AirspacesStage,
+        AirportsStage,
+        TrafficStage,
+        DirectToStage,
+        InfoStage,
+        SituationStream,    // Ingest slots; the sample count doubles as the message rate
+        TrafficStream,
+        StatusStream,
+        StageCount
+    };
+
+    static void        setEnabled( bool bEnabled );
+    static bool        enabled();
+    static qint64      now();
+    static int         session();
+    static void        record( Stage eStage, int iSession, qint64 iStartNs, qint64 iEndNs );
+    static QStringList summary();
+    static bool        dump( const QString &qsFile );
+    static QString     stageName( Stage eStage );
+};
+
+
+// Times the enclosing block into one stage
+class ProfileScope
+{
+public:
+    explicit ProfileScope( Profiler::Stage eStage )
+        : m_eStage( eStage ),
+          m_iSession( Profiler::session() ),
+          m_iStartNs( Profiler::enabled() ? Profiler::now() : -1 )
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if( m_iStartNs >= 0 )
+            Profiler::record( m_eStage, m_iSession, m_iStartNs, Profiler::now() );
+    }
+
+private:
+    Profiler::Stage m_eStage;
+    int             m_iSession;
+    qint64          m_iStartNs;
+};
+
+#endif // __PROFILER_H__
@@ -0,0 +1,59 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __RENDERBENCH_H__
+#define __RENDERBENCH_H__
+
+#include <QList>
+#include <QVector>
+#include <QSize>
+#include <QString>
+#include <QImage>
+
+#include "StratuxStreams.h"
+
+
+class AHRSCanvas;
+
+
+// One fixed scene for the reference image check
+struct RenderScenario
+{
+    QString qsName;         // Also the reference image name
+    QSize   size;
+    bool    bPortrait;
+    bool    bDark;
+    int     iTraffic;
+    int     iAirports;
+    int     iAirspaces;
+    double  dPitch;
+    double  dRoll;
+    double  dHeading;
+};
+
+
+// Renders the instrument panel into an offscreen image with no display attached (main sets QT_QPA_PLATFORM=offscreen
+// if it isn't already).
+//   bench=<frames>           Repeats the frame and reports the frame times
+//   golden=record|compare    Renders a fixed set of scenes and saves them as, or checks them against, reference PNGs
+class RenderBench
+{
+public:
+    static int          run( int iFrames, int iTraffic, int iAirports, int iAirspaces, const QList<QSize> &sizes, const QString &qsReplay );
+    static int          golden( const QString &qsDir, bool bRecord, int iTolerance );
+    static QList<QSize> parseSizes( const QString &qsSizes );
+
+private:
+    static void                  startup( AHRSCanvas *pCanvas, const QSize &size );
+    static void                  prepare( AHRSCanvas *pCanvas, const QSize &frameSize, bool bPortrait );
+    static void                  populate( AHRSCanvas *pCanvas, int iTraffic, int iAirports, int iAirspaces );
+    static bool                  loadReplay( const QString &qsReplay, QList<StratuxSituation> *pFrames );
+    static void                  synthesize( int iFrame, StratuxSituation &situation );
+    static void                  report( const QString &qsLabel, qint64 iColdNs, QVector<qint64> frameNs, qint64 *pStageNs );
+    static QList<RenderScenario> scenarios();
+    static int                   compare( const QImage &reference, const QImage &frame, int iTolerance, QImage *pDiff );
+};
+
+#endif // __RENDERBENCH_H__
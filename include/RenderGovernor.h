@@ -0,0 +1,79 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __RENDERGOVERNOR_H__
+#define __RENDERGOVERNOR_H__
+
+#include <QObject>
+#include <QElapsedTimer>
+
+#include "StratuxStreams.h"
+
+
+// Paces the repaints driven by the Stratux streams. When nothing much is changing the display only refreshes at the
+// idle rate which keeps a Pi from heating up to its throttle point and a tablet battery from draining; any manoeuvre
+// brings it straight back up to the full rate and it eases back down over a couple of seconds afterwards. Traffic moving
+// across the map or closing in counts the same way as our own manoeuvring.
+// Urgent requests (new or close traffic, airspace alerts) are never held back.
+//   RenderGovernor=false     Repaint on every update like before
+//   GovernorIdleHz, GovernorMaxHz
+class RenderGovernor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderGovernor( QObject *pParent = nullptr );
+    ~RenderGovernor();
+
+    void situation( const StratuxSituation &prev, const StratuxSituation &curr );
+    void traffic( const StratuxTraffic &prev, const StratuxTraffic &curr, double dZoomNM );
+    void request( bool bUrgent );
+    void frameDone( qint64 iFrameNs );
+    void showStats( bool bShow );
+    bool statsShown() { return m_iStatsTimer != 0; }
+
+    int    interval();
+    double activity() { return m_dActivity; }
+    double fps() { return m_dFPS; }
+    double frameMs() { return m_dFrameMs; }
+    int    cpuPercent() { return m_iCpuPercent; }
+    double cpuTemp() { return m_dCpuTemp; }
+    int    cpuMHz() { return m_iCpuMHz; }
+    bool   throttled() { return m_bThrottled; }
+
+protected:
+    void timerEvent( QTimerEvent *pEvent );
+
+private:
+    void due();
+    void readStats();
+
+    bool          m_bEnabled;
+    int           m_iIdleMs;
+    int           m_iBusyMs;
+    double        m_dActivity;      // 0 is steady, 1 is manoeuvring
+    QElapsedTimer m_sinceFrame;
+    QElapsedTimer m_sinceSample;
+    int           m_iFrameTimer;
+    int           m_iStatsTimer;
+
+    // Debug overlay figures; CPU ones stay at -1 where the platform doesn't expose them
+    int           m_iFrames;
+    QElapsedTimer m_fpsClock;
+    double        m_dFPS;
+    double        m_dFrameMs;
+    qint64        m_iCpuBusy;
+    qint64        m_iCpuTotal;
+    int           m_iCpuPercent;
+    double        m_dCpuTemp;
+    int           m_iCpuMHz;
+    bool          m_bThrottled;
+
+signals:
+    void frameDue();
+    void statsChanged();
+};
+
+#endif // __RENDERGOVERNOR_H__
@@ -13,10 +13,9 @@ Stratofier Stratux AHRS Display
 #include "Canvas.h"
 
 
-class QNetworkAccessManager;
-class QNetworkReply;
-class QFile;
 class Canvas;
+class DownloadManager;
+class AipParser;
 
 
 // NOTE: The reason this is called settings instead of Fuel or something similar is that the expectation that other non-fuel related settings
@@ -33,45 +32,38 @@ public:
 
 private:
     void          loadSettings();
-    void          startRequestAirports( QUrl url );
-    void          startRequestAirspace( QUrl url );
     const QString settingsRoot();
-    bool          nextCountryAirport();
-    bool          nextCountryAirspace();
 
     StratofierSettings m_settings;
     QString            m_qsInternalStoragePath;
     QString            m_qsExternalStoragePath;
 
-    QNetworkAccessManager *m_pManager;
-    QNetworkReply         *m_pReply;
-    QFile                 *m_pFile;
-    qint64                 m_fileSize;
-    QUrl                   m_url;
-    int                    m_iTally;
-    CanvasConstants       *m_pC;
+    DownloadManager *m_pDownloads;
+    CanvasConstants *m_pC;
+    bool             m_bRecacheAirports;
+    bool             m_bRecacheAirspaces;
 
-    QMap<Canvas::CountryCodeAirports, QString>         m_mapUrlsAirports;
-    QMapIterator<Canvas::CountryCodeAirports, QString> m_mapItAirports;
-    QMap<Canvas::CountryCodeAirspace, QString>         m_mapUrlsAirspaces;
-    QMapIterator<Canvas::CountryCodeAirspace, QString> m_mapItAirspaces;
+    QMap<QString, AipParser *> m_parsers;     // Streaming parse of each dataset in flight
+
+    QMap<Canvas::CountryCodeAirports, QString> m_mapUrlsAirports;
+    QMap<Canvas::CountryCodeAirspace, QString> m_mapUrlsAirspaces;
 
 private slots:
     void init();
-    void getMapDataAirports();
-    void getMapDataAirspace();
+    void getMapData();
     void storage();
     void switchable();
+    void mapCache();
     void selCountries();
     void magDevChange();
     void saveSettings();
 
     // Download slots
-    void httpReadyRead();
-    void httpDownloadFinishedAirports();
-    void httpDownloadFinishedAirspace();
-    void updateDownloadProgressAirports( qint64, qint64 );
-    void updateDownloadProgressAirspace( qint64, qint64 );
+    void downloadStarted( const QString &qsName, const QString &qsPart, qint64 iResumeFrom );
+    void downloadData( const QString &qsName, const QByteArray &data );
+    void downloadProgress( qint64 iReceived, qint64 iTotal );
+    void downloadFileFinished( const QString &qsName, bool bOK );
+    void downloadsFinished( bool bAllOK );
 };
 
 #endif // __SETTINGSDIALOG_H__
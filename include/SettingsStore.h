@@ -0,0 +1,54 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __SETTINGSSTORE_H__
+#define __SETTINGSSTORE_H__
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+
+#include "Canvas.h"
+
+
+// In-memory copy of the persistent settings. Everything is read from QSettings once up front so the drawing and stream
+// code only ever copies a snapshot; writes land in the snapshot straight away, tell anyone listening, and are saved
+// together a moment after the last one so a run of taps on the overlay buttons is a single sync.
+// Reads are fine from any thread; writes belong on the GUI thread.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SettingsStore( QObject *pParent = nullptr );
+    ~SettingsStore();
+
+    StratofierSettings settings();
+    double             zoomNM();
+    QVariant           value( const QString &qsKey, const QVariant &defaultValue = QVariant() );
+    void               setValue( const QString &qsKey, const QVariant &value );
+    void               flush();
+
+protected:
+    void timerEvent( QTimerEvent *pEvent );
+
+private:
+    void read( const QString &qsKey, const QVariant &defaultValue );
+    void rebuild();
+
+    QMutex                  m_mutex;
+    QMap<QString, QVariant> m_values;     // Everything read or written so far
+    QMap<QString, QVariant> m_pending;    // Written but not saved yet
+    StratofierSettings      m_settings;
+    double                  m_dZoomNM;
+    int                     m_iWriteTimer;
+
+signals:
+    void settingsChanged( const QString &qsKey );
+};
+
+#endif // __SETTINGSSTORE_H__
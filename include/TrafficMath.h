@@ -6,9 +6,46 @@ Stratofier Stratux AHRS Display
 #ifndef TRAFFICMATH_H
 #define TRAFFICMATH_H
 
+#include <QObject>
 #include <QList>
+#include <QStringList>
+#include <QVector>
+#include <QPolygonF>
+#include <QFutureWatcher>
 
 #include "Canvas.h"
+#include "AirportCache.h"
+
+
+// What the cache loads on a worker hand back to be swapped in
+struct AirportSet
+{
+    AirportCache        cache;
+    QVector<AirportKey> index;
+    QStringList         datasets;
+};
+
+
+struct AirspaceSet
+{
+    QList<Airspace> airspaces;
+    QStringList     datasets;
+};
+
+
+// A freshly downloaded country waiting to be added to the caches
+struct AirportMerge
+{
+    QString        qsDataset;
+    QList<Airport> airports;
+};
+
+
+struct AirspaceMerge
+{
+    QString         qsDataset;
+    QList<Airspace> airspaces;
+};
 
 
 class TrafficMath
@@ -18,12 +55,66 @@ public:
     static double      radiansRel( double dAng );
     static double      degHeading( double dAng );
 
-    static void    cacheAirports();
+    static void    cacheAirports();      // GUI thread; the loads run on a worker and are swapped in when they're done
     static void    cacheAirspaces();
     static void    updateNearbyAirports( QList<Airport> *pAirports, Airport *pDirect, Airport *pFrom, Airport *pTo, double dDist );
     static Airport getCurrentAirport();
-    static void    updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDist );
+    static void    updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDist, double dNMPerPixel );
     static int     findAirport( Airport *pAirport, QList<Airport> *apList );
+    static bool    findAirportByName( const QString &qsName, Airport *pAirport );
+
+    static QList<int> searchAirports( const QString &qsPrefix, int iMax );
+    static QString    normalizeAirportKey( const QString &qsKey );
+
+    static bool    mergeAirports( const QString &qsDataset, const QList<Airport> &airports );     // GUI thread; swapped in like a load
+    static bool    mergeAirspaces( const QString &qsDataset, const QList<Airspace> &airspaces );
+
+    static AirportSet  loadAirports();      // Worker sides of cacheAirports() and cacheAirspaces()
+    static AirspaceSet loadAirspaces();
+    static AirportSet  extendAirports( AirportSet loaded, const QList<AirportMerge> &merges );      // and of the merges
+    static AirspaceSet extendAirspaces( AirspaceSet loaded, const QList<AirspaceMerge> &merges );
+
+    static QPolygonF simplifyPolygon( const QPolygonF &shape, double dToleranceNM );
+    static int       airspaceLOD( double dNMPerPixel );
+    static void      buildAirspaceLOD( Airspace *pAirspace );
+    static QPointF   labelAnchor( const QPolygonF &shape, double dPrecisionNM );
+};
+
+
+// Swaps caches built on a worker in on the GUI thread once the nearby list threads are done with the old ones. Nothing
+// else reads the caches off the GUI thread so nobody ever sees one half built.
+class CachePublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CachePublisher( QObject *pParent = nullptr );
+
+    void loadAirports();
+    void loadAirspaces();
+    bool mergeAirports( const QString &qsDataset, const QList<Airport> &airports );
+    bool mergeAirspaces( const QString &qsDataset, const QList<Airspace> &airspaces );
+
+private slots:
+    void airportsLoaded();
+    void airspacesLoaded();
+    void publish();
+
+private:
+    void extendAirports();
+    void extendAirspaces();
+
+    QFutureWatcher<AirportSet>  m_airportLoad;         // A full load or a merge, one at a time
+    QFutureWatcher<AirspaceSet> m_airspaceLoad;
+    QFutureWatcher<void>        m_nearby;
+    bool                        m_bAirportsQueued;     // Asked for again while a load was already running
+    bool                        m_bAirportsReady;
+    AirportSet                  m_airports;
+    QList<AirportMerge>         m_airportMerges;       // Waiting for the running load to finish
+    bool                        m_bAirspacesQueued;
+    bool                        m_bAirspacesReady;
+    AirspaceSet                 m_airspaces;
+    QList<AirspaceMerge>        m_airspaceMerges;
 };
 
 #endif // TRAFFICMATH_H
@@ -11,16 +11,21 @@ Stratofier Stratux AHRS Display
 #include <QSettings>
 #include <QFontDatabase>
 
+#include <string.h>
+
 #include "AHRSMainWin.h"
 #include "Keyboard.h"
 #if defined( Q_OS_ANDROID )
 #include "ScreenLocker.h"
 #endif
 #include "StreamReader.h"
+#include "RenderBench.h"
+#include "SettingsStore.h"
 
 
-QSettings *g_pSet = nullptr;
-Keyboard  *g_pKeyboard = nullptr;
+QSettings     *g_pSet = nullptr;
+SettingsStore *g_pSettings = nullptr;
+Keyboard      *g_pKeyboard = nullptr;
 
 
 // This needs to stay global so it's not destroyed when the orientation changes
@@ -33,6 +38,13 @@ int main( int argc, char *argv[] )
     QGuiApplication::setAttribute( Qt::AA_EnableHighDpiScaling );
 #endif
 
+    // The render benchmark and reference check don't need a display; this has to be decided before the application object exists
+    for( int iArg = 1; iArg < argc; iArg++ )
+    {
+        if( ((strncmp( argv[iArg], "bench=", 6 ) == 0) || (strncmp( argv[iArg], "golden=", 7 ) == 0)) && (!qEnvironmentVariableIsSet( "QT_QPA_PLATFORM" )) )
+            qputenv( "QT_QPA_PLATFORM", "offscreen" );
+    }
+
     QApplication guiApp( argc, argv );
 	QStringList  qslArgs = guiApp.arguments();
     QString      qsArg;
@@ -43,6 +55,15 @@ int main( int argc, char *argv[] )
     AHRSMainWin *pMainWin = 0;
     QString      qsCurrWorkPath( "/home/pi/Stratofier" );  // If you put Stratofier anywhere else, specify home=<whatever> as an argument when running
     bool         bWindowed = false;
+    int          iBenchFrames = 0;
+    int          iBenchTraffic = 20;
+    int          iBenchAirports = 50;
+    int          iBenchAirspaces = 20;
+    QString      qsBenchSizes( "800x480,1280x800,1920x1080" );
+    QString      qsBenchReplay;
+    QString      qsGolden;
+    QString      qsGoldenDir( "./golden" );
+    int          iGoldenTolerance = 2;
 
 #if defined( Q_OS_ANDROID )
     ScreenLocker locker;    // Keeps screen on until app exit where it's destroyed.
@@ -67,6 +88,24 @@ int main( int argc, char *argv[] )
                 qsCurrWorkPath = qsVal;
             else if( qsArg == "windowed" )
                 bWindowed = true;
+            else if( qsToken == "bench" )
+                iBenchFrames = qsVal.toInt();
+            else if( qsToken == "benchtraffic" )
+                iBenchTraffic = qsVal.toInt();
+            else if( qsToken == "benchairports" )
+                iBenchAirports = qsVal.toInt();
+            else if( qsToken == "benchairspaces" )
+                iBenchAirspaces = qsVal.toInt();
+            else if( qsToken == "benchsizes" )
+                qsBenchSizes = qsVal;
+            else if( qsToken == "benchreplay" )
+                qsBenchReplay = qsVal;
+            else if( qsToken == "golden" )
+                qsGolden = qsVal;
+            else if( qsToken == "goldendir" )
+                qsGoldenDir = qsVal;
+            else if( qsToken == "goldentol" )
+                iGoldenTolerance = qsVal.toInt();
         }
     }
 
@@ -90,8 +129,15 @@ int main( int argc, char *argv[] )
 #else
     g_pSet = new QSettings;
 #endif
+    g_pSettings = new SettingsStore;
+
+    // Offscreen frame timing or reference image check instead of the normal app; see RenderBench.h
+    if( iBenchFrames > 0 )
+        return RenderBench::run( iBenchFrames, iBenchTraffic, iBenchAirports, iBenchAirspaces, RenderBench::parseSizes( qsBenchSizes ), qsBenchReplay );
+    if( (qsGolden == "record") || (qsGolden == "compare") )
+        return RenderBench::golden( qsGoldenDir, qsGolden == "record", iGoldenTolerance );
 
-    qsIP = g_pSet->value( "StratuxIP", "192.168.10.1" ).toString();
+    qsIP = g_pSettings->settings().qsStratuxIP;
 
     qInfo() << "Starting Stratofier";
     g_pStratuxStream = new StreamReader( qsIP );
@@ -114,5 +160,11 @@ int main( int argc, char *argv[] )
     delete g_pStratuxStream;
     g_pStratuxStream = nullptr;
 
+    // Saves anything still waiting
+    delete g_pSettings;
+    g_pSettings = nullptr;
+    delete g_pSet;
+    g_pSet = nullptr;
+
     return 0;
 }